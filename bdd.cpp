@@ -0,0 +1,502 @@
+#include <algorithm>
+#include <utility>
+#include "bdd.h"
+
+///
+/// CLASSE BDD
+///
+
+BDD::BDD(GerenciadorBDD* Ger, uint32_t No):
+  G(Ger), no(No)
+{
+  G->incRef(no);
+}
+
+BDD::BDD():
+  G(nullptr), no(0)
+{
+}
+
+BDD::BDD(const BDD& B):
+  G(B.G), no(B.no)
+{
+  if (G) G->incRef(no);
+}
+
+BDD::BDD(BDD&& B) noexcept:
+  G(B.G), no(B.no)
+{
+  B.G = nullptr;
+  B.no = 0;
+}
+
+BDD::~BDD()
+{
+  if (G) G->decRef(no);
+}
+
+BDD& BDD::operator=(const BDD& B)
+{
+  // Incrementa antes de decrementar: B pode ser o proprio objeto
+  if (B.G) B.G->incRef(B.no);
+  if (G) G->decRef(no);
+  G = B.G;
+  no = B.no;
+  return *this;
+}
+
+BDD& BDD::operator=(BDD&& B) noexcept
+{
+  if (this!=&B)
+  {
+    if (G) G->decRef(no);
+    G = B.G;
+    no = B.no;
+    B.G = nullptr;
+    B.no = 0;
+  }
+  return *this;
+}
+
+uint32_t BDD::getNo() const
+{
+  return no;
+}
+
+GerenciadorBDD* BDD::getGerenciador() const
+{
+  return G;
+}
+
+bool BDD::isFalso() const
+{
+  return no==0;
+}
+
+bool BDD::isVerdadeiro() const
+{
+  return no==1;
+}
+
+BDD BDD::operator~() const
+{
+  G->talvezColetar();
+  return BDD(G,G->negar(no));
+}
+
+BDD BDD::operator&(const BDD& B) const
+{
+  G->talvezColetar();
+  return BDD(G,G->aplicar(GerenciadorBDD::E,no,B.no));
+}
+
+BDD BDD::operator|(const BDD& B) const
+{
+  G->talvezColetar();
+  return BDD(G,G->aplicar(GerenciadorBDD::OU,no,B.no));
+}
+
+BDD BDD::operator^(const BDD& B) const
+{
+  G->talvezColetar();
+  return BDD(G,G->aplicar(GerenciadorBDD::XOU,no,B.no));
+}
+
+bool BDD::operator==(const BDD& B) const
+{
+  return G==B.G && no==B.no;
+}
+
+bool BDD::operator!=(const BDD& B) const
+{
+  return !operator==(B);
+}
+
+///
+/// CLASSE GERENCIADOR DE BDD
+///
+
+namespace
+{
+  // A dimensao inicial da tabela de unicidade e da cache
+  const size_t TAM_INICIAL = 1 << 12;
+  // Abaixo desse numero de nos em uso, nao vale a pena coletar
+  const size_t MIN_COLETA = 1 << 16;
+
+  // C*2^K, saturado em 2^64-1
+  uint64_t escalar(uint64_t C, uint32_t K)
+  {
+    if (C==0 || K==0) return C;
+    if (K>=64 || (C >> (64-K))!=0) return ~uint64_t(0);
+    return C << K;
+  }
+
+  // A soma, saturada em 2^64-1
+  uint64_t somar(uint64_t A, uint64_t B)
+  {
+    return (A+B<A ? ~uint64_t(0) : A+B);
+  }
+}
+
+/// ***********************
+/// Inicializacao
+/// ***********************
+
+GerenciadorBDD::GerenciadorBDD(int NumVars):
+  num_vars(std::max(0,NumVars)), nos(), livres(NENHUM), em_uso(2), tabela(), cache(),
+  uso_ultima_coleta(2), max_nos(0)
+{
+  // As constantes testam a "variavel" num_vars, abaixo de todas as outras, e nunca
+  // sao recolhidas
+  nos.push_back(No{uint32_t(num_vars), 0, 0, NENHUM, 1});
+  nos.push_back(No{uint32_t(num_vars), 1, 1, NENHUM, 1});
+  redimensionar(TAM_INICIAL);
+}
+
+int GerenciadorBDD::getNumVars() const
+{
+  return num_vars;
+}
+
+void GerenciadorBDD::setMaxNos(size_t N)
+{
+  max_nos = N;
+}
+
+size_t GerenciadorBDD::getNumNos() const
+{
+  return em_uso;
+}
+
+/// ***********************
+/// Tabela de unicidade e cache
+/// ***********************
+
+uint32_t GerenciadorBDD::posicao(uint32_t Var, uint32_t Baixo, uint32_t Alto) const
+{
+  uint64_t h = Var*0x9E3779B97F4A7C15ULL;
+  h ^= Baixo*0xC2B2AE3D27D4EB4FULL + (h >> 29);
+  h ^= Alto*0x165667B19E3779F9ULL + (h >> 32);
+  return uint32_t(h ^ (h >> 31)) & uint32_t(tabela.size()-1);
+}
+
+// Reconstroi a tabela de unicidade com Tam posicoes, reinserindo os nos em uso
+// A cache passa a ter a mesma dimensao e eh esvaziada
+void GerenciadorBDD::redimensionar(size_t Tam)
+{
+  tabela.assign(Tam,NENHUM);
+  for (uint32_t N=2; N<nos.size(); N++)
+  {
+    No& n = nos[N];
+    // Os nos livres tem var==NENHUM
+    if (n.var==NENHUM) continue;
+    const uint32_t P = posicao(n.var,n.baixo,n.alto);
+    n.prox = tabela[P];
+    tabela[P] = N;
+  }
+  cache.assign(Tam,EntradaCache{0,0,0,VAZIA});
+}
+
+// Retorna o no (Var, Baixo, Alto), criando-o se ainda nao existir
+// Um no com os dois filhos iguais seria redundante: retorna o proprio filho
+uint32_t GerenciadorBDD::criar(uint32_t Var, uint32_t Baixo, uint32_t Alto)
+{
+  if (Baixo==Alto) return Baixo;
+
+  uint32_t P = posicao(Var,Baixo,Alto);
+  for (uint32_t N=tabela[P]; N!=NENHUM; N=nos[N].prox)
+  {
+    const No& n = nos[N];
+    if (n.var==Var && n.baixo==Baixo && n.alto==Alto) return N;
+  }
+
+  if (max_nos>0 && em_uso>=max_nos) throw LimiteNos();
+  uint32_t N;
+  if (livres!=NENHUM)
+  {
+    N = livres;
+    livres = nos[N].prox;
+    nos[N] = No{Var, Baixo, Alto, tabela[P], 0};
+  }
+  else
+  {
+    N = nos.size();
+    nos.push_back(No{Var, Baixo, Alto, tabela[P], 0});
+  }
+  tabela[P] = N;
+  em_uso++;
+  // Mantem no maximo um no por posicao, em media
+  if (em_uso>tabela.size()) redimensionar(2*tabela.size());
+  return N;
+}
+
+// Aplica a operacao O (E, OU ou XOU) aos nos A e B
+// Decompoe pela variavel mais alta dos dois (expansao de Shannon), consultando
+// a cache antes e guardando o resultado depois
+uint32_t GerenciadorBDD::aplicar(Op O, uint32_t A, uint32_t B)
+{
+  switch (O)
+  {
+  case E:
+    if (A==0 || B==0) return 0;
+    if (A==1 || A==B) return B;
+    if (B==1) return A;
+    break;
+  case OU:
+    if (A==1 || B==1) return 1;
+    if (A==0 || A==B) return B;
+    if (B==0) return A;
+    break;
+  default:
+    if (A==B) return 0;
+    if (A==0) return B;
+    if (B==0) return A;
+    if (A==1) return negar(B);
+    if (B==1) return negar(A);
+    break;
+  }
+  // As tres operacoes sao comutativas
+  if (A>B) std::swap(A,B);
+
+  const uint32_t C = (uint32_t(O)*0x9E3779B1u ^ A*0x85EBCA77u ^ B*0xC2B2AE3Du) &
+                     uint32_t(cache.size()-1);
+  {
+    const EntradaCache& e = cache[C];
+    if (e.op==O && e.a==A && e.b==B) return e.r;
+  }
+
+  const uint32_t va = nos[A].var, vb = nos[B].var;
+  const uint32_t v = std::min(va,vb);
+  const uint32_t a0 = (va==v ? nos[A].baixo : A), a1 = (va==v ? nos[A].alto : A);
+  const uint32_t b0 = (vb==v ? nos[B].baixo : B), b1 = (vb==v ? nos[B].alto : B);
+  const uint32_t r0 = aplicar(O,a0,b0);
+  const uint32_t r1 = aplicar(O,a1,b1);
+  const uint32_t r = criar(v,r0,r1);
+
+  // A cache pode ter sido redimensionada por criar
+  const uint32_t C2 = (uint32_t(O)*0x9E3779B1u ^ A*0x85EBCA77u ^ B*0xC2B2AE3Du) &
+                      uint32_t(cache.size()-1);
+  cache[C2] = EntradaCache{A, B, r, uint8_t(O)};
+  return r;
+}
+
+uint32_t GerenciadorBDD::negar(uint32_t A)
+{
+  if (A<2) return 1-A;
+
+  const uint32_t C = (uint32_t(NAO)*0x9E3779B1u ^ A*0x85EBCA77u) & uint32_t(cache.size()-1);
+  {
+    const EntradaCache& e = cache[C];
+    if (e.op==NAO && e.a==A) return e.r;
+  }
+
+  const uint32_t v = nos[A].var;
+  const uint32_t r0 = negar(nos[A].baixo);
+  const uint32_t r1 = negar(nos[A].alto);
+  const uint32_t r = criar(v,r0,r1);
+
+  const uint32_t C2 = (uint32_t(NAO)*0x9E3779B1u ^ A*0x85EBCA77u) & uint32_t(cache.size()-1);
+  cache[C2] = EntradaCache{A, 0, r, uint8_t(NAO)};
+  return r;
+}
+
+/// ***********************
+/// Referencias e coleta
+/// ***********************
+
+void GerenciadorBDD::incRef(uint32_t N)
+{
+  nos[N].ref++;
+}
+
+void GerenciadorBDD::decRef(uint32_t N)
+{
+  nos[N].ref--;
+}
+
+// A coleta eh feita somente no inicio das operacoes publicas, quando todos os nos
+// em uso pelo chamador estao em objetos BDD
+void GerenciadorBDD::talvezColetar()
+{
+  if (em_uso>=MIN_COLETA && em_uso>=2*uso_ultima_coleta) coletar();
+}
+
+// Marca os nos alcancaveis a partir dos nos referenciados e poe os demais na lista
+// de livres. A tabela de unicidade eh reconstruida e a cache esvaziada (pode
+// conter nos recolhidos)
+void GerenciadorBDD::coletar()
+{
+  std::vector<char> marca(nos.size(),0);
+  std::vector<uint32_t> pilha;
+  marca[0] = marca[1] = 1;
+  for (uint32_t N=2; N<nos.size(); N++)
+  {
+    if (nos[N].var==NENHUM || nos[N].ref==0 || marca[N]) continue;
+    marca[N] = 1;
+    pilha.push_back(N);
+    while (!pilha.empty())
+    {
+      const No& n = nos[pilha.back()];
+      pilha.pop_back();
+      for (uint32_t F : {n.baixo, n.alto})
+      {
+        if (!marca[F])
+        {
+          marca[F] = 1;
+          pilha.push_back(F);
+        }
+      }
+    }
+  }
+
+  for (uint32_t N=2; N<nos.size(); N++)
+  {
+    if (nos[N].var==NENHUM || marca[N]) continue;
+    nos[N].var = NENHUM;
+    nos[N].prox = livres;
+    livres = N;
+    em_uso--;
+  }
+  redimensionar(tabela.size());
+  uso_ultima_coleta = em_uso;
+}
+
+/// ***********************
+/// Constantes e variaveis
+/// ***********************
+
+BDD GerenciadorBDD::falso()
+{
+  return BDD(this,0);
+}
+
+BDD GerenciadorBDD::verdadeiro()
+{
+  return BDD(this,1);
+}
+
+// A variavel V: o no que testa V, com os filhos FALSO e VERDADEIRO
+// Retorna FALSO se V nao for valida
+BDD GerenciadorBDD::var(int V)
+{
+  if (V<0 || V>=num_vars) return falso();
+  talvezColetar();
+  return BDD(this,criar(V,0,1));
+}
+
+/// ***********************
+/// Consultas
+/// ***********************
+
+uint32_t GerenciadorBDD::getVar(uint32_t N) const
+{
+  return nos.at(N).var;
+}
+
+uint32_t GerenciadorBDD::getBaixo(uint32_t N) const
+{
+  return nos.at(N).baixo;
+}
+
+uint32_t GerenciadorBDD::getAlto(uint32_t N) const
+{
+  return nos.at(N).alto;
+}
+
+size_t GerenciadorBDD::contarNos(const BDD& F) const
+{
+  return contarNos(std::vector<BDD>(1,F));
+}
+
+size_t GerenciadorBDD::contarNos(const std::vector<BDD>& F) const
+{
+  std::vector<char> marca(nos.size(),0);
+  std::vector<uint32_t> pilha;
+  size_t N = 0;
+  for (const BDD& B : F)
+  {
+    if (marca[B.no]) continue;
+    marca[B.no] = 1;
+    pilha.push_back(B.no);
+    while (!pilha.empty())
+    {
+      const uint32_t u = pilha.back();
+      pilha.pop_back();
+      N++;
+      if (u<2) continue;
+      for (uint32_t f : {nos[u].baixo, nos[u].alto})
+      {
+        if (!marca[f])
+        {
+          marca[f] = 1;
+          pilha.push_back(f);
+        }
+      }
+    }
+  }
+  return N;
+}
+
+// Conta as solucoes de cada no, das folhas para a raiz (pos-ordem)
+// solucoes(u) = numero de atribuicoes das variaveis var(u) a NumVars-1 que
+// satisfazem u; cada variavel pulada entre um no e o filho dobra o numero
+uint64_t GerenciadorBDD::contarSolucoes(const BDD& F) const
+{
+  std::vector<uint64_t> sol(nos.size(),0);
+  std::vector<char> pronto(nos.size(),0);
+  sol[1] = 1;
+  pronto[0] = pronto[1] = 1;
+
+  std::vector<uint32_t> pilha(1,F.no);
+  while (!pilha.empty())
+  {
+    const uint32_t u = pilha.back();
+    if (pronto[u])
+    {
+      pilha.pop_back();
+      continue;
+    }
+    const No& n = nos[u];
+    if (!pronto[n.baixo] || !pronto[n.alto])
+    {
+      if (!pronto[n.baixo]) pilha.push_back(n.baixo);
+      if (!pronto[n.alto]) pilha.push_back(n.alto);
+      continue;
+    }
+    sol[u] = somar(escalar(sol[n.baixo],nos[n.baixo].var-n.var-1),
+                   escalar(sol[n.alto],nos[n.alto].var-n.var-1));
+    pronto[u] = 1;
+    pilha.pop_back();
+  }
+  return escalar(sol[F.no],nos[F.no].var);
+}
+
+// Desce pela raiz escolhendo sempre um filho diferente de FALSO: em um BDD reduzido,
+// todo no diferente de FALSO alcanca VERDADEIRO
+bool GerenciadorBDD::satisfazer(const BDD& F, std::vector<int8_t>& Valores) const
+{
+  Valores.assign(num_vars,-1);
+  if (F.no==0) return false;
+  for (uint32_t u=F.no; u>1; )
+  {
+    const No& n = nos[u];
+    if (n.baixo!=0)
+    {
+      Valores[n.var] = 0;
+      u = n.baixo;
+    }
+    else
+    {
+      Valores[n.var] = 1;
+      u = n.alto;
+    }
+  }
+  return true;
+}
+
+bool GerenciadorBDD::avaliar(const BDD& F, const std::vector<bool>& Valores) const
+{
+  uint32_t u = F.no;
+  while (u>1) u = (Valores.at(nos[u].var) ? nos[u].alto : nos[u].baixo);
+  return u==1;
+}
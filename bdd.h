@@ -0,0 +1,156 @@
+#ifndef _BDD_H_
+#define _BDD_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+class GerenciadorBDD;
+
+///
+/// DIAGRAMAS DE DECISAO BINARIA (BDD reduzidos e ordenados)
+///
+/// Um GerenciadorBDD guarda os nos de todos os BDDs sobre as variaveis 0 a NumVars-1
+/// (a variavel 0 eh a mais proxima da raiz):
+/// - os nos ficam em um vetor (arena) e sao identificados pelo indice; os indices 0
+///   e 1 sao as constantes FALSO e VERDADEIRO;
+/// - a tabela de unicidade (hash com encadeamento pelos proprios nos) garante que nao
+///   existem dois nos com a mesma variavel e os mesmos filhos: duas funcoes iguais
+///   tem o mesmo no, e a comparacao de funcoes eh uma comparacao de indices;
+/// - a cache de operacoes (mapeamento direto) guarda os resultados recentes de
+///   AND, OR, XOR e NOT, evitando recalcular subproblemas repetidos;
+/// - cada no tem um contador das referencias externas (objetos BDD). Os nos que nao
+///   sao alcancaveis a partir de nenhum no referenciado sao recolhidos (coletar)
+///   antes de uma operacao, quando a arena dobra de tamanho desde a ultima coleta,
+///   e reaproveitados por uma lista de livres.
+/// O numero de nos pode ser limitado (setMaxNos): ao ultrapassar o limite, a operacao
+/// em andamento gera a excecao GerenciadorBDD::LimiteNos.
+///
+
+// Uma funcao booleana representada em um GerenciadorBDD (referencia contada para a raiz)
+// O gerenciador deve existir enquanto existirem os BDDs criados nele
+class BDD {
+private:
+  GerenciadorBDD* G;
+  uint32_t no;
+  friend class GerenciadorBDD;
+
+  BDD(GerenciadorBDD* Ger, uint32_t No);
+
+public:
+  // BDD vazio (sem gerenciador)
+  BDD();
+  BDD(const BDD& B);
+  BDD(BDD&& B) noexcept;
+  ~BDD();
+  BDD& operator=(const BDD& B);
+  BDD& operator=(BDD&& B) noexcept;
+
+  // O indice do no raiz (0: FALSO, 1: VERDADEIRO)
+  uint32_t getNo() const;
+  GerenciadorBDD* getGerenciador() const;
+  bool isFalso() const;
+  bool isVerdadeiro() const;
+
+  // As operacoes logicas (os dois BDDs devem ser do mesmo gerenciador)
+  BDD operator~() const;
+  BDD operator&(const BDD& B) const;
+  BDD operator|(const BDD& B) const;
+  BDD operator^(const BDD& B) const;
+  // Duas funcoes sao iguais se e somente se tem o mesmo no raiz
+  bool operator==(const BDD& B) const;
+  bool operator!=(const BDD& B) const;
+};
+
+class GerenciadorBDD {
+public:
+  // Excecao gerada quando o numero de nos ultrapassa o limite (setMaxNos)
+  struct LimiteNos {};
+
+private:
+  // Um no: a variavel testada e os filhos para variavel 0 (baixo) e 1 (alto)
+  // prox encadeia os nos de uma mesma posicao da tabela de unicidade (ou da lista
+  // de livres); ref conta os objetos BDD que apontam para o no
+  struct No {
+    uint32_t var;
+    uint32_t baixo, alto;
+    uint32_t prox;
+    uint32_t ref;
+  };
+  // Uma entrada da cache de operacoes
+  struct EntradaCache {
+    uint32_t a, b, r;
+    uint8_t op;
+  };
+  enum Op : uint8_t {VAZIA, E, OU, XOU, NAO};
+
+  static constexpr uint32_t NENHUM = 0xFFFFFFFF;
+
+  int num_vars;
+  std::vector<No> nos;
+  // O inicio da lista de nos livres e o numero de nos em uso (inclui as constantes)
+  uint32_t livres;
+  size_t em_uso;
+  // Tabela de unicidade: o primeiro no de cada posicao (dimensao potencia de 2)
+  std::vector<uint32_t> tabela;
+  std::vector<EntradaCache> cache;
+  // O numero de nos em uso apos a ultima coleta, e o limite de nos
+  size_t uso_ultima_coleta;
+  size_t max_nos;
+
+  uint32_t posicao(uint32_t Var, uint32_t Baixo, uint32_t Alto) const;
+  // Reconstroi a tabela de unicidade (e a cache) com Tam posicoes
+  void redimensionar(size_t Tam);
+  // Retorna o no (Var, Baixo, Alto), criando-o se necessario (Baixo != Alto)
+  uint32_t criar(uint32_t Var, uint32_t Baixo, uint32_t Alto);
+  uint32_t aplicar(Op O, uint32_t A, uint32_t B);
+  uint32_t negar(uint32_t A);
+  // Recolhe os nos nao alcancaveis se a arena dobrou desde a ultima coleta
+  void talvezColetar();
+
+  void incRef(uint32_t N);
+  void decRef(uint32_t N);
+  friend class BDD;
+
+public:
+  // Gerenciador para funcoes de NumVars variaveis
+  explicit GerenciadorBDD(int NumVars);
+
+  GerenciadorBDD(const GerenciadorBDD&) = delete;
+  void operator=(const GerenciadorBDD&) = delete;
+
+  int getNumVars() const;
+  // Limita o numero de nos em uso (0: sem limite)
+  void setMaxNos(size_t N);
+  // O numero de nos em uso (inclui nos ainda nao recolhidos)
+  size_t getNumNos() const;
+  // Recolhe todos os nos nao alcancaveis a partir dos BDDs existentes
+  void coletar();
+
+  // As constantes e as variaveis
+  BDD falso();
+  BDD verdadeiro();
+  // A funcao "variavel V" (0 a NumVars-1)
+  BDD var(int V);
+
+  // Percurso da estrutura: a variavel testada pelo no N (NumVars nas constantes)
+  // e os seus filhos
+  uint32_t getVar(uint32_t N) const;
+  uint32_t getBaixo(uint32_t N) const;
+  uint32_t getAlto(uint32_t N) const;
+
+  // O numero de nos do BDD F, ou os nos distintos de todos os BDDs de F
+  // (incluindo as constantes alcancadas)
+  size_t contarNos(const BDD& F) const;
+  size_t contarNos(const std::vector<BDD>& F) const;
+  // O numero de atribuicoes das NumVars variaveis que satisfazem F
+  // (exato enquanto couber em 64 bits)
+  uint64_t contarSolucoes(const BDD& F) const;
+  // Uma atribuicao que satisfaz F: Valores[V] = 0, 1 ou -1 (qualquer valor)
+  // Retorna false se F for FALSO
+  bool satisfazer(const BDD& F, std::vector<int8_t>& Valores) const;
+  // O valor de F para a atribuicao Valores (NumVars valores)
+  bool avaliar(const BDD& F, const std::vector<bool>& Valores) const;
+};
+
+#endif // _BDD_H_
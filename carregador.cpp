@@ -0,0 +1,334 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "carregador.h"
+
+///
+/// CLASSE CARREGADOR DE CIRCUITO
+///
+
+CarregadorCircuito::CarregadorCircuito(int NumThreads, size_t TamBloco):
+  num_threads(NumThreads), tam_bloco(std::max<size_t>(TamBloco,4096)), compilar(true),
+  sequencial(false)
+{
+  if (num_threads<=0) num_threads = std::max(1, int(std::thread::hardware_concurrency())-1);
+}
+
+void CarregadorCircuito::setCompilar(bool Compilar)
+{
+  compilar = Compilar;
+}
+
+bool CarregadorCircuito::isSequencial() const
+{
+  return sequencial;
+}
+
+/// ***********************
+/// Analise das portas
+/// ***********************
+
+// Pula os espacos em branco, exceto o fim de linha
+static inline const char* pularEspacos(const char* p, const char* fim)
+{
+  while (p<fim && (*p==' ' || *p=='\t' || *p=='\r')) p++;
+  return p;
+}
+
+static inline bool digito(char c)
+{
+  return c>='0' && c<='9';
+}
+
+// Leh um inteiro (com sinal opcional) a partir de p, que avanca
+static inline bool lerInteiro(const char*& p, const char* fim, int& Valor)
+{
+  bool negativo = false;
+  if (p<fim && (*p=='-' || *p=='+')) negativo = (*p++=='-');
+  if (p==fim || !digito(*p)) return false;
+  long long v = 0;
+  while (p<fim && digito(*p))
+  {
+    v = 10*v + (*p++-'0');
+    if (v>(1LL<<31)) return false;
+  }
+  if (negativo) v = -v;
+  if (v<-(1LL<<31) || v>(1LL<<31)-1) return false;
+  Valor = int(v);
+  return true;
+}
+
+// Analisa as linhas "id) TIPO NIn: id1 id2 ..." do trecho, ateh a primeira linha que
+// nao comeca com um numero (a secao SAIDAS). As ids das portas devem ser consecutivas
+void CarregadorCircuito::analisar(Trecho& T, int NI, int NP)
+{
+  const char* const ini = T.texto.data();
+  const char* const fim = ini+T.texto.size();
+  const char* p = ini+T.ini;
+  // O ultimo tipo lido (os tipos se repetem muito)
+  std::string nome;
+  CodigoPorta codigo = CODIGO_INVALIDO;
+
+  T.primeira = 0;
+  T.fim = -1;
+  T.erro = false;
+  while (p<fim)
+  {
+    p = pularEspacos(p,fim);
+    if (p==fim) break;
+    if (*p=='\n')
+    {
+      p++;
+      continue;
+    }
+    if (!digito(*p))
+    {
+      T.fim = p-ini;
+      break;
+    }
+
+    int id, N;
+    if (!lerInteiro(p,fim,id) || p==fim || *p!=')') break;
+    p++;
+    if (T.tipo.empty()) T.primeira = id;
+    if (id<1 || id>NP || id!=T.primeira+int(T.tipo.size())) break;
+
+    p = pularEspacos(p,fim);
+    const char* t = p;
+    while (p<fim && *p!=' ' && *p!='\t' && *p!='\r' && *p!='\n') p++;
+    if (nome.compare(0,std::string::npos,t,p-t)!=0)
+    {
+      nome.assign(t,p-t);
+      codigo = RegistroPortas::getCodigo(nome);
+    }
+    if (codigo==CODIGO_INVALIDO) break;
+
+    p = pularEspacos(p,fim);
+    if (!lerInteiro(p,fim,N)) break;
+    p = pularEspacos(p,fim);
+    if (p==fim || *p!=':' || !RegistroPortas::validNumInputs(codigo,N)) break;
+    p++;
+    bool ok = true;
+    for (int j=0; j<N && ok; j++)
+    {
+      p = pularEspacos(p,fim);
+      // validIdOrig: uma entrada (-NI a -1) ou uma porta (1 a NP)
+      ok = lerInteiro(p,fim,id) && id!=0 && id>=-NI && id<=NP;
+      T.id_in.push_back(id);
+    }
+    p = pularEspacos(p,fim);
+    if (!ok || (p<fim && *p!='\n')) break;
+
+    T.tipo.push_back(codigo);
+    T.num_in.push_back(N);
+  }
+  // Saiu do laco antes do fim do trecho sem achar o fim das portas
+  if (p<fim && T.fim<0) T.erro = true;
+  // O texto soh eh necessario a partir do fim das portas
+  if (T.fim<0 && !T.erro)
+  {
+    T.texto.clear();
+    T.texto.shrink_to_fit();
+  }
+}
+
+/// ***********************
+/// Montagem do circuito
+/// ***********************
+
+bool CarregadorCircuito::montar(std::vector<Trecho*>& Trechos, Circuito& C) const
+{
+  const int NP = C.getNumPorts();
+
+  // Os trechos com portas devem ser consecutivos, ateh o trecho com o fim das portas
+  size_t ultimo = Trechos.size();
+  int proxima = 1;
+  size_t total = 0;
+  for (size_t k=0; k<Trechos.size(); k++)
+  {
+    const Trecho& T = *Trechos[k];
+    if (T.erro) return false;
+    if (!T.tipo.empty())
+    {
+      if (T.primeira!=proxima) return false;
+      proxima += T.tipo.size();
+      total += T.id_in.size();
+    }
+    if (T.fim>=0)
+    {
+      ultimo = k;
+      break;
+    }
+  }
+  if (ultimo==Trechos.size() || proxima!=NP+1) return false;
+
+  // As portas, direto nos vetores do circuito
+  Circuito::Portas& P = *C.portas;
+  P.id_in.resize(total);
+  size_t pos = 0;
+  for (size_t k=0; k<=ultimo; k++)
+  {
+    const Trecho& T = *Trechos[k];
+    if (T.tipo.empty()) continue;
+    const int i0 = T.primeira-1;
+    std::copy(T.tipo.begin(), T.tipo.end(), P.tipo.begin()+i0);
+    std::copy(T.num_in.begin(), T.num_in.end(), P.num_in.begin()+i0);
+    for (size_t i=0; i<T.num_in.size(); i++)
+    {
+      P.ini_in[i0+i] = pos;
+      pos += T.num_in[i];
+    }
+    std::memcpy(P.id_in.data()+P.ini_in[i0], T.id_in.data(), T.id_in.size()*sizeof(int));
+  }
+  P.lixo = 0;
+
+  // O resto do arquivo (SAIDAS e ATRASOS) eh lido como em Circuito::ler
+  std::string resto(Trechos[ultimo]->texto, Trechos[ultimo]->fim);
+  for (size_t k=ultimo+1; k<Trechos.size(); k++) resto += Trechos[k]->texto;
+  std::istringstream ArqI(resto);
+  try
+  {
+    C.lerSaidas(ArqI);
+    C.lerAtrasos(ArqI);
+  }
+  catch (int erro)
+  {
+    return false;
+  }
+  // Cada porta e cada saida foi conferida durante a leitura
+  C.validado = true;
+
+  // O fan-out e a versao compilada, ao mesmo tempo
+  std::thread fanout([&C]() {C.construirFanout();});
+  if (compilar)
+  {
+    std::shared_ptr<CircuitoCompilado> prov = std::make_shared<CircuitoCompilado>();
+    if (prov->compilar(C)) C.programa = prov;
+  }
+  fanout.join();
+  return true;
+}
+
+/// ***********************
+/// Carga
+/// ***********************
+
+bool CarregadorCircuito::carregar(const std::string& Arq, Circuito& C)
+{
+  sequencial = false;
+  C.clear();
+  FILE* F = std::fopen(Arq.c_str(), "rb");
+  if (F==nullptr) return false;
+
+  // Leh o proximo bloco, terminado em fim de linha (o que sobra fica para o seguinte)
+  std::string sobra;
+  auto lerBloco = [&](std::string& B) -> bool
+  {
+    B.swap(sobra);
+    sobra.clear();
+    while (true)
+    {
+      const size_t N0 = B.size();
+      B.resize(N0+tam_bloco);
+      const size_t N = std::fread(&B[N0], 1, tam_bloco, F);
+      B.resize(N0+N);
+      if (N==0) return !B.empty();
+      const size_t q = B.rfind('\n');
+      if (q!=std::string::npos && q>=N0)
+      {
+        sobra.assign(B, q+1, std::string::npos);
+        B.resize(q+1);
+        return true;
+      }
+    }
+  };
+
+  // O cabecalho: CIRCUITO NI NO NP PORTAS, no inicio do primeiro bloco
+  std::unique_ptr<Trecho> primeiro(new Trecho());
+  int NI = 0, NO = 0, NP = 0;
+  bool cabecalho = lerBloco(primeiro->texto);
+  if (cabecalho)
+  {
+    std::istringstream S(primeiro->texto.substr(0,256));
+    std::string circuito, portas;
+    S >> circuito >> NI >> NO >> NP >> portas;
+    cabecalho = (!S.fail() && circuito=="CIRCUITO" && portas=="PORTAS" &&
+                 NI>0 && NO>0 && NP>0);
+    if (cabecalho) primeiro->ini = primeiro->texto.find("PORTAS")+6;
+  }
+  if (!cabecalho)
+  {
+    // Modulos ou erro: leitura sequencial
+    std::fclose(F);
+    sequencial = true;
+    return C.ler(Arq);
+  }
+  C.resize(NI,NO,NP);
+
+  // A fila limitada de trechos a analisar
+  std::vector<std::unique_ptr<Trecho>> trechos;
+  std::deque<Trecho*> fila;
+  std::mutex mtx;
+  std::condition_variable cv_fila, cv_espaco;
+  bool fim_arquivo = false;
+  const size_t max_fila = 2*num_threads;
+
+  auto trabalho = [&]()
+  {
+    while (true)
+    {
+      Trecho* T;
+      {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_fila.wait(lock, [&]() {return !fila.empty() || fim_arquivo;});
+        if (fila.empty()) return;
+        T = fila.front();
+        fila.pop_front();
+      }
+      cv_espaco.notify_one();
+      analisar(*T,NI,NP);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int t=0; t<num_threads; t++) threads.emplace_back(trabalho);
+
+  auto entregar = [&](std::unique_ptr<Trecho> T)
+  {
+    std::unique_lock<std::mutex> lock(mtx);
+    cv_espaco.wait(lock, [&]() {return fila.size()<max_fila;});
+    fila.push_back(T.get());
+    trechos.push_back(std::move(T));
+    lock.unlock();
+    cv_fila.notify_one();
+  };
+  entregar(std::move(primeiro));
+  while (true)
+  {
+    std::unique_ptr<Trecho> T(new Trecho());
+    if (!lerBloco(T->texto)) break;
+    T->ini = 0;
+    entregar(std::move(T));
+  }
+  std::fclose(F);
+  {
+    std::lock_guard<std::mutex> lock(mtx);
+    fim_arquivo = true;
+  }
+  cv_fila.notify_all();
+  for (std::thread& th : threads) th.join();
+
+  std::vector<Trecho*> prov(trechos.size());
+  for (size_t k=0; k<trechos.size(); k++) prov[k] = trechos[k].get();
+  if (montar(prov,C)) return true;
+
+  // Um formato que a analise em paralelo nao trata (ou um erro): leitura sequencial
+  trechos.clear();
+  sequencial = true;
+  return C.ler(Arq);
+}
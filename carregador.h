@@ -0,0 +1,80 @@
+#ifndef _CARREGADOR_H_
+#define _CARREGADOR_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "circuito.h"
+
+///
+/// CLASSE CARREGADOR DE CIRCUITO
+///
+/// Leh um circuito de arquivo (no mesmo formato de Circuito::ler) em linha de
+/// producao, para circuitos muito grandes:
+/// - a thread que chama carregar leh o arquivo em blocos (terminados em fim de linha)
+///   e os entrega, por uma fila limitada, as threads de trabalho;
+/// - cada thread de trabalho analisa as linhas da secao PORTAS do seu bloco, sem
+///   iostream, e jah confere os tipos, o numero de entradas e as ids de origem (as
+///   dimensoes do cabecalho sao conhecidas), enquanto os blocos seguintes ainda estao
+///   sendo lidos do disco;
+/// - no fim, as portas dos blocos sao copiadas para o circuito, e o indice de fan-out
+///   (Circuito) e a versao compilada (CircuitoCompilado, com a ordem de simulacao)
+///   sao construidos ao mesmo tempo, em threads diferentes: o circuito sai pronto
+///   para a primeira simulacao.
+/// A analise em paralelo supoe uma porta por linha, como gravado por
+/// Circuito::salvar. Arquivos comprimidos, com modulos, com portas SB, com as portas
+/// quebradas em varias linhas ou com qualquer erro sao lidos de novo por
+/// Circuito::ler: o resultado (e a deteccao de erros) eh sempre o mesmo de
+/// Circuito::ler.
+///
+
+class CarregadorCircuito {
+public:
+  // O tamanho padrao dos blocos lidos do arquivo
+  static constexpr size_t TAM_BLOCO_PADRAO = size_t(1)<<20;
+
+private:
+  // Um bloco do arquivo e o resultado da sua analise
+  struct Trecho {
+    std::string texto;
+    // A posicao do texto onde comecam as portas
+    size_t ini;
+    // A id da primeira porta do trecho e, para cada porta, o tipo, o numero de
+    // entradas e as entradas
+    int primeira;
+    std::vector<CodigoPorta> tipo;
+    std::vector<int> num_in;
+    std::vector<int> id_in;
+    // A posicao da primeira linha que nao eh uma porta (-1 se nao houver)
+    long fim;
+    bool erro;
+  };
+
+  int num_threads;
+  size_t tam_bloco;
+  bool compilar;
+  bool sequencial;
+
+  // Analisa as portas de um trecho de um circuito com NI entradas e NP portas
+  static void analisar(Trecho& T, int NI, int NP);
+  // Monta o circuito C a partir dos trechos analisados
+  // Retorna false se o arquivo tiver que ser lido por Circuito::ler
+  bool montar(std::vector<Trecho*>& Trechos, Circuito& C) const;
+
+public:
+  // NumThreads: o numero de threads de trabalho (0: uma a menos que o numero de
+  // processadores, no minimo 1)
+  explicit CarregadorCircuito(int NumThreads=0, size_t TamBloco=TAM_BLOCO_PADRAO);
+
+  // Compila (ou nao) o circuito durante a carga (padrao: compila)
+  void setCompilar(bool Compilar);
+
+  // Leh o circuito do arquivo Arq para C
+  // Retorna true se deu tudo OK; false se deu erro (nesse caso, C fica vazio)
+  bool carregar(const std::string& Arq, Circuito& C);
+
+  // Retorna true se a ultima carga foi feita por Circuito::ler (ver acima)
+  bool isSequencial() const;
+};
+
+#endif // _CARREGADOR_H_
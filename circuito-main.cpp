@@ -1,10 +1,25 @@
 #include <iostream>
 #include <string>
 #include "circuito.h"
+#include "simulador_nativo.h"
+#include "simulacao_temporizada.h"
+#include "simulacao_sincrona.h"
+#include "vcd.h"
+#include "equivalencia.h"
+#include "tabela_bdd.h"
+#include "tabela_indexada.h"
 
 using namespace std;
 
 void gerarTabela(Circuito& C);
+void gerarTabelaNativa(Circuito& C);
+void simularTemporizado(Circuito& C);
+void simularSincrono(Circuito& C);
+void salvarVCD(Circuito& C, const string& nome);
+bool proximaEntrada(vector<bool3S>& in_circ);
+void verificarEquivalencia(Circuito& C, const string& nome);
+void gerarTabelaBDD(Circuito& C);
+void gerarTabelaIndexada(Circuito& C, const string& nome);
 
 int main(void)
 {
@@ -21,22 +36,41 @@ int main(void)
       cout << "3 - Ler um circuito de arquivo\n";
       cout << "4 - Imprimir o circuito na tela\n";
       cout << "5 - Simular o circuito para todas as entrada (gerar tabela verdade)\n";
+      cout << "6 - Gerar tabela verdade com o simulador compilado (codigo nativo)\n";
+      cout << "7 - Simulacao temporizada (forma de onda)\n";
+      cout << "8 - Salvar a simulacao de todas as entradas em arquivo VCD\n";
+      cout << "9 - Verificar a equivalencia com um circuito de arquivo\n";
+      cout << "10 - Gerar tabela verdade compacta (BDD)\n";
+      cout << "11 - Salvar a tabela verdade indexada (acesso direto) em arquivo\n";
+      cout << "12 - Simulacao sincrona (flip-flops, ciclo a ciclo de relogio)\n";
       cout << "Qual sua opcao? ";
       cin >> opcao;
-    } while(opcao<0 || opcao>5);
+    } while(opcao<0 || opcao>12);
     switch(opcao){
     case 1:
       C.digitar();
       break;
     case 2:
     case 3:
+    case 8:
+    case 9:
+    case 11:
       // Antes de ler a string com o nome do arquivo, esvaziar o buffer do teclado
       cin.ignore(256,'\n');
       do {
         cout << "Arquivo: ";
         getline(cin,nome);
       } while (nome.size() < 3); // Name do arquivo >= 3 caracteres
-      if (opcao==3) {
+      if (opcao==8) {
+        salvarVCD(C,nome);
+      }
+      else if (opcao==11) {
+        gerarTabelaIndexada(C,nome);
+      }
+      else if (opcao==9) {
+        verificarEquivalencia(C,nome);
+      }
+      else if (opcao==3) {
         if (!C.ler(nome))
         {
           // Erro na leitura
@@ -44,7 +78,9 @@ int main(void)
         }
       }
       else {
-        if (!C.salvar(nome))
+        // Arquivos terminados em .blc sao salvos no formato comprimido
+        const bool comprimido = (nome.size()>4 && nome.compare(nome.size()-4,4,".blc")==0);
+        if (!(comprimido ? C.salvarComprimido(nome) : C.salvar(nome)))
         {
           // Erro no salvamento
           cerr << "Arquivo " << nome << " invalido para escrita\n";
@@ -57,6 +93,18 @@ int main(void)
     case 5:
       gerarTabela(C);
       break;
+    case 6:
+      gerarTabelaNativa(C);
+      break;
+    case 7:
+      simularTemporizado(C);
+      break;
+    case 10:
+      gerarTabelaBDD(C);
+      break;
+    case 12:
+      simularSincrono(C);
+      break;
     default:
       break;
     }
@@ -114,3 +162,247 @@ void gerarTabela(Circuito& C)
   } while (i>=0);
 }
 
+
+// Gera a mesma tabela verdade que gerarTabela, mas simulando 64 linhas de cada vez
+// com o simulador compilado para o circuito (codigo nativo)
+void gerarTabelaNativa(Circuito& C)
+{
+  SimuladorNativo S;
+  if (!S.carregar(C))
+  {
+    cerr << "Nao foi possivel gerar o simulador compilado para o circuito\n";
+    return;
+  }
+
+  vector<bool3S> in_circ(C.getNumInputs(), bool3S::UNDEF);
+  vector<vector<bool3S>> linhas;
+  vector<Lote3S> in_lote(C.getNumInputs()), out_lote;
+  int i;
+  bool fim = false;
+
+  cout << "ENTRADAS" << '\t' << "SAIDAS" << endl;
+  while (!fim)
+  {
+    // Monta um lote com ateh NUM_PISTAS linhas da tabela
+    linhas.clear();
+    while (!fim && int(linhas.size())<NUM_PISTAS)
+    {
+      for (i=0; i<C.getNumInputs(); i++) setPista(in_lote.at(i), linhas.size(), in_circ.at(i));
+      linhas.push_back(in_circ);
+      fim = !proximaEntrada(in_circ);
+    }
+
+    // Simulacao
+    S.simularLote(in_lote, out_lote);
+
+    // Impressao
+    for (size_t k=0; k<linhas.size(); k++)
+    {
+      for (i=0; i<C.getNumInputs(); i++)
+      {
+        cout << linhas.at(k).at(i);
+        if (i<C.getNumInputs()-1) cout << ' ';
+        else
+        {
+          cout <<'\t';
+          if (C.getNumInputs()<=2) cout <<'\t';
+        }
+      }
+      for (i=0; i<C.getNumOutputs(); i++)
+      {
+        cout << getPista(out_lote.at(i), k);
+        if (i<C.getNumOutputs()-1) cout << ' ';
+        else cout << '\n';
+      }
+    }
+  }
+}
+
+// Simulacao temporizada: o usuario digita uma sequencia de vetores de entrada,
+// cada um aplicado durante um numero fixo de passos de tempo, e a forma de onda
+// de todos os sinais eh impressa ao final
+void simularTemporizado(Circuito& C)
+{
+  SimulacaoTemporizada T;
+  int NVet, NPassos;
+
+  if (!T.iniciar(C))
+  {
+    cerr << "Circuito invalido para simulacao\n";
+    return;
+  }
+  do {
+    cout << "Numero de vetores de entrada: ";
+    cin >> NVet;
+  } while (NVet<=0);
+  do {
+    cout << "Passos de tempo por vetor: ";
+    cin >> NPassos;
+  } while (NPassos<=0);
+
+  vector<bool3S> in_circ(C.getNumInputs());
+  T.setRegistrar(true);
+  for (int k=0; k<NVet; k++)
+  {
+    cout << "Vetor " << k+1 << " (" << C.getNumInputs() << " valores ? F T): ";
+    for (int i=0; i<C.getNumInputs(); i++) cin >> in_circ.at(i);
+    T.setEntradas(in_circ);
+    T.avancar(NPassos);
+  }
+  cout << endl;
+  T.imprimirFormaOnda(cout, 0, T.getTempo());
+}
+
+// Simula o circuito ciclo a ciclo de relogio, com as entradas de cada ciclo digitadas
+// pelo usuario, e imprime as saidas (antes da borda do relogio) e os flip-flops
+void simularSincrono(Circuito& C)
+{
+  SimulacaoSincrona S;
+  int NCiclos;
+  bool3S inicial;
+
+  if (!S.iniciar(C))
+  {
+    cerr << "Circuito invalido para simulacao sincrona (realimentacao sem flip-flop?)\n";
+    return;
+  }
+  do {
+    cout << "Numero de ciclos: ";
+    cin >> NCiclos;
+  } while (NCiclos<=0);
+  cout << "Estado inicial dos flip-flops (? F T): ";
+  cin >> inicial;
+  S.reiniciar(inicial);
+
+  // Os flip-flops, procurados uma unica vez pelo codigo do tipo
+  const CodigoPorta FF = RegistroPortas::getCodigo("FF");
+  vector<int> flip_flops;
+  for (int i=0; i<C.getNumPorts(); i++)
+  {
+    if (C.getCodigoPort(i+1)==FF) flip_flops.push_back(i+1);
+  }
+
+  vector<Lote3S> in_circ(C.getNumInputs()), out_circ(C.getNumOutputs());
+  bool3S x;
+  for (int k=0; k<NCiclos; k++)
+  {
+    cout << "Ciclo " << k << " (" << C.getNumInputs() << " valores ? F T): ";
+    for (int i=0; i<C.getNumInputs(); i++)
+    {
+      cin >> x;
+      in_circ.at(i) = lote3S(x);
+    }
+    S.passo(in_circ.data(), out_circ.data());
+    cout << "  Saidas:";
+    for (int i=0; i<C.getNumOutputs(); i++) cout << ' ' << getPista(out_circ.at(i),0);
+    cout << "\tFlip-flops:";
+    for (int IdPort : flip_flops) cout << ' ' << getPista(S.getEstado(IdPort,0),0);
+    cout << '\n';
+  }
+}
+
+// Passa para a proxima combinacao de entradas, na mesma ordem de gerarTabela
+// Retorna false se jah estava na ultima (todas TRUE)
+bool proximaEntrada(vector<bool3S>& in_circ)
+{
+  int i = int(in_circ.size())-1;
+  while (i>=0 && in_circ.at(i)==bool3S::TRUE)
+  {
+    in_circ.at(i)++;
+    i--;
+  };
+  if (i<0) return false;
+  in_circ.at(i)++;
+  return true;
+}
+
+// Simula o circuito para todas as entradas (mesma ordem de gerarTabela), 64 de cada
+// vez, e salva a evolucao dos sinais em um arquivo VCD: um instante por linha da tabela
+void salvarVCD(Circuito& C, const string& nome)
+{
+  EscritorVCD VCD;
+  if (!VCD.abrir(nome, C))
+  {
+    cerr << "Arquivo " << nome << " invalido para escrita\n";
+    return;
+  }
+
+  vector<bool3S> in_circ(C.getNumInputs(), bool3S::UNDEF);
+  vector<Lote3S> in_lote(C.getNumInputs()), out_lote, sinais_lote;
+  long linha = 0;
+  bool fim = false;
+
+  while (!fim)
+  {
+    int n = 0;
+    while (!fim && n<NUM_PISTAS)
+    {
+      for (int i=0; i<C.getNumInputs(); i++) setPista(in_lote.at(i), n, in_circ.at(i));
+      n++;
+      fim = !proximaEntrada(in_circ);
+    }
+    if (!C.simularLote(in_lote, out_lote, sinais_lote))
+    {
+      VCD.fechar();
+      cerr << "Erro na simulacao do circuito para o arquivo " << nome << endl;
+      return;
+    }
+    VCD.registrarLote(linha, sinais_lote.data(), n);
+    linha += n;
+  }
+  if (!VCD.fechar()) cerr << "Erro na escrita do arquivo " << nome << endl;
+}
+
+// Verifica se o circuito C eh equivalente ao circuito do arquivo nome
+void verificarEquivalencia(Circuito& C, const string& nome)
+{
+  Circuito C2;
+  VerificadorEquivalencia V;
+
+  if (!C2.ler(nome))
+  {
+    cerr << "Arquivo " << nome << " invalido para leitura\n";
+    return;
+  }
+  V.verificar(C, C2);
+  V.imprimir();
+}
+
+// Gera a tabela verdade a partir dos BDDs das saidas, agrupando as linhas em que
+// alguma entrada nao influi, e conta as linhas com cada valor de cada saida
+void gerarTabelaBDD(Circuito& C)
+{
+  TabelaBDD T;
+  if (!T.construir(C))
+  {
+    cerr << "Nao foi possivel construir os BDDs do circuito\n";
+    return;
+  }
+  T.imprimirTabela(cout);
+  cout << "Nos dos BDDs: " << T.getNumNos() << '\n';
+  for (int i=0; i<T.getNumOutputs(); i++)
+  {
+    cout << "Saida " << i+1 << ": "
+         << T.contar(i+1, bool3S::TRUE) << " T, "
+         << T.contar(i+1, bool3S::FALSE) << " F, "
+         << T.contar(i+1, bool3S::UNDEF) << " ?\n";
+  }
+}
+
+// Grava a tabela verdade indexada do circuito e informa o seu tamanho
+void gerarTabelaIndexada(Circuito& C, const string& nome)
+{
+  if (!TabelaIndexada::gerar(C,nome))
+  {
+    cerr << "Nao foi possivel gerar a tabela indexada no arquivo " << nome << '\n';
+    return;
+  }
+  TabelaIndexada T;
+  if (!T.abrir(nome))
+  {
+    cerr << "Arquivo " << nome << " invalido para leitura\n";
+    return;
+  }
+  cout << "Tabela com " << T.getNumLinhas() << " linhas de "
+       << T.getBytesPorLinha() << " bytes\n";
+}
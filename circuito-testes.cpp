@@ -0,0 +1,371 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "circuito.h"
+#include "estimulos.h"
+#include "lote3S.h"
+#include "simulador_nativo.h"
+#include "simulacao_temporizada.h"
+#include "equivalencia.h"
+#include "tabela_bdd.h"
+#include "tabela_indexada.h"
+#include "escritor.h"
+#include "simulacao_sincrona.h"
+#include "validador.h"
+
+using namespace std;
+
+///
+/// VERIFICACAO DOS SIMULADORES
+///
+/// Programa de teste (alvo Testes do projeto): confere os resultados de cada
+/// simulador e de cada estrutura derivada do circuito com a simulacao de referencia
+/// (Circuito::simular), para todas as combinacoes de entradas.
+/// A simulacao sincrona (flip-flops FF) eh conferida em um circuito sequencial, com
+/// a referencia aplicada ciclo a ciclo.
+/// Uso: circuito-testes [circuito combinacional] [circuito sequencial]
+/// (padrao: circuito.txt e circuito_ff.txt, no diretorio atual)
+/// Imprime uma linha por verificacao e retorna 0 se nenhuma falhar
+///
+
+// O maior numero de entradas do circuito testado (3^12 combinacoes)
+const int MAX_ENTRADAS_TESTE = 12;
+
+int falhas = 0;
+
+// Registra o resultado de uma verificacao
+void conferir(const string& Nome, bool OK)
+{
+  cout << (OK ? "OK      " : "FALHA   ") << Nome << '\n';
+  if (!OK) falhas++;
+}
+
+// Uma verificacao que nao pode ser feita neste sistema (nao conta como falha)
+void ignorar(const string& Nome, const string& Motivo)
+{
+  cout << "IGNORADO " << Nome << " (" << Motivo << ")\n";
+}
+
+// As saidas de C para as entradas in_circ, pela simulacao de referencia
+vector<bool3S> referencia(Circuito& C, const vector<bool3S>& in_circ)
+{
+  vector<bool3S> out_circ(C.getNumOutputs());
+  C.simular(in_circ);
+  for (int j=0; j<C.getNumOutputs(); j++) out_circ[j] = C.getOutput(j+1);
+  return out_circ;
+}
+
+/// ***********************
+/// Simulador nativo
+/// ***********************
+
+// Todos os lotes da enumeracao exaustiva, pela biblioteca gerada
+void testarNativo(Circuito& C)
+{
+#ifndef _WIN32
+  SimuladorNativo N;
+  if (!N.carregar(C))
+  {
+    ignorar("simulador nativo", "compilador indisponivel");
+    return;
+  }
+  const EnumeradorExaustivo E(C.getNumInputs());
+  vector<Lote3S> in_lote(C.getNumInputs()), out_lote;
+  bool ok = true;
+  for (uint64_t K=0; ok && K<E.getNumLotes(); K++)
+  {
+    const int NPistas = E.gerarLote(K,in_lote.data());
+    ok = N.simularLote(in_lote,out_lote);
+    for (int k=0; ok && k<NPistas; k++)
+    {
+      const vector<bool3S> ref = referencia(C,E.getVetor(K*NUM_PISTAS+k));
+      for (int j=0; ok && j<C.getNumOutputs(); j++) ok = (getPista(out_lote[j],k)==ref[j]);
+    }
+  }
+  conferir("simulador nativo", ok);
+#else
+  ignorar("simulador nativo", "sem dlopen");
+#endif
+}
+
+/// ***********************
+/// Simulacao temporizada
+/// ***********************
+
+// Cada combinacao de entradas eh aplicada a uma simulacao nova, com todos os sinais
+// indefinidos: como cada sinal so pode passar de ? a um valor definido, a simulacao
+// sempre estabiliza, nas saidas da referencia (inclusive com realimentacao)
+void testarTemporizada(Circuito& C)
+{
+  SimulacaoTemporizada S;
+  const EnumeradorExaustivo E(C.getNumInputs());
+  bool ok = true;
+  for (uint64_t R=0; ok && R<E.getNumVetores(); R++)
+  {
+    const vector<bool3S> in_circ = E.getVetor(R);
+    const vector<bool3S> ref = referencia(C,in_circ);
+    ok = S.iniciar(C) && S.setEntradas(in_circ) && S.estabilizar(1000000);
+    for (int j=0; ok && j<C.getNumOutputs(); j++) ok = (S.getOutput(j+1)==ref[j]);
+  }
+  conferir("simulacao temporizada", ok);
+}
+
+/// ***********************
+/// Verificacao de equivalencia
+/// ***********************
+
+// C contra uma copia (equivalentes) e contra uma copia com a porta 1 trocada por
+// uma XO (ou NX) das suas duas primeiras entradas: o resultado deve ser o da
+// comparacao das saidas pela referencia, e a diferenca apontada deve existir
+void testarEquivalencia(Circuito& C)
+{
+  VerificadorEquivalencia V;
+  Circuito copia(C);
+  conferir("equivalencia (copia)", V.verificar(C,copia) && V.isExaustivo());
+
+  Circuito D(C);
+  const int I0 = D.getId_inPort(1,0);
+  const int I1 = (D.getNumInputsPort(1)>1 ? D.getId_inPort(1,1) : I0);
+  D.setPort(1, (D.getNamePort(1)=="XO" ? "NX" : "XO"), 2);
+  D.setId_inPort(1,0,I0);
+  D.setId_inPort(1,1,I1);
+
+  bool iguais = true;
+  const EnumeradorExaustivo E(C.getNumInputs());
+  for (uint64_t R=0; iguais && R<E.getNumVetores(); R++)
+  {
+    const vector<bool3S> in_circ = E.getVetor(R);
+    iguais = (referencia(C,in_circ)==referencia(D,in_circ));
+  }
+  bool ok = (V.verificar(C,D)==iguais && V.isCompativeis());
+  if (ok && !iguais)
+  {
+    const int j = V.getSaidaDiferente();
+    ok = (referencia(C,V.getEntradaDiferente())[j-1]==V.getValor1() &&
+          referencia(D,V.getEntradaDiferente())[j-1]==V.getValor2() &&
+          V.getValor1()!=V.getValor2());
+  }
+  conferir("equivalencia (porta alterada)", ok);
+}
+
+/// ***********************
+/// Tabela verdade em BDD
+/// ***********************
+
+// Cada saida consultada no BDD, e as contagens de cada valor por saida
+void testarBDD(Circuito& C)
+{
+  TabelaBDD T;
+  if (!T.construir(C))
+  {
+    conferir("tabela BDD", false);
+    return;
+  }
+  const EnumeradorExaustivo E(C.getNumInputs());
+  vector<vector<uint64_t>> contagem(C.getNumOutputs(), vector<uint64_t>(3,0));
+  bool ok = true;
+  for (uint64_t R=0; ok && R<E.getNumVetores(); R++)
+  {
+    const vector<bool3S> in_circ = E.getVetor(R);
+    const vector<bool3S> ref = referencia(C,in_circ);
+    for (int j=0; ok && j<C.getNumOutputs(); j++)
+    {
+      ok = (T.getOutput(j+1,in_circ)==ref[j]);
+      contagem[j][int(ref[j])]++;
+    }
+  }
+  for (int j=0; ok && j<C.getNumOutputs(); j++)
+  {
+    for (int v=0; ok && v<3; v++) ok = (T.contar(j+1,bool3S(v))==contagem[j][v]);
+  }
+  conferir("tabela BDD", ok);
+}
+
+/// ***********************
+/// Tabela indexada
+/// ***********************
+
+// Gera a tabela em um arquivo temporario, abre e consulta cada linha
+void testarTabelaIndexada(Circuito& C)
+{
+  const string arq = "circuito-testes.idx";
+  TabelaIndexada T;
+  bool ok = TabelaIndexada::gerar(C,arq) && T.abrir(arq) &&
+            T.getNumLinhas()==EnumeradorExaustivo(C.getNumInputs()).getNumVetores();
+  const EnumeradorExaustivo E(C.getNumInputs());
+  vector<bool3S> out_circ;
+  for (uint64_t R=0; ok && R<E.getNumVetores(); R++)
+  {
+    const vector<bool3S> in_circ = E.getVetor(R);
+    ok = (T.getIndice(in_circ)==R && T.consultar(R,out_circ) &&
+          out_circ==referencia(C,in_circ));
+  }
+  T.fechar();
+  remove(arq.c_str());
+  conferir("tabela indexada", ok);
+}
+
+/// ***********************
+/// Escritor de circuitos
+/// ***********************
+
+// Grava o circuito pelo escritor (com blocos pequenos e varias threads, para
+// exercitar a divisao em blocos), le de volta e confere: o circuito lido simula
+// como o original, e a sua gravacao eh identica a primeira
+void testarEscritor(Circuito& C)
+{
+  const string arq = "circuito-testes.txt";
+  const EscritorCircuito W(4,4096);
+  Circuito L;
+  bool ok = W.salvar(C,arq) && L.ler(arq);
+  const EnumeradorExaustivo E(C.getNumInputs());
+  for (uint64_t R=0; ok && R<E.getNumVetores(); R++)
+  {
+    const vector<bool3S> in_circ = E.getVetor(R);
+    ok = (referencia(L,in_circ)==referencia(C,in_circ));
+  }
+  if (ok)
+  {
+    ostringstream texto1, texto2;
+    ifstream ArqI(arq);
+    texto1 << ArqI.rdbuf();
+    ok = W.escrever(L,texto2) && texto1.str()==texto2.str();
+  }
+  remove(arq.c_str());
+  conferir("escritor de circuitos", ok);
+}
+
+/// ***********************
+/// Simulacao sincrona
+/// ***********************
+
+// O circuito combinacional de um ciclo de S: cada flip-flop vira uma entrada a mais
+// (o estado atual, depois das Nin entradas de S), e as entradas D dos flip-flops
+// viram saidas a mais (o proximo estado, depois das Nout saidas de S)
+Circuito desdobrar(const Circuito& S, vector<int>& FFs)
+{
+  const int NI = S.getNumInputs(), NO = S.getNumOutputs(), NP = S.getNumPorts();
+  FFs.clear();
+  for (int p=1; p<=NP; p++) if (S.getNamePort(p)=="FF") FFs.push_back(p);
+  const int NF = FFs.size();
+
+  Circuito D;
+  D.resize(NI+NF, NO+NF, NP);
+  for (int p=1; p<=NP; p++)
+  {
+    D.setPort(p, S.getCodigoPort(p), S.getNumInputsPort(p));
+    for (int I=0; I<S.getNumInputsPort(p); I++) D.setId_inPort(p,I,S.getId_inPort(p,I));
+  }
+  for (int k=0; k<NF; k++)
+  {
+    D.setPort(FFs[k], "BF", 1);
+    D.setId_inPort(FFs[k], 0, -(NI+k+1));
+    D.setIdOutput(NO+k+1, S.getId_inPort(FFs[k],0));
+  }
+  for (int j=0; j<NO; j++) D.setIdOutput(j+1, S.getIdOutput(j+1));
+  return D;
+}
+
+// 64 sequencias aleatorias (uma por pista) de NCiclos ciclos: as saidas de cada
+// ciclo e o estado dos flip-flops devem ser os do circuito desdobrado simulado pela
+// referencia, com o estado de cada pista comecando em ?
+void testarSincrona(Circuito& C)
+{
+  const long NCiclos = 40;
+  Circuito S(C.temInstancias() ? C.achatar() : C);
+  vector<int> FFs;
+  Circuito D = desdobrar(S,FFs);
+  const int NI = S.getNumInputs(), NO = S.getNumOutputs(), NF = FFs.size();
+
+  SimulacaoSincrona Sinc;
+  bool ok = Sinc.iniciar(S) && Sinc.getNumFlipFlops()==NF;
+  vector<vector<bool3S>> estado(NUM_PISTAS, vector<bool3S>(NF,bool3S::UNDEF));
+  vector<Lote3S> in_lote(NI), out_lote(NO);
+  mt19937 G(2024);
+  for (long c=0; ok && c<NCiclos; c++)
+  {
+    vector<vector<bool3S>> in_pista(NUM_PISTAS, vector<bool3S>(NI));
+    for (int i=0; i<NI; i++) in_lote[i] = lote3S(bool3S::UNDEF);
+    for (int k=0; k<NUM_PISTAS; k++)
+    {
+      for (int i=0; i<NI; i++)
+      {
+        in_pista[k][i] = bool3S(G()%3);
+        setPista(in_lote[i],k,in_pista[k][i]);
+      }
+    }
+    Sinc.passo(in_lote.data(),out_lote.data());
+
+    for (int k=0; ok && k<NUM_PISTAS; k++)
+    {
+      vector<bool3S> in_D(in_pista[k]);
+      in_D.insert(in_D.end(),estado[k].begin(),estado[k].end());
+      const vector<bool3S> ref = referencia(D,in_D);
+      for (int j=0; ok && j<NO; j++) ok = (getPista(out_lote[j],k)==ref[j]);
+      for (int f=0; ok && f<NF; f++)
+      {
+        estado[k][f] = ref[NO+f];
+        ok = (getPista(Sinc.getEstado(FFs[f],0),k)==estado[k][f]);
+      }
+    }
+  }
+  conferir("simulacao sincrona", ok);
+}
+
+// A realimentacao que passa por flip-flops nao eh laco combinacional: o circuito
+// sequencial deve ser validado sem avisos. Trocar os flip-flops por buffers deve
+// fazer aparecer os lacos
+void testarValidador(const Circuito& C)
+{
+  ValidadorCircuito V;
+  bool ok = V.verificar(C) && V.getNumAvisos()==0;
+  conferir("validador (lacos com flip-flops)", ok);
+
+  Circuito B(C);
+  for (int p=1; p<=B.getNumPorts(); p++)
+  {
+    if (B.getNamePort(p)!="FF") continue;
+    const int Id = B.getId_inPort(p,0);
+    B.setPort(p, "BF", 1);
+    B.setId_inPort(p, 0, Id);
+  }
+  ok = V.verificar(B) && V.getNumAvisos()>0;
+  conferir("validador (lacos sem flip-flops)", ok);
+}
+
+int main(int argc, char** argv)
+{
+  const string arq = (argc>1 ? argv[1] : "circuito.txt");
+
+  Circuito C;
+  if (!C.ler(arq) || C.getNumInputs()>MAX_ENTRADAS_TESTE)
+  {
+    cerr << "Erro na leitura do circuito " << arq << " (ou mais de " << MAX_ENTRADAS_TESTE
+         << " entradas)\n";
+    return 2;
+  }
+
+  testarNativo(C);
+  testarTemporizada(C);
+  testarEquivalencia(C);
+  testarBDD(C);
+  testarTabelaIndexada(C);
+  testarEscritor(C);
+
+  const string arq_ff = (argc>2 ? argv[2] : "circuito_ff.txt");
+  Circuito F;
+  if (!F.ler(arq_ff) || F.getNumInputs()>MAX_ENTRADAS_TESTE)
+  {
+    cerr << "Erro na leitura do circuito " << arq_ff << '\n';
+    return 2;
+  }
+  testarSincrona(F);
+  testarValidador(F);
+
+  cout << (falhas==0 ? "Todas as verificacoes OK\n" : "Ha verificacoes com falha\n");
+  return (falhas==0 ? 0 : 1);
+}
@@ -4,8 +4,20 @@
 #include <iostream>
 #include <string>
 #include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
 #include "bool3S.h"
 #include "port.h"
+#include "registro_portas.h"
+#include "circuito_compilado.h"
+#include "lote3S.h"
+#include "vetor_compacto3S.h"
+
+// Um subcircuito com nome, que pode ser instanciado pelas portas SB (ver modulo.h)
+class Modulo;
+typedef std::shared_ptr<const Modulo> ptr_Modulo;
+struct EstadoSimulacao;
 
 /// ###########################################################################
 /// ATENCAO PARA A CONVENCAO DOS NOMES PARA OS PARAMETROS DAS FUNCOES:
@@ -34,7 +46,7 @@ private:
 
   // Nao precisa manter variaveis para guardar o numero de saidas e ports.
   // Essas informacoes estao armazenadas nos tamanhos (size) dos vetores correspondentes:
-  // id_out e ports, respectivamente
+  // id_out e portas->tipo, respectivamente
   // Os metodos de consulta getNumInputs, getNumOutputs e getNumPorts dao acesso a essas
   // informacoes de maneira eficiente
 
@@ -45,9 +57,166 @@ private:
   std::vector<bool3S> out_circ; // vetor a ser alocado com dimensao "Nout"
 
   // As portas
-  std::vector<ptr_Port> ports;  // vetor a ser alocado com dimensao "Nports"
+  // Guardadas em vetores paralelos (struct-of-arrays), sem um objeto Port por porta:
+  // - tipo[i]: o codigo (RegistroPortas) do tipo da porta de indice i (id i+1),
+  //   CODIGO_INSTANCIA se for uma instancia de modulo (SB) ou CODIGO_INVALIDO se a
+  //   porta nao estiver definida
+  // - as ids de origem das entradas de todas as portas ficam em um unico vetor (CSR):
+  //   as da porta de indice i sao id_in[ini_in[i]] ate id_in[ini_in[i]+num_in[i]-1]
+  // Quando o numero de entradas de uma porta muda (setPort), as suas entradas passam
+  // para o fim de id_in e as antigas ficam sem uso (lixo) ateh a proxima compactacao,
+  // que recoloca as entradas na ordem das portas. Assim, a leitura e a impressao do
+  // circuito percorrem id_in sequencialmente
+  // O conjunto eh compartilhado (contagem de referencias) entre as copias de um mesmo
+  // circuito e soh eh duplicado quando uma das copias for alterada (copy-on-write):
+  // ver detachPortas. Um circuito vazio (ou que teve o conteudo movido) tem
+  // portas == nullptr
+  struct Portas {
+    std::vector<CodigoPorta> tipo;   // dimensao "Nports"
+    std::vector<int> ini_in;         // dimensao "Nports"
+    std::vector<int> num_in;         // dimensao "Nports"
+    std::vector<int> id_in;
+    // Numero de elementos de id_in sem uso
+    size_t lixo;
+    // O modulo e a saida usada por cada instancia (SB), indexados pelo indice da porta
+    std::map<int,std::pair<ptr_Modulo,int>> instancias;
+
+    // NP portas nao definidas
+    explicit Portas(int NP);
+    // A porta de indice i passa a ser do tipo Codigo, com N entradas (ids 0)
+    // Retorna a posicao da primeira entrada em id_in
+    int definir(int i, CodigoPorta Codigo, int N);
+    // Recoloca as entradas na ordem das portas, eliminando o lixo
+    void compactar();
+  };
+  std::shared_ptr<Portas> portas;
+
+  // Garante que as portas nao estao compartilhadas com nenhuma outra copia do
+  // circuito, duplicando-as (compactadas) caso estejam
+  // Deve ser chamada antes de qualquer alteracao nas portas
+  void detachPortas();
+
+  // O indice de fan-out: para cada sinal (indexado por CircuitoCompilado::indiceSinal),
+  // os seus consumidores: IdPort (>0) para cada entrada de porta ligada ao sinal e
+  // -IdOutput (<0) para cada saida do circuito ligada a ele
+  // No mesmo formato CSR das entradas das portas, mas com folga: os consumidores do
+  // sinal s sao cons[ini[s]] ate cons[ini[s]+num[s]-1], com espaco para cap[s]
+  // Um sinal sem espaco livre passa para o fim de cons com o dobro da capacidade;
+  // o vetor eh compactado quando o espaco abandonado (lixo) passa da metade
+  // Construido na leitura (construirFanout) e atualizado a cada alteracao das ligacoes
+  // (setPort, setId_inPort, setIdOutput, setPortModulo), em O(fan-out dos sinais
+  // envolvidos). Compartilhado entre as copias (copy-on-write, ver detachFanout)
+  struct IndiceFanout {
+    std::vector<int> ini;    // dimensao "Nin+Nports"
+    std::vector<int> num;    // dimensao "Nin+Nports"
+    std::vector<int> cap;    // dimensao "Nin+Nports"
+    std::vector<int> cons;
+    size_t lixo;
+
+    // NS sinais sem consumidores
+    explicit IndiceFanout(int NS);
+    // Acrescenta (remove uma ocorrencia de) Consumidor ao (do) sinal de indice S
+    void incluir(int S, int Consumidor);
+    void excluir(int S, int Consumidor);
+    // Elimina o lixo e a folga, recolocando os sinais em ordem
+    void compactar();
+  };
+  std::shared_ptr<IndiceFanout> fanout;
+
+  // Retorna o indice do sinal IdOrig no indice de fan-out, ou -1 se IdOrig for invalida
+  int indiceFanout(int IdOrig) const;
+  // Reconstroi o indice de fan-out a partir das portas e das saidas, em O(Nin+Nports+ligacoes)
+  void construirFanout();
+  // Garante que o indice de fan-out nao estah compartilhado com nenhuma outra copia
+  void detachFanout();
+  // Retira do fan-out das suas origens as entradas da porta de indice i
+  void desligarEntradas(int i);
+
+  // A versao compilada do circuito (kernels especializados por porta), usada
+  // pelo metodo simular. Eh construida na primeira simulacao apos uma alteracao
+  // do circuito (setPort, setId_inPort, setIdOutput, ler, etc.), que a descartam
+  // Como nao eh alterada depois de construida, eh compartilhada entre as copias
+  std::shared_ptr<const CircuitoCompilado> programa;
+
+  // Os valores de todos os sinais (entradas do circuito e saidas das portas), em um
+  // unico vetor contiguo, calculados na ultima simulacao e indexados por
+  // CircuitoCompilado::indiceSinal (as Nin entradas seguidas das Nports portas)
+  // Compartilhado entre as copias; a simulacao aloca um novo vetor caso esteja
+  // compartilhado, em vez de alterar o das outras copias
+  // Na simulacao sob demanda, as consultas (const) tambem gravam os valores das
+  // portas avaliadas, e por isso podem ter que separar o vetor
+  mutable std::shared_ptr<std::vector<bool3S>> sinais;
+
+  // A simulacao sob demanda (ver setSobDemanda): simular apenas guarda as entradas
+  // em sinais, e cada consulta avalia somente as portas do cone de entrada do sinal
+  // consultado que ainda nao foram avaliadas desde a ultima simulacao
+  struct Demanda {
+    // O programa usado na ultima simulacao sob demanda (as alteracoes do circuito
+    // descartam apenas o programa do circuito)
+    std::shared_ptr<const CircuitoCompilado> programa;
+    // A epoca da ultima simulacao e a epoca em que cada porta foi avaliada: uma porta
+    // com epoca diferente ainda nao foi avaliada para as entradas atuais
+    uint32_t epoca;
+    std::vector<uint32_t> epoca_porta;
+    // A posicao de cada porta na ordem de simulacao do programa
+    std::vector<int> pos_ordem;
+    // Vetores de trabalho da busca no cone: o estado de cada porta (0: nao visitada,
+    // 1: na pilha, 2: concluida), a pilha (porta, proxima entrada) e as portas visitadas
+    std::vector<char> estado;
+    std::vector<std::pair<int,int>> pilha;
+    std::vector<int> cone;
+  };
+  bool sob_demanda;
+  // true se ha uma simulacao sob demanda cujos valores sao consultados em sinais
+  bool demanda_pendente;
+  // O estado da simulacao sob demanda (O(Nports)), compartilhado entre as copias como
+  // sinais: eh separado apenas quando uma copia vai altera-lo (nullptr se nunca usado)
+  mutable std::shared_ptr<Demanda> demanda;
+  // Protege sinais e demanda durante as consultas sob demanda (const), que podem ser
+  // feitas por varias threads ao mesmo tempo
+  mutable std::mutex mtx_demanda;
+
+  // Os atrasos (em passos de tempo) dos tipos de porta (NT, AN, etc.), usados
+  // apenas pela simulacao temporizada. Os tipos ausentes tem atraso ATRASO_PADRAO
+  std::map<std::string,int> atrasos;
+
+  // Os modulos (subcircuitos) que podem ser instanciados pelas portas SB deste
+  // circuito, em ordem de definicao (um modulo soh pode instanciar os anteriores)
+  // Cada modulo eh compilado uma unica vez e compartilhado por todas as instancias
+  // e por todas as copias do circuito
+  std::vector<ptr_Modulo> modulos;
+
+  // true se o circuito jah foi conferido e nao foi alterado depois (ver isValidado)
+  bool validado;
+
+  // O validador percorre diretamente as portas (ver validador.h)
+  friend class ValidadorCircuito;
+  // O carregador paralelo preenche diretamente as portas (ver carregador.h)
+  friend class CarregadorCircuito;
+  // O escritor formata diretamente as portas (ver escritor.h)
+  friend class EscritorCircuito;
+
+  // Leh de ArqI o corpo de um circuito (apos a palavra CIRCUITO): numero de entradas,
+  // saidas e portas, e as secoes PORTAS e SAIDAS. Gera uma excecao (int) em caso de erro
+  void lerCorpo(std::istream& ArqI);
+  // Leh de ArqI um arquivo completo (modulos, circuito e atrasos), como em ler
+  bool lerArquivo(std::istream& ArqI);
+  // Leh de ArqI a secao SAIDAS e a secao opcional ATRASOS (ateh o fim do arquivo)
+  // Geram uma excecao (int) em caso de erro
+  void lerSaidas(std::istream& ArqI);
+  void lerAtrasos(std::istream& ArqI);
+  // Prepara a simulacao sob demanda para as entradas que acabaram de ser gravadas em
+  // sinais (uma nova epoca)
+  void iniciarDemanda();
+  // Retorna o valor do sinal de indice S, avaliando as portas do seu cone de entrada
+  // ainda nao avaliadas na simulacao sob demanda pendente
+  // Deve ser chamada com mtx_demanda travado
+  bool3S avaliarSobDemanda(int S) const;
 
 public:
+  // O atraso dos tipos de porta sem atraso definido
+  static const int ATRASO_PADRAO = 1;
+
 
   /// ***********************
   /// Inicializacao e finalizacao
@@ -60,34 +229,33 @@ public:
 
   // Construtor por copia
   // Nin e os vetores id_out e out_circ serao copias dos equivalentes no Circuit C
-  // O vetor ports terah a mesma dimensao do equivalente no Circuit C
-  // Serah necessario utilizar a funcao virtual clone para criar copias das portas
+  // As portas passam a ser compartilhadas com o Circuit C: soh serao copiadas
+  // quando uma das copias for alterada
   Circuito(const Circuito& C);
   // Construtor por movimento
-  // Nin e os vetores id_out, out_circ e ports assumirao o conteudo dos equivalentes
+  // Nin, os vetores id_out e out_circ e as portas assumirao o conteudo dos equivalentes
   // no Circuit temporario C, que serah zerado
-  Circuito(Circuito&& C);
+  // Nao aloca memoria: custo O(1), independente do tamanho do circuito
+  Circuito(Circuito&& C) noexcept;
 
   // Destrutor: apenas chama a funcao clear()
   ~Circuito();
   // Limpa todo o conteudo do circuito. Faz Nin <- 0 e
-  // utiliza o metodo STL clear para limpar os vetores id_out, out_circ e ports
-  // ATENCAO: antes de dar um clear no vetor ports, tem que liberar (delete) as areas
-  // de memoria para as quais cada ponteiro desse vetor aponta.
+  // utiliza o metodo STL clear para limpar os vetores id_out e out_circ
+  // As portas deixam de ser usadas (e sao liberadas se nenhuma outra copia as
+  // compartilhar)
   void clear();
 
   // Operador de atribuicao por copia
   // Atribui (faz copia) de Nin e dos vetores id_out e out_circ
-  // ATENCAO: antes de alterar o vetor ports, tem que liberar (delete) as areas
-  // de memoria para as quais cada ponteiro desse vetor aponta.
-  // O vetor ports terah a mesma dimensao do equivalente no Circuit C
-  // Serah necessario utilizar a funcao virtual clone para criar copias das portas
+  // As portas anteriores deixam de ser usadas (e sao liberadas se nenhuma outra
+  // copia as compartilhar) e as de C passam a ser compartilhadas
   void operator=(const Circuito& C);
   // Operador de atribuicao por movimento
-  // Move Nin e os vetores id_out, out_circ e ports
-  // ATENCAO: antes de mover o vetor ports, tem que liberar (delete) as areas
-  // de memoria anteriores para as quais cada ponteiro desse vetor aponta.
-  void operator=(Circuito&& C);
+  // Move Nin, os vetores id_out e out_circ e as portas
+  // As portas anteriores deixam de ser usadas (e sao liberadas se nenhuma outra
+  // copia as compartilhar)
+  void operator=(Circuito&& C) noexcept;
 
   // Redimensiona o circuito para passar a ter NI entradas, NO saidas e NP ports
   // Inicialmente checa os parametros. Caso sejam validos,
@@ -95,7 +263,8 @@ public:
   // alteradas (resize) e sao inicializados com valores iniciais neutros ou invalidos:
   // id_out[i] <- 0
   // out_circ[i] <- UNDEF
-  // ports[i] <- nullptr
+  // tipo das portas <- CODIGO_INVALIDO (nao definidas), sem entradas
+  // Os modulos definidos (definirModulo) sao mantidos
   void resize(int NI, int NO, int NP);
 
   /// ***********************
@@ -117,7 +286,7 @@ public:
   bool validIdOrig(int IdOrig) const;
 
   // Retorna true se IdPort eh uma id de porta valida (validIdPort) e
-  // a porta estah definida (estah alocada, ou seja, != nullptr)
+  // a porta estah definida (tipo != CODIGO_INVALIDO)
   bool definedPort(int IdPort) const;
 
   // Retorna true se IdPort eh uma porta existente (definedPort) e
@@ -129,8 +298,15 @@ public:
   // - todas as portas validas (usa validPort)
   // - todas as saidas com Id de origem validas (usa getIdOutput e validIdOrig)
   // Essa funcao deve ser usada antes de salvar ou simular um circuito
+  // Se o circuito estiver marcado como validado (isValidado), retorna true sem conferir
+  // Para obter a lista de todos os problemas de um circuito, ver ValidadorCircuito
   bool valid() const;
 
+  // Retorna true se o circuito estah marcado como validado: foi conferido sem erros
+  // (por ler, digitar, getCompilado ou ValidadorCircuito::validar) e nao foi
+  // alterado depois
+  bool isValidado() const;
+
   /// ***********************
   /// Funcoes de consulta
   /// ***********************
@@ -140,7 +316,7 @@ public:
   // Retorna o numero de entradas Nin
   int getNumInputs() const;
   // Retorna o tamanho (size) dos vetores correspondentes:
-  // id_out e ports, respectivamente
+  // id_out e portas->tipo, respectivamente
   int getNumOutputs() const;
   int getNumPorts() const;
 
@@ -154,28 +330,90 @@ public:
   // Retorna o valor logico atual da saida cuja id eh IdOutput
   // Depois de testar o parametro (validIdOutput), retorna out_circ[IdOutput-1]
   // ou bool3S::UNDEF se parametro invalido
+  // Na simulacao sob demanda, avalia (uma unica vez por simulacao) o cone de entrada
+  // da saida; as consultas (getOutput, getOutputPort e getSinais) podem ser feitas
+  // por varias threads ao mesmo tempo, e sao serializadas enquanto ha avaliacao
+  // pendente
   bool3S getOutput(int IdOutput) const;
 
   // Caracteristicas das portas
 
+  // Retorna o valor logico da saida da porta cuja id eh IdPort, calculado na ultima
+  // simulacao (simular), ou bool3S::UNDEF se parametro invalido ou nao simulado
+  bool3S getOutputPort(int IdPort) const;
+
+  // Retorna os valores de todos os sinais calculados na ultima simulacao
+  // (getNumInputs() entradas seguidas de getNumPorts() portas, indexados por
+  // CircuitoCompilado::indiceSinal), ou nullptr se o circuito nao foi simulado
+  // depois da ultima alteracao. Na simulacao sob demanda, avalia antes todas as
+  // portas ainda nao avaliadas
+  const bool3S* getSinais() const;
+
+  // O fan-out (os consumidores) de um sinal, consultado pelo indice de fan-out
+  // mantido pelo circuito em O(numero de consumidores), sem percorrer as portas
+
+  // Retorna o numero de consumidores do sinal IdOrig (entrada do circuito ou porta):
+  // um para cada entrada de porta e para cada saida do circuito ligada a ele
+  // ou 0 se parametro invalido. Um sinal sem consumidores eh uma porta morta
+  int getNumFanout(int IdOrig) const;
+  // Retorna o K-esimo consumidor (K de 0 a getNumFanout-1, em ordem qualquer) do
+  // sinal IdOrig: a id da porta (>0) ou, se for uma saida do circuito, -IdOutput (<0)
+  // Uma porta com varias entradas ligadas ao sinal aparece uma vez para cada entrada
+  // Retorna 0 se parametro invalido
+  int getFanout(int IdOrig, int K) const;
+
+  // Retorna o codigo do tipo (RegistroPortas) da porta cuja id eh IdPort,
+  // ou CODIGO_INVALIDO se parametro invalido ou se a porta for uma instancia (SB)
+  CodigoPorta getCodigoPort(int IdPort) const;
+
+  // Retorna o atraso (em passos de tempo) das portas do tipo Tipo (NT, AN, etc.)
+  // ou ATRASO_PADRAO, caso nao tenha sido definido
+  int getAtraso(const std::string& Tipo) const;
+
   // Retorna o nome da porta: AN, NX, etc
   // Depois de testar se a porta existe (definedPort),
-  // retorna ports[IdPort-1]->getName()
+  // retorna o nome do tipo (RegistroPortas) ou "SB NOME:Saida", se for uma instancia
   // ou "??" se parametro invalido
   std::string getNamePort(int IdPort) const;
+  // Retorna a sigla do tipo da porta (AN, NX, SB, etc.) em uma string estatica
+  // (RegistroPortas::getSigla), sem alocar memoria, ou "??" se parametro invalido
+  const char* getSiglaPort(int IdPort) const;
 
   // Retorna o numero de entradas da porta
   // Depois de testar se a porta existe (definedPort),
-  // retorna ports[IdPort-1]->getNumInputs()
+  // retorna num_in[IdPort-1]
   // ou 0 se parametro invalido
   int getNumInputsPort(int IdPort) const;
 
   // Retorna a origem (a id) da I-esima entrada da porta cuja id eh IdPort
   // Depois de testar se a porta existe (definedPort) e o indice da entrada I,
-  // retorna ports[IdPort-1]->getId_in(I)
+  // retorna id_in[ini_in[IdPort-1]+I]
   // ou 0 se parametro invalido
   int getId_inPort(int IdPort, int I) const;
 
+  // Os modulos (subcircuitos)
+
+  // Retorna o numero de modulos definidos
+  int getNumModulos() const;
+  // Retorna o modulo de nome Nome, ou nullptr se nao existir
+  ptr_Modulo getModulo(const std::string& Nome) const;
+  // Retorna o modulo instanciado pela porta cuja id eh IdPort e, em Saida,
+  // a saida do modulo usada; ou nullptr se a porta nao for uma instancia (SB)
+  ptr_Modulo getModuloPort(int IdPort, int& Saida) const;
+  // Retorna true se alguma porta do circuito for uma instancia de modulo (SB)
+  bool temInstancias() const;
+
+  // Retorna um circuito equivalente, sem instancias de modulos: cada instancia
+  // eh substituida pelas portas do modulo (recursivamente). Instancias identicas (o
+  // mesmo modulo com as mesmas entradas) sao unificadas: compartilham as portas,
+  // inclusive os flip-flops, que ficam com um unico estado (SimulacaoSincrona depende
+  // disso para achatar modulos com flip-flops). As ligacoes e as saidas que vinham de
+  // uma porta SB passam a vir direto da saida escolhida do modulo, sem atraso extra
+  // na simulacao temporizada; a porta SB original mantem a sua id (para consulta),
+  // como uma AN com as duas entradas iguais a essa saida e sem nenhum consumidor
+  // Retorna um circuito vazio se o circuito nao for valido
+  Circuito achatar() const;
+
   /// ***********************
   /// Funcoes de modificacao
   /// ***********************
@@ -189,17 +427,39 @@ public:
 
   // Caracteristicas das ports
 
-  // A porta cuja id eh IdPort passa a ser do tipo Tipo (NT, AN, etc.), com NIn entradas
+  // Fixa o atraso (em passos de tempo, >= 1) das portas do tipo Tipo (NT, AN, etc.)
+  // Depois de testar os parametros (tipo registrado, Atraso>=1), faz: atrasos[Tipo] <- Atraso
+  void setAtraso(const std::string& Tipo, int Atraso);
+
+  // A porta cuja id eh IdPort passa a ser do tipo Tipo (NT, AN, etc.; qualquer
+  // tipo registrado em RegistroPortas), com NIn entradas
   // Depois de varios testes (Id, tipo, num de entradas), faz:
-  // 1) Libera a antiga area de memoria: delete ports[IdPort-1]
-  // 2) Cria a nova porta: ports[IdPort-1] <- new ... (de acordo com tipo)
-  // 3) Fixa o numero de entrada: ports[IdPort-1]->setNumInputs(NIn)
-  void setPort(int IdPort, std::string Tipo, int NIn);
+  // 0) Deixa de compartilhar as portas com outras copias (detachPortas)
+  // 1) Fixa o tipo: tipo[IdPort-1] <- codigo do tipo
+  // 2) Reserva NIn entradas (com ids 0) em id_in, reaproveitando as antigas se o
+  //    numero de entradas nao mudar (Portas::definir)
+  void setPort(int IdPort, const std::string& Tipo, int NIn);
+  // O mesmo, com o codigo do tipo
+  void setPort(int IdPort, CodigoPorta Codigo, int NIn);
 
   // Altera a origem da I-esima entrada da porta cuja id eh IdPort, que passa a ser "IdOrig"
   // Depois de VARIOS testes (definedPort, validIndex, validIdOrig)
-  // faz: ports[IdPort-1]->setId_in(I,Idorig)
-  void setId_inPort(int IdPort, int I, int IdOrig) const;
+  // deixa de compartilhar as portas (detachPortas) e
+  // faz: id_in[ini_in[IdPort-1]+I] <- IdOrig
+  // Nao eh const: altera o circuito (e pode duplicar as portas compartilhadas)
+  void setId_inPort(int IdPort, int I, int IdOrig);
+
+  // Os modulos (subcircuitos)
+
+  // Define o modulo Nome como uma copia do circuito C, que eh compilado neste momento
+  // Os modulos de C ainda nao definidos neste circuito sao definidos antes
+  // Retorna false se o nome for invalido ou jah usado por outro modulo, ou se C
+  // nao for valido
+  bool definirModulo(const std::string& Nome, const Circuito& C);
+
+  // A porta cuja id eh IdPort passa a ser uma instancia (SB) da saida Saida do modulo
+  // de nome Nome, com as entradas indefinidas (fixadas depois por setId_inPort)
+  void setPortModulo(int IdPort, const std::string& Nome, int Saida);
 
   /// ***********************
   /// E/S de dados
@@ -208,9 +468,11 @@ public:
   // Entrada dos dados de um circuito via teclado
   // O usuario digita o numero de entradas, saidas e portas
   // apos o que, se os valores estiverem corretos (>0), redimensiona o circuito
-  // Em seguida, para cada porta o usuario digita o tipo (NT,AN,NA,OR,NO,XO,NX) que eh conferido
-  // Apos criada dinamicamente (new) a porta do tipo correto, chama a
-  // funcao digitar na porta recem-criada. A porta digitada eh conferida (validPort).
+  // Em seguida, para cada porta o usuario digita o tipo (NT,AN,...: os tipos registrados)
+  // que eh conferido
+  // Apos criada (RegistroPortas::criar) uma porta provisoria do tipo correto, chama a
+  // funcao digitar nessa porta, cujas entradas sao copiadas para o circuito.
+  // A porta digitada eh conferida (validPort).
   // Em seguida, o usuario digita as ids de todas as saidas, que sao conferidas (validIdOrig).
   // Se o usuario digitar um dado invalido, o metodo deve pedir que ele digite novamente
   // Deve utilizar o metodo digitar da classe Port
@@ -218,24 +480,37 @@ public:
 
   // Entrada dos dados de um circuito via arquivo
   // Leh do arquivo o cabecalho com o numero de entradas, saidas e portas
-  // Em seguida, para cada porta leh e confere a id e o tipo (validType)
-  // Apos criada dinamicamente (allocPort) a porta do tipo correto, chama a
-  // funcao ler na porta recem-criada. O retorno da leitura da porta eh conferido
-  // bem como se a porta lida eh valida (validPort) para o circuito.
+  // Em seguida, para cada porta leh e confere a id e o tipo (RegistroPortas::getCodigo)
+  // Em seguida, leh o numero de entradas (conferido pelo tipo) e as ids de origem
+  // (conferidas com validIdOrig) diretamente para id_in, no formato de Port::ler
   // Em seguida, leh as ids de todas as saidas, que sao conferidas (validIdOrig)
+  // Antes do circuito, pode haver definicoes de modulos, cada uma no formato:
+  //   MODULO NOME
+  //   CIRCUITO ... (mesmo formato, incluindo PORTAS e SAIDAS)
+  //   FIM
+  // As portas podem instanciar um modulo jah definido: "SB NOME:Saida NIn: ids"
+  // Por fim, pode haver uma secao opcional ATRASOS, com uma linha por tipo de porta
+  // contendo o tipo e o atraso (ex: "AN 2"), usada pela simulacao temporizada
+  // O arquivo pode estar no formato comprimido (ver salvarComprimido), reconhecido
+  // pela marca no inicio do arquivo
   // Retorna true se deu tudo OK; false se deu erro.
-  // Deve utilizar o metodo ler da classe Port
   bool ler(const std::string& arq);
 
   // Saida dos dados de um circuito (em tela ou arquivo, a mesma funcao serve para os dois)
   // Imprime os cabecalhos e os dados do circuito, caso o circuito seja valido
-  // Deve utilizar os metodos de impressao da classe Port
+  // Os modulos sao impressos antes do circuito e a secao ATRASOS soh eh impressa
+  // se algum atraso tiver sido definido
+  // As portas sao impressas no formato de Port::imprimir, formatadas em blocos por
+  // EscritorCircuito (em paralelo, nos circuitos grandes)
   std::ostream& imprimir(std::ostream& O=std::cout) const;
 
   // Salvar circuito em arquivo, caso o circuito seja valido
-  // Abre a stream, chama o metodo imprimir e depois fecha a stream
+  // Abre a stream, escreve o circuito como em imprimir e depois fecha a stream
   // Retorna true se deu tudo OK; false se deu erro
   bool salvar(const std::string& arq) const;
+  // O mesmo, no formato comprimido em blocos (ver compressao.h), com os blocos
+  // comprimidos em NumThreads threads
+  bool salvarComprimido(const std::string& arq, int NumThreads=1) const;
 
   /// ***********************
   /// SIMULACAO (funcao principal do circuito)
@@ -248,8 +523,54 @@ public:
   // do circuito.
   // Depois de simular todas as portas do circuito, calcula as saidas do
   // circuito (out_circ <- ...)
+  // As portas sao simuladas pela versao compilada do circuito (CircuitoCompilado),
+  // que eh construida caso o circuito tenha sido alterado desde a ultima simulacao
   // Retorna true se a simulacao foi OK; false caso deh erro
+  // Na simulacao sob demanda, apenas guarda as entradas: as portas sao avaliadas
+  // pelas consultas (getOutput, getOutputPort e getSinais)
   bool simular(const std::vector<bool3S>& in_circ);
+  // O mesmo, com as entradas e as saidas compactadas (2 bits por valor)
+  // As entradas sao descompactadas direto no vetor de sinais, sem vetor intermediario
+  // out_compacto eh redimensionado para o numero de saidas; os valores das saidas
+  // tambem ficam disponiveis em getOutput
+  bool simular(const VetorCompacto3S& in_compacto, VetorCompacto3S& out_compacto);
+
+  // Ativa ou desativa a simulacao sob demanda (desativada por padrao). Com ela, simular
+  // soh guarda as entradas, e getOutput(k) avalia recursivamente apenas as portas do
+  // cone de entrada da saida k, guardando os valores avaliados ateh a proxima
+  // simulacao: consultar poucas saidas de um circuito grande custa apenas os seus
+  // cones. Um cone com realimentacao eh avaliado como em CircuitoCompilado::simular
+  // (repetidamente, a partir de ?), restrito as suas portas. Os resultados sao os
+  // mesmos da simulacao completa. A simulacao com entradas compactadas eh sempre
+  // completa. Ao desativar, as saidas pendentes sao avaliadas
+  void setSobDemanda(bool Ativa);
+  bool isSobDemanda() const;
+
+  // Pontos de restauracao (ver EstadoSimulacao)
+  // Guarda em E os valores de todos os sinais da ultima simulacao (compactados)
+  // Retorna false se o circuito nao foi simulado depois da ultima alteracao
+  bool salvarEstado(EstadoSimulacao& E) const;
+  // Restaura os valores dos sinais (e das saidas) guardados em E, como se o circuito
+  // tivesse acabado de ser simulado. As copias do circuito nao sao afetadas
+  // Retorna false se o circuito nao for valido ou se E tiver outro numero de sinais
+  bool restaurarEstado(const EstadoSimulacao& E);
+
+  // Simula 64 vetores de entrada em paralelo (um por pista de Lote3S), caso o
+  // circuito e a dimensao da entrada sejam validos (caso contrario retorna false)
+  // in_circ tem dimensao igual ao numero de entradas do circuito
+  // out_lote eh redimensionado para o numero de saidas e recebe os resultados
+  // Nao altera os valores das saidas do circuito (out_circ)
+  bool simularLote(const std::vector<Lote3S>& in_circ, std::vector<Lote3S>& out_lote);
+  // O mesmo, retornando tambem os valores de todos os sinais em sinais_lote
+  // (redimensionado para getNumInputs()+getNumPorts())
+  bool simularLote(const std::vector<Lote3S>& in_circ, std::vector<Lote3S>& out_lote,
+                   std::vector<Lote3S>& sinais_lote);
+
+  // Retorna a versao compilada do circuito (construindo-a, caso o circuito tenha
+  // sido alterado), ou nullptr se o circuito nao for valido
+  // O CircuitoCompilado retornado nao eh alterado depois, e pode ser usado
+  // simultaneamente por varias threads
+  std::shared_ptr<const CircuitoCompilado> getCompilado();
 
 };
 
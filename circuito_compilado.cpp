@@ -0,0 +1,332 @@
+#include <algorithm>
+#include "circuito_compilado.h"
+#include "circuito.h"
+#include "modulo.h"
+
+///
+/// CLASSE CIRCUITO COMPILADO
+///
+
+// Cria um circuito compilado vazio
+CircuitoCompilado::CircuitoCompilado():
+  Nin(0), instr(), idx_in(), idx_out(), ini_fo(), fo(), ordem(), aciclico(true), subs(), tam_pilha(0)
+{
+}
+
+// Limpa o circuito compilado
+void CircuitoCompilado::clear()
+{
+  Nin = 0;
+  instr.clear();
+  idx_in.clear();
+  idx_out.clear();
+  ini_fo.clear();
+  fo.clear();
+  ordem.clear();
+  aciclico = true;
+  subs.clear();
+  tam_pilha = 0;
+}
+
+// Compila o circuito C, escolhendo o kernel especializado de cada porta
+bool CircuitoCompilado::compilar(const Circuito& C)
+{
+  clear();
+  if (!C.valid()) return false;
+
+  Nin = C.getNumInputs();
+  instr.resize(C.getNumPorts());
+  for (int i=0; i<C.getNumPorts(); i++)
+  {
+    CodigoPorta codigo = CODIGO_INVALIDO;
+    int saida;
+    ptr_Modulo M = C.getModuloPort(i+1,saida);
+    instr.at(i).N = C.getNumInputsPort(i+1);
+    instr.at(i).ini = idx_in.size();
+    instr.at(i).sub = nullptr;
+    instr.at(i).saida_sub = 0;
+    if (M)
+    {
+      // Instancia de modulo: usa o circuito compilado compartilhado do modulo
+      std::shared_ptr<const CircuitoCompilado> P = M->getCompilado();
+      if (std::find(subs.begin(),subs.end(),P)==subs.end()) subs.push_back(P);
+      instr.at(i).sub = P.get();
+      instr.at(i).saida_sub = saida-1;
+      instr.at(i).kernel = nullptr;
+      instr.at(i).kernel_lote = nullptr;
+      tam_pilha = std::max(tam_pilha, size_t(P->getNumInputs()+P->getNumSinais()+
+                                             P->getNumOutputs())+P->tam_pilha);
+    }
+    else
+    {
+      codigo = C.getCodigoPort(i+1);
+      instr.at(i).kernel = RegistroPortas::getKernel(codigo,instr.at(i).N);
+      instr.at(i).kernel_lote = RegistroPortas::getKernelLote(codigo,instr.at(i).N);
+      if (instr.at(i).kernel==nullptr || instr.at(i).kernel_lote==nullptr)
+      {
+        clear();
+        return false;
+      }
+    }
+    instr.at(i).codigo = codigo;
+    for (int j=0; j<instr.at(i).N; j++)
+    {
+      idx_in.push_back(indiceSinal(C.getId_inPort(i+1,j)));
+    }
+  }
+
+  idx_out.resize(C.getNumOutputs());
+  for (int j=0; j<C.getNumOutputs(); j++)
+  {
+    idx_out.at(j) = indiceSinal(C.getIdOutput(j+1));
+  }
+  calcularFanout();
+  ordenar();
+  return true;
+}
+
+// Calcula o fan-out dos sinais (contagem seguida de preenchimento)
+void CircuitoCompilado::calcularFanout()
+{
+  const int NP = getNumPorts();
+  const int NS = getNumSinais();
+
+  ini_fo.assign(NS+1,0);
+  for (int s : idx_in) ini_fo[s+1]++;
+  for (int s=0; s<NS; s++) ini_fo[s+1] += ini_fo[s];
+  fo.resize(ini_fo[NS]);
+  std::vector<int> pos(ini_fo.begin(),ini_fo.end()-1);
+  for (int i=0; i<NP; i++)
+  {
+    for (int j=0; j<instr[i].N; j++) fo[pos[idx_in[instr[i].ini+j]]++] = i;
+  }
+}
+
+// Calcula a ordem de simulacao das portas (algoritmo de Kahn sobre as ligacoes
+// entre portas). As portas que dependem de uma realimentacao nunca ficam prontas:
+// sao acrescentadas ao final, em ordem de id
+void CircuitoCompilado::ordenar()
+{
+  const int NP = getNumPorts();
+  std::vector<int> pendentes(NP,0);   // entradas vindas de portas ainda nao ordenadas
+
+  for (int i=0; i<NP; i++)
+  {
+    for (int j=0; j<instr[i].N; j++)
+    {
+      if (idx_in[instr[i].ini+j]>=Nin) pendentes[i]++;
+    }
+  }
+
+  ordem.clear();
+  ordem.reserve(NP);
+  for (int i=0; i<NP; i++) if (pendentes[i]==0) ordem.push_back(i);
+  for (size_t k=0; k<ordem.size(); k++)
+  {
+    int s = Nin+ordem[k];
+    for (int f=ini_fo[s]; f<ini_fo[s+1]; f++)
+    {
+      if (--pendentes[fo[f]]==0) ordem.push_back(fo[f]);
+    }
+  }
+  aciclico = (int(ordem.size())==NP);
+  if (!aciclico)
+  {
+    for (int i=0; i<NP; i++) if (pendentes[i]>0) ordem.push_back(i);
+  }
+}
+
+// Retorna o indice no vetor de sinais correspondente a uma IdOrig
+int CircuitoCompilado::indiceSinal(int IdOrig) const
+{
+  if (IdOrig<0) return -IdOrig-1;
+  return Nin+IdOrig-1;
+}
+
+// Caracteristicas do circuito compilado
+int CircuitoCompilado::getNumInputs() const
+{
+  return Nin;
+}
+
+int CircuitoCompilado::getNumOutputs() const
+{
+  return idx_out.size();
+}
+
+int CircuitoCompilado::getNumPorts() const
+{
+  return instr.size();
+}
+
+int CircuitoCompilado::getNumSinais() const
+{
+  return Nin+getNumPorts();
+}
+
+// Retorna true se alguma porta for uma instancia de modulo (SB)
+bool CircuitoCompilado::isHierarquico() const
+{
+  return !subs.empty();
+}
+
+// Caracteristicas das portas (IP: indice da porta, de 0 a Nports-1)
+CodigoPorta CircuitoCompilado::getCodigoPorta(int IP) const
+{
+  return instr.at(IP).codigo;
+}
+
+int CircuitoCompilado::getNumInputsPorta(int IP) const
+{
+  return instr.at(IP).N;
+}
+
+int CircuitoCompilado::getIndiceEntrada(int IP, int I) const
+{
+  return idx_in.at(instr.at(IP).ini+I);
+}
+
+int CircuitoCompilado::getIndiceSaida(int IO) const
+{
+  return idx_out.at(IO);
+}
+
+int CircuitoCompilado::getNumFanout(int S) const
+{
+  return ini_fo.at(S+1)-ini_fo.at(S);
+}
+
+const int* CircuitoCompilado::getFanout(int S) const
+{
+  return fo.data()+ini_fo.at(S);
+}
+
+const std::vector<int>& CircuitoCompilado::getOrdem() const
+{
+  return ordem;
+}
+
+bool CircuitoCompilado::isAciclico() const
+{
+  return aciclico;
+}
+
+// Simula um circuito compilado com valores do tipo bool3S ou Lote3S
+static inline void simularValores(const CircuitoCompilado& P, const bool3S* in_circ,
+                                  bool3S* sinais, bool3S* out_circ)
+{
+  P.simular(in_circ, sinais, out_circ);
+}
+
+static inline void simularValores(const CircuitoCompilado& P, const Lote3S* in_circ,
+                                  Lote3S* sinais, Lote3S* out_circ)
+{
+  P.simularLote(in_circ, sinais, out_circ);
+}
+
+// Simula a porta SB da instrucao I
+// Os vetores de trabalho do modulo (entradas, sinais e saidas) ficam em uma pilha
+// por thread, dimensionada na instancia mais externa (tam_pilha inclui as
+// instancias internas): nao ha alocacao durante a simulacao
+template<class V>
+V CircuitoCompilado::simularSub(const Instrucao& I, const V* sinais) const
+{
+  thread_local std::vector<V> pilha;
+  thread_local size_t topo = 0;
+
+  const CircuitoCompilado& P(*I.sub);
+  const size_t NS = P.getNumSinais();
+  const size_t tam = P.Nin+NS+P.getNumOutputs();
+  if (topo==0 && pilha.size()<tam+P.tam_pilha) pilha.resize(tam+P.tam_pilha);
+
+  V* in_sub = pilha.data()+topo;
+  const int* idx = idx_in.data()+I.ini;
+  for (int j=0; j<I.N; j++) in_sub[j] = sinais[idx[j]];
+  topo += tam;
+  simularValores(P, in_sub, in_sub+P.Nin, in_sub+P.Nin+NS);
+  topo -= tam;
+  return in_sub[P.Nin+NS+I.saida_sub];
+}
+
+inline bool3S CircuitoCompilado::avaliar(const Instrucao& I, const bool3S* sinais) const
+{
+  if (I.kernel) return I.kernel(sinais, idx_in.data()+I.ini, I.N);
+  return simularSub(I, sinais);
+}
+
+inline Lote3S CircuitoCompilado::avaliar(const Instrucao& I, const Lote3S* sinais) const
+{
+  if (I.kernel_lote) return I.kernel_lote(sinais, idx_in.data()+I.ini, I.N);
+  return simularSub(I, sinais);
+}
+
+// Simula o circuito compilado
+// Sem realimentacao, basta simular cada porta uma vez, em ordem topologica
+void CircuitoCompilado::simular(const bool3S* in_circ, bool3S* sinais, bool3S* out_circ) const
+{
+  const int NP = getNumPorts();
+  bool3S* out_port = sinais+Nin;
+  bool tudo_def, alguma_def;
+
+  for (int i=0; i<Nin; i++) sinais[i] = in_circ[i];
+  for (int i=0; i<NP; i++) out_port[i] = bool3S::UNDEF;
+
+  if (aciclico)
+  {
+    for (int i : ordem)
+    {
+      out_port[i] = avaliar(instr[i], sinais);
+    }
+  }
+  else do
+  {
+    tudo_def = true;
+    alguma_def = false;
+    for (int i : ordem)
+    {
+      if (out_port[i]==bool3S::UNDEF)
+      {
+        out_port[i] = avaliar(instr[i], sinais);
+        if (out_port[i]==bool3S::UNDEF) tudo_def = false;
+        else alguma_def = true;
+      }
+    }
+  }
+  while (!tudo_def && alguma_def);
+
+  for (int j=0; j<getNumOutputs(); j++) out_circ[j] = sinais[idx_out[j]];
+}
+
+// Retorna a saida da porta de indice IP para os valores atuais dos sinais
+bool3S CircuitoCompilado::simularPorta(int IP, const bool3S* sinais) const
+{
+  return avaliar(instr[IP], sinais);
+}
+
+// Simula 64 vetores de entrada em paralelo
+// Como os operadores de bool3S sao monotonicos (uma saida definida nunca muda quando
+// uma entrada indefinida se torna definida), repetir a simulacao ate nenhuma pista
+// mudar leva ao mesmo resultado que o metodo simular em cada pista
+void CircuitoCompilado::simularLote(const Lote3S* in_circ, Lote3S* sinais, Lote3S* out_circ) const
+{
+  const int NP = getNumPorts();
+  Lote3S* out_port = sinais+Nin;
+  uint64_t mudou;
+
+  for (int i=0; i<Nin; i++) sinais[i] = in_circ[i];
+  for (int i=0; i<NP; i++) out_port[i] = lote3S(bool3S::UNDEF);
+
+  do
+  {
+    mudou = 0;
+    for (int i : ordem)
+    {
+      Lote3S prov = avaliar(instr[i], sinais);
+      mudou |= diferenca(prov, out_port[i]);
+      out_port[i] = prov;
+    }
+  }
+  while (!aciclico && mudou!=0);
+
+  for (int j=0; j<getNumOutputs(); j++) out_circ[j] = sinais[idx_out[j]];
+}
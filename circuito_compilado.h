@@ -0,0 +1,142 @@
+#ifndef _CIRCUITO_COMPILADO_H_
+#define _CIRCUITO_COMPILADO_H_
+
+#include <vector>
+#include <memory>
+#include "bool3S.h"
+#include "kernels.h"
+#include "lote3S.h"
+#include "registro_portas.h"
+
+class Circuito;
+
+///
+/// CLASSE CIRCUITO COMPILADO
+///
+/// Representacao de um circuito valido pronta para simulacao, construida uma
+/// unica vez a partir de um Circuito (compilar):
+/// - todos os sinais (entradas do circuito e saidas das portas) ficam em um unico
+///   vetor de bool3S, indexado por indiceSinal (entradas de 0 a Nin-1,
+///   portas de Nin a Nin+Nports-1);
+/// - cada porta vira uma instrucao com o kernel especializado para o seu tipo e
+///   numero de entradas (selecionarKernel) e os indices das suas entradas,
+///   armazenados de forma contigua para todas as portas (os kernels vem do
+///   registro de tipos, RegistroPortas);
+/// - as portas sao simuladas em ordem topologica (quando o circuito nao tem
+///   realimentacao, basta simular cada porta uma unica vez).
+/// Assim, a simulacao nao precisa de chamadas virtuais nem de vetores temporarios.
+/// As instancias de modulos (portas SB) nao sao expandidas: a instrucao aponta para
+/// o circuito compilado do modulo, compartilhado por todas as instancias, que eh
+/// simulado usando uma pilha de vetores de trabalho por thread.
+/// O mesmo circuito compilado pode simular um vetor de entradas (bool3S) ou
+/// 64 vetores em paralelo (Lote3S).
+///
+
+class CircuitoCompilado {
+private:
+  // Uma instrucao de simulacao (uma porta do circuito)
+  struct Instrucao {
+    KernelPorta kernel;      // O kernel especializado da porta
+    KernelLote kernel_lote;  // O kernel para 64 vetores em paralelo
+    int ini;                 // Posicao da primeira entrada da porta em idx_in
+    int N;                   // Numero de entradas da porta
+    CodigoPorta codigo;      // O tipo da porta (CODIGO_INVALIDO nas portas SB)
+    const CircuitoCompilado* sub;  // O modulo instanciado (porta SB), ou nullptr
+    int saida_sub;           // A saida do modulo usada pela porta SB (0 a Nout-1)
+  };
+
+  // Numero de entradas do circuito
+  int Nin;
+  // As instrucoes, uma por porta, na ordem das ids das portas
+  std::vector<Instrucao> instr;
+  // Os indices (em sinais) das entradas de todas as portas, em sequencia
+  std::vector<int> idx_in;
+  // Os indices (em sinais) das origens das saidas do circuito
+  std::vector<int> idx_out;
+  // O fan-out de cada sinal (indices das portas que o usam como entrada), em formato
+  // CSR: as portas que usam o sinal s sao fo[ini_fo[s]] ate fo[ini_fo[s+1]-1]
+  std::vector<int> ini_fo;
+  std::vector<int> fo;
+  // A ordem de simulacao das portas (indices em instr): ordem topologica das portas
+  // que nao dependem de realimentacao, seguida das demais em ordem de id
+  std::vector<int> ordem;
+  // true se o circuito nao tem realimentacao (todas as portas em ordem topologica)
+  bool aciclico;
+  // Os circuitos compilados dos modulos instanciados (mantidos vivos enquanto
+  // as instrucoes apontarem para eles)
+  std::vector<std::shared_ptr<const CircuitoCompilado>> subs;
+  // O numero de valores de trabalho necessarios para simular as instancias de
+  // modulos (o maior entre as instancias, incluindo as instancias internas)
+  size_t tam_pilha;
+
+  // Simula a porta SB da instrucao I (V: bool3S ou Lote3S)
+  template<class V>
+  V simularSub(const Instrucao& I, const V* sinais) const;
+  // Calcula a saida da instrucao I: pelo kernel ou, se for uma porta SB, pelo modulo
+  inline bool3S avaliar(const Instrucao& I, const bool3S* sinais) const;
+  inline Lote3S avaliar(const Instrucao& I, const Lote3S* sinais) const;
+
+  // Calcula o fan-out dos sinais
+  void calcularFanout();
+  // Calcula a ordem de simulacao das portas e o indicador aciclico
+  void ordenar();
+
+public:
+  // Cria um circuito compilado vazio
+  CircuitoCompilado();
+
+  // Compila o circuito C. Retorna false (e fica vazio) se C nao for valido
+  // ou tiver alguma porta de tipo desconhecido
+  bool compilar(const Circuito& C);
+
+  // Limpa o circuito compilado
+  void clear();
+
+  // Retorna o indice no vetor de sinais correspondente a uma IdOrig
+  // (entrada: -1 a -Nin; porta: 1 a Nports)
+  int indiceSinal(int IdOrig) const;
+
+  // Caracteristicas do circuito compilado
+  int getNumInputs() const;
+  int getNumOutputs() const;
+  int getNumPorts() const;
+  // Dimensao do vetor de sinais (Nin + Nports)
+  int getNumSinais() const;
+
+  // Retorna true se alguma porta for uma instancia de modulo (SB)
+  bool isHierarquico() const;
+
+  // Caracteristicas das portas (IP: indice da porta, de 0 a Nports-1)
+  // O tipo da porta (CODIGO_INVALIDO nas portas SB)
+  CodigoPorta getCodigoPorta(int IP) const;
+  int getNumInputsPorta(int IP) const;
+  // O indice (em sinais) da I-esima entrada da porta
+  int getIndiceEntrada(int IP, int I) const;
+  // O indice (em sinais) da origem da saida do circuito de indice IO (0 a Nout-1)
+  int getIndiceSaida(int IO) const;
+  // O fan-out do sinal de indice S: as getNumFanout(S) portas a partir de getFanout(S)
+  int getNumFanout(int S) const;
+  const int* getFanout(int S) const;
+  // A ordem de simulacao das portas e se o circuito nao tem realimentacao
+  const std::vector<int>& getOrdem() const;
+  bool isAciclico() const;
+
+  // Simula o circuito
+  // in_circ: os valores das Nin entradas do circuito
+  // sinais: vetor com getNumSinais() elementos, que recebe os valores de todos os sinais
+  // out_circ: vetor com getNumOutputs() elementos, que recebe os valores das saidas
+  // Assim como Circuito::simular, as portas sao simuladas repetidamente enquanto
+  // alguma porta com saida indefinida passar a ter saida definida
+  void simular(const bool3S* in_circ, bool3S* sinais, bool3S* out_circ) const;
+
+  // Retorna a saida da porta de indice IP para os valores atuais dos sinais,
+  // sem alterar o vetor de sinais
+  bool3S simularPorta(int IP, const bool3S* sinais) const;
+
+  // Simula 64 vetores de entrada em paralelo (um por pista do Lote3S)
+  // Os parametros sao os mesmos de simular, com Lote3S no lugar de bool3S
+  // As portas sao simuladas repetidamente enquanto alguma saida mudar
+  void simularLote(const Lote3S* in_circ, Lote3S* sinais, Lote3S* out_circ) const;
+};
+
+#endif // _CIRCUITO_COMPILADO_H_
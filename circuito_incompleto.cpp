@@ -1,44 +1,13 @@
 #include <fstream>
+#include <cstdlib>
 #include <utility> // para std::swap
+#include <functional>
+#include <algorithm>
 #include "circuito.h"
-
-///
-/// As strings que definem os tipos de porta
-///
-
-// Funcao auxiliar que testa se uma string com nome de porta eh valida
-// Caso necessario, converte os caracteres da string para maiusculas
-bool validType(std::string& Tipo)
-{
-  if (Tipo.size()!=2) return false;
-  Tipo.at(0) = toupper(Tipo.at(0));
-  Tipo.at(1) = toupper(Tipo.at(1));
-  if (Tipo=="NT" ||
-      Tipo=="AN" || Tipo=="NA" ||
-      Tipo=="OR" || Tipo=="NO" ||
-      Tipo=="XO" || Tipo=="NX") return true;
-  return false;
-}
-
-// Funcao auxiliar que retorna um ponteiro que aponta para uma porta alocada dinamicamente
-// O tipo da porta alocada depende do parametro string de entrada (AN, OR, etc.)
-// Caso o tipo nao seja nenhum dos validos, retorna nullptr
-// Pode ser utilizada nas funcoes: Circuito::setPort, Circuito::digitar e Circuito::ler
-ptr_Port allocPort(std::string& Tipo)
-{
-  if (!validType(Tipo)) return nullptr;
-
-  if (Tipo=="NT") return new Port_NOT;
-  if (Tipo=="AN") return new Port_AND;
-  if (Tipo=="NA") return new Port_NAND;
-  if (Tipo=="OR") return new Port_OR;
-  if (Tipo=="NO") return new Port_NOR;
-  if (Tipo=="XO") return new Port_XOR;
-  if (Tipo=="NX") return new Port_NXOR;
-
-  // Nunca deve chegar aqui...
-  return nullptr;
-}
+#include "modulo.h"
+#include "estado_simulacao.h"
+#include "compressao.h"
+#include "escritor.h"
 
 ///
 /// CLASSE CIRCUITO
@@ -48,19 +17,319 @@ ptr_Port allocPort(std::string& Tipo)
 /// Inicializacao e finalizacao
 /// ***********************
 
-Circuito::Circuito():
-    Nin(), id_out(nullptr), out_circ(nullptr), ports(nullptr)
+// NP portas nao definidas
+Circuito::Portas::Portas(int NP):
+  tipo(NP,CODIGO_INVALIDO), ini_in(NP,0), num_in(NP,0), id_in(), lixo(0), instancias()
+{
+}
+
+// A porta de indice i passa a ser do tipo Codigo, com N entradas (ids 0)
+// Se o numero de entradas nao mudar, ou se as entradas da porta forem as ultimas de
+// id_in, as entradas sao alteradas no lugar; senao, passam para o fim de id_in
+int Circuito::Portas::definir(int i, CodigoPorta Codigo, int N)
+{
+  tipo[i] = Codigo;
+  if (!instancias.empty()) instancias.erase(i);
+  if (N!=num_in[i])
+  {
+    if (size_t(ini_in[i]+num_in[i])==id_in.size()) id_in.resize(ini_in[i]);
+    else
+    {
+      lixo += num_in[i];
+      ini_in[i] = id_in.size();
+    }
+    num_in[i] = N;
+    id_in.resize(ini_in[i]+N,0);
+    // O lixo nunca passa da metade de id_in
+    if (2*lixo>id_in.size()) compactar();
+  }
+  else std::fill(id_in.begin()+ini_in[i],id_in.begin()+ini_in[i]+N,0);
+  return ini_in[i];
+}
+
+// Recoloca as entradas na ordem das portas, eliminando o lixo
+void Circuito::Portas::compactar()
+{
+  std::vector<int> prov;
+  prov.reserve(id_in.size()-lixo);
+  for (size_t i=0; i<tipo.size(); i++)
+  {
+    const int ini = prov.size();
+    prov.insert(prov.end(),id_in.begin()+ini_in[i],id_in.begin()+ini_in[i]+num_in[i]);
+    ini_in[i] = ini;
+  }
+  id_in.swap(prov);
+  lixo = 0;
+}
+
+// Garante que as portas nao estao compartilhadas com nenhuma outra copia
+// do circuito, duplicando-as caso estejam
+void Circuito::detachPortas()
+{
+  if (!portas || portas.use_count()==1) return;
+  std::shared_ptr<Portas> prov = std::make_shared<Portas>(*portas);
+  if (prov->lixo>0) prov->compactar();
+  portas = std::move(prov);
+}
+
+// NS sinais sem consumidores
+Circuito::IndiceFanout::IndiceFanout(int NS):
+  ini(NS,0), num(NS,0), cap(NS,0), cons(), lixo(0)
+{
+}
+
+// Acrescenta Consumidor ao sinal de indice S
+// Se nao houver espaco livre, o sinal passa para o fim de cons (ou cresce no lugar,
+// se jah estiver no fim), com o dobro da capacidade
+void Circuito::IndiceFanout::incluir(int S, int Consumidor)
+{
+  if (num[S]==cap[S])
+  {
+    const int nova_cap = std::max(4,2*cap[S]);
+    if (size_t(ini[S]+cap[S])!=cons.size())
+    {
+      const int pos = cons.size();
+      lixo += cap[S];
+      cons.resize(pos+nova_cap,0);
+      std::copy(cons.begin()+ini[S],cons.begin()+ini[S]+num[S],cons.begin()+pos);
+      ini[S] = pos;
+    }
+    else cons.resize(ini[S]+nova_cap,0);
+    cap[S] = nova_cap;
+  }
+  cons[ini[S]+num[S]++] = Consumidor;
+  if (2*lixo>cons.size()) compactar();
+}
+
+// Remove uma ocorrencia de Consumidor do sinal de indice S
+// A ultima ocorrencia do sinal ocupa o lugar da removida: O(fan-out do sinal)
+void Circuito::IndiceFanout::excluir(int S, int Consumidor)
+{
+  int* c = cons.data()+ini[S];
+  for (int k=0; k<num[S]; k++)
+  {
+    if (c[k]==Consumidor)
+    {
+      c[k] = c[--num[S]];
+      return;
+    }
+  }
+}
+
+// Elimina o lixo e a folga, recolocando os sinais em ordem
+void Circuito::IndiceFanout::compactar()
 {
+  std::vector<int> prov;
+  prov.reserve(cons.size()-lixo);
+  for (size_t s=0; s<ini.size(); s++)
+  {
+    const int pos = prov.size();
+    prov.insert(prov.end(),cons.begin()+ini[s],cons.begin()+ini[s]+num[s]);
+    ini[s] = pos;
+    cap[s] = num[s];
+  }
+  cons.swap(prov);
+  lixo = 0;
+}
 
+// Retorna o indice do sinal IdOrig no indice de fan-out, ou -1 se IdOrig for invalida
+int Circuito::indiceFanout(int IdOrig) const
+{
+  if (!validIdOrig(IdOrig)) return -1;
+  return (IdOrig<0 ? -IdOrig-1 : Nin+IdOrig-1);
 }
 
+// Reconstroi o indice de fan-out a partir das portas e das saidas
+// Conta os consumidores de cada sinal e depois os distribui, na ordem das portas
+// seguida das saidas, sem folga
+void Circuito::construirFanout()
+{
+  if (!portas)
+  {
+    fanout.reset();
+    return;
+  }
+  std::shared_ptr<IndiceFanout> F = std::make_shared<IndiceFanout>(Nin+getNumPorts());
+  for (int i=0; i<getNumPorts(); i++)
+  {
+    const int* id = portas->id_in.data()+portas->ini_in[i];
+    for (int j=0; j<portas->num_in[i]; j++)
+    {
+      const int S = indiceFanout(id[j]);
+      if (S>=0) F->num[S]++;
+    }
+  }
+  for (int IdOrig : id_out)
+  {
+    const int S = indiceFanout(IdOrig);
+    if (S>=0) F->num[S]++;
+  }
+
+  int pos = 0;
+  for (size_t S=0; S<F->ini.size(); S++)
+  {
+    F->ini[S] = pos;
+    F->cap[S] = F->num[S];
+    pos += F->num[S];
+    F->num[S] = 0;
+  }
+  F->cons.resize(pos);
+
+  for (int i=0; i<getNumPorts(); i++)
+  {
+    const int* id = portas->id_in.data()+portas->ini_in[i];
+    for (int j=0; j<portas->num_in[i]; j++)
+    {
+      const int S = indiceFanout(id[j]);
+      if (S>=0) F->cons[F->ini[S]+F->num[S]++] = i+1;
+    }
+  }
+  for (int j=0; j<getNumOutputs(); j++)
+  {
+    const int S = indiceFanout(id_out[j]);
+    if (S>=0) F->cons[F->ini[S]+F->num[S]++] = -(j+1);
+  }
+  fanout = std::move(F);
+}
+
+// Garante que o indice de fan-out nao estah compartilhado com nenhuma outra copia
+void Circuito::detachFanout()
+{
+  if (!fanout || fanout.use_count()==1) return;
+  std::shared_ptr<IndiceFanout> prov = std::make_shared<IndiceFanout>(*fanout);
+  if (prov->lixo>0) prov->compactar();
+  fanout = std::move(prov);
+}
+
+// Retira do fan-out das suas origens as entradas da porta de indice i
+void Circuito::desligarEntradas(int i)
+{
+  if (portas->num_in[i]==0) return;
+  detachFanout();
+  const int* id = portas->id_in.data()+portas->ini_in[i];
+  for (int j=0; j<portas->num_in[i]; j++)
+  {
+    const int S = indiceFanout(id[j]);
+    if (S>=0) fanout->excluir(S,i+1);
+  }
+}
+
+Circuito::Circuito():
+  Nin(0), id_out(), out_circ(), portas(), fanout(), programa(), sinais(), sob_demanda(false),
+  demanda_pendente(false), demanda(), mtx_demanda(), atrasos(), modulos(), validado(false)
+{
+}
+
+// Construtor por copia: as portas, os sinais e o estado da simulacao sob demanda
+// passam a ser compartilhados com C
 Circuito::Circuito(const Circuito& C):
-    Nin(), id_out(nullptr), out_circ(nullptr), ports(nullptr)
+  Nin(C.Nin), id_out(C.id_out), out_circ(C.out_circ), portas(C.portas), fanout(C.fanout),
+  programa(C.programa), sinais(), sob_demanda(C.sob_demanda),
+  demanda_pendente(C.demanda_pendente), demanda(), mtx_demanda(),
+  atrasos(C.atrasos), modulos(C.modulos), validado(C.validado)
+{
+  // Uma consulta sob demanda a C (em outra thread) pode estar separando os vetores
+  std::lock_guard<std::mutex> lock(C.mtx_demanda);
+  sinais = C.sinais;
+  demanda = C.demanda;
+}
+
+// Construtor por movimento: nenhuma alocacao, C fica zerado
+Circuito::Circuito(Circuito&& C) noexcept:
+  Nin(C.Nin), id_out(std::move(C.id_out)), out_circ(std::move(C.out_circ)),
+  portas(std::move(C.portas)), fanout(std::move(C.fanout)), programa(std::move(C.programa)), sinais(std::move(C.sinais)),
+  sob_demanda(C.sob_demanda), demanda_pendente(C.demanda_pendente),
+  demanda(std::move(C.demanda)), mtx_demanda(),
+  atrasos(std::move(C.atrasos)), modulos(std::move(C.modulos)), validado(C.validado)
+{
+  C.demanda_pendente = false;
+  C.Nin = 0;
+  C.validado = false;
+}
+
+// Destrutor: apenas chama a funcao clear()
+Circuito::~Circuito()
 {
-    Nin = C.getNumInputs();
-    id_out = C.id_out;
-    out_circ = C.out_circ;
-    ports = C.ports;
+  clear();
+}
+
+// Limpa todo o conteudo do circuito
+// As portas soh sao liberadas se nenhuma outra copia as compartilhar
+void Circuito::clear()
+{
+  Nin = 0;
+  id_out.clear();
+  out_circ.clear();
+  portas.reset();
+  fanout.reset();
+  programa.reset();
+  sinais.reset();
+  // O modo de simulacao (sob_demanda) eh mantido
+  demanda_pendente = false;
+  demanda.reset();
+  atrasos.clear();
+  modulos.clear();
+  validado = false;
+}
+
+// Operador de atribuicao por copia
+void Circuito::operator=(const Circuito& C)
+{
+  if (this == &C) return;
+  Nin = C.Nin;
+  id_out = C.id_out;
+  out_circ = C.out_circ;
+  portas = C.portas;
+  fanout = C.fanout;
+  programa = C.programa;
+  sob_demanda = C.sob_demanda;
+  demanda_pendente = C.demanda_pendente;
+  {
+    std::lock_guard<std::mutex> lock(C.mtx_demanda);
+    sinais = C.sinais;
+    demanda = C.demanda;
+  }
+  atrasos = C.atrasos;
+  modulos = C.modulos;
+  validado = C.validado;
+}
+
+// Operador de atribuicao por movimento
+void Circuito::operator=(Circuito&& C) noexcept
+{
+  if (this == &C) return;
+  clear();
+  Nin = C.Nin;
+  id_out = std::move(C.id_out);
+  out_circ = std::move(C.out_circ);
+  portas = std::move(C.portas);
+  fanout = std::move(C.fanout);
+  programa = std::move(C.programa);
+  sinais = std::move(C.sinais);
+  sob_demanda = C.sob_demanda;
+  demanda_pendente = C.demanda_pendente;
+  demanda = std::move(C.demanda);
+  C.demanda_pendente = false;
+  atrasos = std::move(C.atrasos);
+  modulos = std::move(C.modulos);
+  validado = C.validado;
+  C.Nin = 0;
+  C.validado = false;
+}
+
+// Redimensiona o circuito para passar a ter NI entradas, NO saidas e NP ports
+// Os modulos sao mantidos
+void Circuito::resize(int NI, int NO, int NP)
+{
+  if (NI<=0 || NO<=0 || NP<=0) return;
+  std::vector<ptr_Modulo> prov(std::move(modulos));
+  clear();
+  modulos = std::move(prov);
+  Nin = NI;
+  id_out.resize(NO,0);
+  out_circ.resize(NO,bool3S::UNDEF);
+  portas = std::make_shared<Portas>(NP);
+  fanout = std::make_shared<IndiceFanout>(NI+NP);
 }
 
 /// ***********************
@@ -94,12 +363,11 @@ bool Circuito::validIdOrig(int IdOrig) const
 }
 
 // Retorna true se IdPort eh uma id de porta valida (validIdPort) e
-// a porta estah definida (estah alocada, ou seja, != nullptr)
+// a porta estah definida (tipo != CODIGO_INVALIDO)
 bool Circuito::definedPort(int IdPort) const
 {
   if (!validIdPort(IdPort)) return false;
-  if (ports.at(IdPort-1)==nullptr) return false;
-  return true;
+  return portas->tipo[IdPort-1]!=CODIGO_INVALIDO;
 }
 
 // Retorna true se IdPort eh uma porta existente (definedPort) e
@@ -107,9 +375,10 @@ bool Circuito::definedPort(int IdPort) const
 bool Circuito::validPort(int IdPort) const
 {
   if (!definedPort(IdPort)) return false;
-  for (int j=0; j<getNumInputsPort(IdPort); j++)
+  const int* id = portas->id_in.data()+portas->ini_in[IdPort-1];
+  for (int j=0; j<portas->num_in[IdPort-1]; j++)
   {
-    if (!validIdOrig(getId_inPort(IdPort,j))) return false;
+    if (!validIdOrig(id[j])) return false;
   }
   return true;
 }
@@ -119,42 +388,895 @@ bool Circuito::validPort(int IdPort) const
 // - todas as portas validas (usa validPort)
 // - todas as saidas com Id de origem validas (usa getIdOutput e validIdOrig)
 // Essa funcao deve ser usada antes de salvar ou simular um circuito
+// Percorre diretamente os vetores das portas, sem repetir os testes de validPort
 bool Circuito::valid() const
 {
+  if (validado) return true;
   if (getNumInputs()<=0) return false;
   if (getNumOutputs()<=0) return false;
   if (getNumPorts()<=0) return false;
   for (int i=0; i<getNumPorts(); i++)
   {
-    if (!validPort(i+1)) return false;
+    if (portas->tipo[i]==CODIGO_INVALIDO) return false;
+    const int* id = portas->id_in.data()+portas->ini_in[i];
+    for (int j=0; j<portas->num_in[i]; j++)
+    {
+      if (!validIdOrig(id[j])) return false;
+    }
   }
-  for (int i=0; i<getNumOutputs(); i++)
+  for (int IdOrig : id_out)
   {
-    if (!validIdOrig(getIdOutput(i+1))) return false;
+    if (!validIdOrig(IdOrig)) return false;
   }
   return true;
 }
 
+// Retorna true se o circuito estah marcado como validado
+bool Circuito::isValidado() const
+{
+  return validado;
+}
+
 /// ***********************
 /// Funcoes de consulta
 /// ***********************
 
-falta_fazer();
+// Retorna o numero de entradas Nin
+int Circuito::getNumInputs() const
+{
+  return Nin;
+}
+
+// Retorna o numero de saidas (tamanho do vetor id_out)
+int Circuito::getNumOutputs() const
+{
+  return id_out.size();
+}
+
+// Retorna o numero de portas (tamanho do vetor de tipos)
+int Circuito::getNumPorts() const
+{
+  if (!portas) return 0;
+  return portas->tipo.size();
+}
+
+// Retorna a origem (a id) do sinal de saida cuja id eh IdOutput
+// ou 0 se parametro invalido
+int Circuito::getIdOutput(int IdOutput) const
+{
+  if (!validIdOutput(IdOutput)) return 0;
+  return id_out.at(IdOutput-1);
+}
+
+// Retorna o valor logico atual da saida cuja id eh IdOutput
+// ou bool3S::UNDEF se parametro invalido
+bool3S Circuito::getOutput(int IdOutput) const
+{
+  if (!validIdOutput(IdOutput)) return bool3S::UNDEF;
+  if (demanda_pendente)
+  {
+    std::lock_guard<std::mutex> lock(mtx_demanda);
+    return avaliarSobDemanda(demanda->programa->getIndiceSaida(IdOutput-1));
+  }
+  return out_circ.at(IdOutput-1);
+}
+
+// Retorna o valor logico da saida da porta calculado na ultima simulacao
+// Na simulacao sob demanda, avalia apenas o cone de entrada da porta
+bool3S Circuito::getOutputPort(int IdPort) const
+{
+  if (!definedPort(IdPort)) return bool3S::UNDEF;
+  if (demanda_pendente)
+  {
+    std::lock_guard<std::mutex> lock(mtx_demanda);
+    if (programa==demanda->programa) return avaliarSobDemanda(getNumInputs()+IdPort-1);
+  }
+  if (getSinais()==nullptr) return bool3S::UNDEF;
+  return sinais->at(getNumInputs()+IdPort-1);
+}
+
+// Retorna os valores de todos os sinais calculados na ultima simulacao
+const bool3S* Circuito::getSinais() const
+{
+  if (!programa || !sinais || int(sinais->size())!=programa->getNumSinais()) return nullptr;
+  if (demanda_pendente)
+  {
+    std::lock_guard<std::mutex> lock(mtx_demanda);
+    if (programa!=demanda->programa) return nullptr;
+    for (int S=getNumInputs(); S<programa->getNumSinais(); S++) avaliarSobDemanda(S);
+  }
+  return sinais->data();
+}
+
+// Retorna o numero de consumidores do sinal IdOrig, ou 0 se parametro invalido
+int Circuito::getNumFanout(int IdOrig) const
+{
+  const int S = indiceFanout(IdOrig);
+  if (S<0 || !fanout) return 0;
+  return fanout->num[S];
+}
+
+// Retorna o K-esimo consumidor do sinal IdOrig: IdPort (>0) ou -IdOutput (<0)
+// ou 0 se parametro invalido
+int Circuito::getFanout(int IdOrig, int K) const
+{
+  const int S = indiceFanout(IdOrig);
+  if (S<0 || !fanout || K<0 || K>=fanout->num[S]) return 0;
+  return fanout->cons[fanout->ini[S]+K];
+}
+
+// Retorna o codigo do tipo da porta cuja id eh IdPort
+// ou CODIGO_INVALIDO se parametro invalido ou se a porta for uma instancia (SB)
+CodigoPorta Circuito::getCodigoPort(int IdPort) const
+{
+  if (!validIdPort(IdPort) || portas->tipo[IdPort-1]==CODIGO_INSTANCIA) return CODIGO_INVALIDO;
+  return portas->tipo[IdPort-1];
+}
+
+// Retorna o atraso das portas do tipo Tipo ou ATRASO_PADRAO, caso nao definido
+int Circuito::getAtraso(const std::string& Tipo) const
+{
+  CodigoPorta codigo = RegistroPortas::getCodigo(Tipo);
+  if (codigo==CODIGO_INVALIDO) return ATRASO_PADRAO;
+  std::map<std::string,int>::const_iterator it = atrasos.find(RegistroPortas::getTipo(codigo).nome);
+  if (it==atrasos.end()) return ATRASO_PADRAO;
+  return it->second;
+}
+
+// Retorna o nome da porta: AN, NX, etc
+// ou "??" se parametro invalido
+std::string Circuito::getNamePort(int IdPort) const
+{
+  if (!definedPort(IdPort)) return "??";
+  if (portas->tipo[IdPort-1]==CODIGO_INSTANCIA)
+  {
+    const std::pair<ptr_Modulo,int>& inst = portas->instancias.at(IdPort-1);
+    return "SB " + inst.first->getNome() + ":" + std::to_string(inst.second);
+  }
+  return RegistroPortas::getSigla(portas->tipo[IdPort-1]);
+}
+
+// Retorna a sigla do tipo da porta (SB para as instancias)
+// ou "??" se parametro invalido
+const char* Circuito::getSiglaPort(int IdPort) const
+{
+  if (!definedPort(IdPort)) return "??";
+  return RegistroPortas::getSigla(portas->tipo[IdPort-1]);
+}
+
+// Retorna o numero de entradas da porta
+// ou 0 se parametro invalido
+int Circuito::getNumInputsPort(int IdPort) const
+{
+  if (!definedPort(IdPort)) return 0;
+  return portas->num_in[IdPort-1];
+}
+
+// Retorna a origem (a id) da I-esima entrada da porta cuja id eh IdPort
+// ou 0 se parametro invalido
+int Circuito::getId_inPort(int IdPort, int I) const
+{
+  if (!definedPort(IdPort)) return 0;
+  if (I<0 || I>=portas->num_in[IdPort-1]) return 0;
+  return portas->id_in[portas->ini_in[IdPort-1]+I];
+}
+
+// Retorna o numero de modulos definidos
+int Circuito::getNumModulos() const
+{
+  return modulos.size();
+}
+
+// Retorna o modulo de nome Nome, ou nullptr se nao existir
+ptr_Modulo Circuito::getModulo(const std::string& Nome) const
+{
+  for (const ptr_Modulo& M : modulos)
+  {
+    if (M->getNome()==Nome) return M;
+  }
+  return nullptr;
+}
+
+// Retorna o modulo instanciado pela porta cuja id eh IdPort (e a saida usada)
+// ou nullptr se a porta nao for uma instancia (SB)
+ptr_Modulo Circuito::getModuloPort(int IdPort, int& Saida) const
+{
+  if (!validIdPort(IdPort) || portas->tipo[IdPort-1]!=CODIGO_INSTANCIA) return nullptr;
+  const std::pair<ptr_Modulo,int>& inst = portas->instancias.at(IdPort-1);
+  Saida = inst.second;
+  return inst.first;
+}
+
+// Retorna true se alguma porta do circuito for uma instancia de modulo (SB)
+bool Circuito::temInstancias() const
+{
+  return portas && !portas->instancias.empty();
+}
+
+// Retorna um circuito equivalente, sem instancias de modulos
+// As portas de cada instancia distinta (modulo + ids das entradas) sao acrescentadas
+// apos as portas do circuito, na ordem em que sao encontradas. As ligacoes que vinham
+// de uma porta SB passam a vir direto da saida do modulo, sem porta intermediaria
+Circuito Circuito::achatar() const
+{
+  if (!valid()) return Circuito();
+
+  // As portas do circuito achatado: tipo e ids de origem das entradas
+  const CodigoPorta codigo_AN = RegistroPortas::getCodigo("AN");
+  std::vector<CodigoPorta> tipo;
+  std::vector<std::vector<int>> id_in;
+  // A origem que cada porta SB repete (0 se a porta nao for uma instancia)
+  std::vector<int> repete;
+  // As ids (no circuito achatado) das saidas de cada instancia jah expandida
+  std::map<std::pair<const Modulo*,std::vector<int>>,std::vector<int>> instancias;
+
+  // Copia a porta IdPort do circuito C para a posicao Pos, com as ids de origem
+  // convertidas por mapa; as instancias sao expandidas (recursivamente)
+  std::function<void(const Circuito&,int,int,const std::function<int(int)>&)> copiarPorta;
+  // Expande a instancia do modulo M com entradas Ent, retornando as ids das saidas
+  std::function<const std::vector<int>&(const Modulo&,const std::vector<int>&)> expandir;
+
+  copiarPorta = [&](const Circuito& C, int IdPort, int Pos, const std::function<int(int)>& mapa)
+  {
+    std::vector<int> ent(C.getNumInputsPort(IdPort));
+    for (size_t j=0; j<ent.size(); j++) ent[j] = mapa(C.getId_inPort(IdPort,j));
+
+    int saida;
+    ptr_Modulo M = C.getModuloPort(IdPort,saida);
+    if (M)
+    {
+      const int orig = expandir(*M,ent).at(saida-1);
+      tipo[Pos] = codigo_AN;
+      id_in[Pos] = {orig, orig};
+      repete[Pos] = orig;
+    }
+    else
+    {
+      tipo[Pos] = C.getCodigoPort(IdPort);
+      id_in[Pos] = std::move(ent);
+    }
+  };
+
+  expandir = [&](const Modulo& M, const std::vector<int>& Ent) -> const std::vector<int>&
+  {
+    std::pair<const Modulo*,std::vector<int>> chave(&M,Ent);
+    auto it = instancias.find(chave);
+    if (it!=instancias.end()) return it->second;
+
+    const Circuito& C(M.getCircuito());
+    const int base = tipo.size();
+    const std::function<int(int)> mapa = [&](int IdOrig)
+    {
+      return (IdOrig<0 ? Ent.at(-IdOrig-1) : base+IdOrig);
+    };
+    tipo.resize(base+C.getNumPorts());
+    id_in.resize(base+C.getNumPorts());
+    repete.resize(base+C.getNumPorts(),0);
+    for (int i=0; i<C.getNumPorts(); i++) copiarPorta(C,i+1,base+i,mapa);
+
+    std::vector<int> saidas(C.getNumOutputs());
+    for (int j=0; j<C.getNumOutputs(); j++) saidas[j] = mapa(C.getIdOutput(j+1));
+    return instancias.emplace(std::move(chave),std::move(saidas)).first->second;
+  };
+
+  const std::function<int(int)> identidade = [](int IdOrig) {return IdOrig;};
+  tipo.resize(getNumPorts());
+  id_in.resize(getNumPorts());
+  repete.resize(getNumPorts(),0);
+  for (int i=0; i<getNumPorts(); i++) copiarPorta(*this,i+1,i,identidade);
+
+  // A origem real de uma id: segue as portas SB ateh uma que nao repita outra (um laco
+  // soh de portas SB, sem nenhuma porta logica, para depois de dar a volta)
+  const int NP = tipo.size();
+  const auto origem = [&repete, NP](int IdOrig)
+  {
+    for (int k=0; k<NP && IdOrig>0 && repete[IdOrig-1]!=0; k++) IdOrig = repete[IdOrig-1];
+    return IdOrig;
+  };
+  for (std::vector<int>& ent : id_in)
+  {
+    for (int& id : ent) id = origem(id);
+  }
+
+  Circuito R;
+  R.resize(getNumInputs(),getNumOutputs(),tipo.size());
+  for (size_t i=0; i<tipo.size(); i++)
+  {
+    const int pos = R.portas->definir(i,tipo[i],id_in[i].size());
+    std::copy(id_in[i].begin(),id_in[i].end(),R.portas->id_in.begin()+pos);
+  }
+  R.id_out = id_out;
+  for (int& id : R.id_out) id = origem(id);
+  R.construirFanout();
+  R.atrasos = atrasos;
+  R.validado = true;
+  return R;
+}
 
 /// ***********************
 /// Funcoes de modificacao
 /// ***********************
 
-falta_fazer();
+// Altera a origem da saida de id "IdOut", que passa a ser "IdOrig"
+void Circuito::setIdOutput(int IdOut, int IdOrig)
+{
+  if (!validIdOutput(IdOut) || !validIdOrig(IdOrig)) return;
+  detachFanout();
+  const int S = indiceFanout(id_out.at(IdOut-1));
+  if (S>=0) fanout->excluir(S,-IdOut);
+  fanout->incluir(indiceFanout(IdOrig),-IdOut);
+  id_out.at(IdOut-1) = IdOrig;
+  programa.reset();
+  validado = false;
+}
+
+// Fixa o atraso (em passos de tempo) das portas do tipo Tipo
+void Circuito::setAtraso(const std::string& Tipo, int Atraso)
+{
+  CodigoPorta codigo = RegistroPortas::getCodigo(Tipo);
+  if (codigo==CODIGO_INVALIDO || Atraso<1) return;
+  atrasos[RegistroPortas::getTipo(codigo).nome] = Atraso;
+}
+
+// A porta cuja id eh IdPort passa a ser do tipo Tipo (NT, AN, etc.), com NIn entradas
+// Somente a copia alterada deixa de compartilhar as portas (copy-on-write)
+void Circuito::setPort(int IdPort, const std::string& Tipo, int NIn)
+{
+  setPort(IdPort,RegistroPortas::getCodigo(Tipo),NIn);
+}
+
+void Circuito::setPort(int IdPort, CodigoPorta Codigo, int NIn)
+{
+  if (!validIdPort(IdPort)) return;
+  if (!RegistroPortas::validNumInputs(Codigo,NIn)) return;
+
+  desligarEntradas(IdPort-1);
+  detachPortas();
+  portas->definir(IdPort-1,Codigo,NIn);
+  programa.reset();
+  validado = false;
+}
+
+// Altera a origem da I-esima entrada da porta cuja id eh IdPort, que passa a ser "IdOrig"
+// Somente a copia alterada deixa de compartilhar as portas (copy-on-write)
+void Circuito::setId_inPort(int IdPort, int I, int IdOrig)
+{
+  if (!definedPort(IdPort)) return;
+  if (I<0 || I>=portas->num_in[IdPort-1]) return;
+  if (!validIdOrig(IdOrig)) return;
+
+  detachPortas();
+  int& id = portas->id_in[portas->ini_in[IdPort-1]+I];
+  detachFanout();
+  const int S = indiceFanout(id);
+  if (S>=0) fanout->excluir(S,IdPort);
+  fanout->incluir(indiceFanout(IdOrig),IdPort);
+  id = IdOrig;
+  programa.reset();
+  validado = false;
+}
+
+// Define o modulo Nome como uma copia do circuito C
+bool Circuito::definirModulo(const std::string& Nome, const Circuito& C)
+{
+  if (!Modulo::validNome(Nome) || getModulo(Nome)) return false;
+  if (!C.valid()) return false;
+
+  // Os modulos instanciados por C devem estar definidos antes
+  for (const ptr_Modulo& M : C.modulos)
+  {
+    ptr_Modulo prov = getModulo(M->getNome());
+    if (!prov) modulos.push_back(M);
+    else if (prov!=M) return false;
+  }
+
+  ptr_Modulo M = std::make_shared<const Modulo>(Nome,C);
+  if (!M->valid()) return false;
+  modulos.push_back(M);
+  return true;
+}
+
+// A porta cuja id eh IdPort passa a ser uma instancia (SB) de uma saida de um modulo
+void Circuito::setPortModulo(int IdPort, const std::string& Nome, int Saida)
+{
+  if (!validIdPort(IdPort)) return;
+  ptr_Modulo M = getModulo(Nome);
+  if (!M || Saida<1 || Saida>M->getNumOutputs()) return;
+
+  desligarEntradas(IdPort-1);
+  detachPortas();
+  portas->definir(IdPort-1,CODIGO_INSTANCIA,M->getNumInputs());
+  portas->instancias[IdPort-1] = std::make_pair(M,Saida);
+  programa.reset();
+  validado = false;
+}
 
 /// ***********************
 /// E/S de dados
 /// ***********************
 
-falta_fazer();
+// Entrada dos dados de um circuito via teclado
+void Circuito::digitar()
+{
+  int NI, NO, NP;
+
+  do
+  {
+    std::cout << "Numero de entradas do circuito: ";
+    std::cin >> NI;
+    std::cout << "Numero de saidas do circuito: ";
+    std::cin >> NO;
+    std::cout << "Numero de portas do circuito: ";
+    std::cin >> NP;
+  }
+  while (NI<=0 || NO<=0 || NP<=0);
+  resize(NI,NO,NP);
+
+  for (int i=0; i<getNumPorts(); i++)
+  {
+    std::cout << "Porta " << i+1 << ":\n";
+    do
+    {
+      std::string Tipo;
+      CodigoPorta codigo;
+      do
+      {
+        std::cout << "  Tipo da porta (" << RegistroPortas::getNomes() << "): ";
+        std::cin >> Tipo;
+        codigo = RegistroPortas::getCodigo(Tipo);
+      }
+      while (codigo==CODIGO_INVALIDO);
+      // Porta provisoria, soh para a digitacao das entradas
+      std::unique_ptr<Port> prov(RegistroPortas::criar(codigo));
+      prov->digitar();
+      const int pos = portas->definir(i,codigo,prov->getNumInputs());
+      for (int j=0; j<prov->getNumInputs(); j++) portas->id_in[pos+j] = prov->getId_in(j);
+    }
+    while (!validPort(i+1));
+  }
+
+  for (int i=0; i<getNumOutputs(); i++)
+  {
+    int IdOrig;
+    do
+    {
+      std::cout << "Id de origem da saida " << i+1 << ": ";
+      std::cin >> IdOrig;
+    }
+    while (!validIdOrig(IdOrig));
+    id_out.at(i) = IdOrig;
+  }
+  construirFanout();
+  validado = true;
+}
+
+// Leh de ArqI o corpo de um circuito (apos a palavra CIRCUITO)
+// Gera uma excecao (int) em caso de erro
+void Circuito::lerCorpo(std::istream& ArqI)
+{
+  std::string prov;
+  int NI, NO, NP;
+  int id;
+  char c;
+
+  ArqI >> NI >> NO >> NP;
+  if (!ArqI.good() || NI<=0 || NO<=0 || NP<=0) throw 2;
+  resize(NI,NO,NP);
+
+  ArqI >> prov;
+  if (!ArqI.good() || prov!="PORTAS") throw 3;
+  for (int i=0; i<getNumPorts(); i++)
+  {
+    ArqI >> id >> c;
+    if (!ArqI.good() || id!=i+1 || c!=')') throw 4;
+    ArqI >> prov;
+    if (!ArqI.good()) throw 5;
+    CodigoPorta codigo;
+    ptr_Modulo M;
+    int saida = 0;
+    if (prov=="SB" || prov=="sb")
+    {
+      // Instancia de modulo: NOME:Saida
+      std::string ref;
+      size_t pos;
+      ArqI >> ref;
+      pos = ref.find(':');
+      if (!ArqI.good() || pos==std::string::npos) throw 5;
+      M = getModulo(ref.substr(0,pos));
+      saida = atoi(ref.c_str()+pos+1);
+      if (!M || saida<1 || saida>M->getNumOutputs()) throw 5;
+      codigo = CODIGO_INSTANCIA;
+    }
+    else
+    {
+      // Consulta direta na tabela de codigos, sem comparacao de strings
+      codigo = RegistroPortas::getCodigo(prov);
+      if (codigo==CODIGO_INVALIDO) throw 5;
+    }
+
+    // As entradas ("NIn: id1 id2 ..."), lidas direto para o fim de id_in
+    int N;
+    ArqI >> N >> c;
+    if (!ArqI.good() || c!=':') throw 6;
+    if (M ? N!=M->getNumInputs() : !RegistroPortas::validNumInputs(codigo,N)) throw 6;
+    const int pos = portas->definir(i,codigo,N);
+    if (M) portas->instancias[i] = std::make_pair(M,saida);
+    for (int j=0; j<N; j++)
+    {
+      ArqI >> id;
+      if (!ArqI.good() || id==0) throw 6;
+      if (!validIdOrig(id)) throw 7;
+      portas->id_in[pos+j] = id;
+    }
+  }
+
+  lerSaidas(ArqI);
+  construirFanout();
+}
+
+// Leh de ArqI a secao SAIDAS de um circuito jah dimensionado
+// Gera uma excecao (int) em caso de erro
+void Circuito::lerSaidas(std::istream& ArqI)
+{
+  std::string prov;
+  int id;
+  char c;
+
+  ArqI >> prov;
+  if (!ArqI.good() || prov!="SAIDAS") throw 8;
+  for (int i=0; i<getNumOutputs(); i++)
+  {
+    ArqI >> id >> c;
+    if (ArqI.fail() || id!=i+1 || c!=')') throw 9;
+    ArqI >> id_out.at(i);
+    if (ArqI.fail() || !validIdOrig(id_out.at(i))) throw 10;
+  }
+}
+
+// Leh de ArqI a secao opcional ATRASOS (ateh o fim do arquivo)
+// Gera uma excecao (int) em caso de erro
+void Circuito::lerAtrasos(std::istream& ArqI)
+{
+  std::string prov;
+
+  ArqI >> prov;
+  if (!ArqI.fail())
+  {
+    int atraso;
+    if (prov!="ATRASOS") throw 11;
+    while (ArqI >> prov)
+    {
+      ArqI >> atraso;
+      CodigoPorta codigo = RegistroPortas::getCodigo(prov);
+      if (ArqI.fail() || codigo==CODIGO_INVALIDO || atraso<1) throw 12;
+      atrasos[RegistroPortas::getTipo(codigo).nome] = atraso;
+    }
+  }
+}
+
+// Entrada dos dados de um circuito via arquivo
+// Retorna true se deu tudo OK; false se deu erro (nesse caso, o circuito fica vazio)
+bool Circuito::ler(const std::string& arq)
+{
+  // O texto de um arquivo comprimido eh descomprimido um bloco de cada vez
+  if (ArquivoComprimido::isComprimido(arq))
+  {
+    EntradaComprimida ArqI(arq);
+    return lerArquivo(ArqI);
+  }
+  std::ifstream ArqI(arq);
+  return lerArquivo(ArqI);
+}
+
+// Leh um arquivo completo de ArqI (falha se a stream nao tiver sido aberta)
+bool Circuito::lerArquivo(std::istream& ArqI)
+{
+  clear();
+  try
+  {
+    std::string prov;
+
+    if (ArqI.fail()) throw 1;
+
+    // Definicoes (opcionais) de modulos
+    ArqI >> prov;
+    while (ArqI.good() && prov=="MODULO")
+    {
+      std::string nome;
+      Circuito M;
+
+      ArqI >> nome >> prov;
+      if (!ArqI.good() || prov!="CIRCUITO") throw 13;
+      M.modulos = modulos;
+      M.lerCorpo(ArqI);
+      ArqI >> prov;
+      if (!ArqI.good() || prov!="FIM") throw 14;
+      if (!definirModulo(nome,M)) throw 15;
+      ArqI >> prov;
+    }
+
+    if (!ArqI.good() || prov!="CIRCUITO") throw 2;
+    lerCorpo(ArqI);
+    // Secao opcional com os atrasos dos tipos de porta
+    lerAtrasos(ArqI);
+  }
+  catch (int erro)
+  {
+    clear();
+    return false;
+  }
+  // Cada porta e cada saida foi conferida durante a leitura
+  validado = true;
+  return true;
+}
+
+// Saida dos dados de um circuito (em tela ou arquivo)
+std::ostream& Circuito::imprimir(std::ostream& O) const
+{
+  if (!valid()) return O;
+
+  EscritorCircuito().escrever(*this, O);
+  return O;
+}
+
+// Salvar circuito em arquivo, caso o circuito seja valido
+bool Circuito::salvar(const std::string& arq) const
+{
+  return EscritorCircuito().salvar(*this, arq);
+}
+
+// Salvar circuito em arquivo comprimido, caso o circuito seja valido
+bool Circuito::salvarComprimido(const std::string& arq, int NumThreads) const
+{
+  if (!valid()) return false;
+
+  SaidaComprimida ArqO;
+  if (!ArqO.abrir(arq, SaidaComprimida::TAM_BLOCO_PADRAO, NumThreads)) return false;
+  const bool ok = EscritorCircuito(NumThreads).escrever(*this, ArqO);
+  return ArqO.fechar() && ok;
+}
+
+// Operador de impressao da classe Circuit
+std::ostream& operator<<(std::ostream& O, const Circuito& C)
+{
+  return C.imprimir(O);
+}
 
 /// ***********************
 /// SIMULACAO (funcao principal do circuito)
 /// ***********************
 
-falta_fazer();
+// Calcula a saida das portas do circuito para os valores de entrada passados
+// A simulacao eh feita pela versao compilada do circuito, construida caso o circuito
+// tenha sido alterado desde a ultima simulacao
+bool Circuito::simular(const std::vector<bool3S>& in_circ)
+{
+  if (int(in_circ.size())!=getNumInputs()) return false;
+  if (!getCompilado()) return false;
+
+  // Nao altera os sinais de outras copias do circuito
+  if (!sinais || sinais.use_count()>1 || int(sinais->size())!=programa->getNumSinais())
+  {
+    sinais = std::make_shared<std::vector<bool3S>>(programa->getNumSinais());
+  }
+
+  if (sob_demanda)
+  {
+    std::copy(in_circ.begin(), in_circ.end(), sinais->begin());
+    iniciarDemanda();
+    return true;
+  }
+  programa->simular(in_circ.data(), sinais->data(), out_circ.data());
+  demanda_pendente = false;
+  return true;
+}
+
+// Simula um vetor de entrada compactado
+// As entradas sao descompactadas nas primeiras posicoes do vetor de sinais, que
+// servem de entrada para a versao compilada (a copia das entradas para os sinais
+// passa a ser uma copia de cada valor sobre si mesmo)
+bool Circuito::simular(const VetorCompacto3S& in_compacto, VetorCompacto3S& out_compacto)
+{
+  if (int(in_compacto.size())!=getNumInputs()) return false;
+  if (!getCompilado()) return false;
+
+  if (!sinais || sinais.use_count()>1 || int(sinais->size())!=programa->getNumSinais())
+  {
+    sinais = std::make_shared<std::vector<bool3S>>(programa->getNumSinais());
+  }
+
+  in_compacto.desempacotar(sinais->data());
+  programa->simular(sinais->data(), sinais->data(), out_circ.data());
+  out_compacto.empacotar(out_circ);
+  demanda_pendente = false;
+  return true;
+}
+
+// Guarda os valores de todos os sinais da ultima simulacao
+bool Circuito::salvarEstado(EstadoSimulacao& E) const
+{
+  const bool3S* S = getSinais();
+  if (S==nullptr) return false;
+  E.clear();
+  E.sinais.empacotar(S, sinais->size());
+  return true;
+}
+
+// Restaura os valores dos sinais e recalcula as saidas do circuito a partir deles
+bool Circuito::restaurarEstado(const EstadoSimulacao& E)
+{
+  if (!getCompilado()) return false;
+  if (int(E.sinais.size())!=programa->getNumSinais()) return false;
+
+  // Nao altera os sinais de outras copias do circuito
+  if (!sinais || sinais.use_count()>1 || int(sinais->size())!=programa->getNumSinais())
+  {
+    sinais = std::make_shared<std::vector<bool3S>>(programa->getNumSinais());
+  }
+  E.sinais.desempacotar(sinais->data());
+  for (int j=0; j<getNumOutputs(); j++) out_circ[j] = (*sinais)[programa->getIndiceSaida(j)];
+  demanda_pendente = false;
+  return true;
+}
+
+void Circuito::setSobDemanda(bool Ativa)
+{
+  if (!Ativa && demanda_pendente)
+  {
+    // As saidas passam a ser consultadas em out_circ
+    for (int j=0; j<getNumOutputs(); j++) out_circ[j] = getOutput(j+1);
+    demanda_pendente = false;
+  }
+  sob_demanda = Ativa;
+}
+
+bool Circuito::isSobDemanda() const
+{
+  return sob_demanda;
+}
+
+// Inicia uma nova epoca: todas as portas passam a estar nao avaliadas, sem percorre-las
+// Os vetores auxiliares soh sao refeitos quando o programa muda
+void Circuito::iniciarDemanda()
+{
+  // Nao altera o estado de outras copias do circuito
+  if (!demanda) demanda = std::make_shared<Demanda>();
+  else if (demanda.use_count()>1) demanda = std::make_shared<Demanda>(*demanda);
+  Demanda& D = *demanda;
+  if (D.programa!=programa)
+  {
+    const int NP = programa->getNumPorts();
+    D.programa = programa;
+    D.epoca = 0;
+    D.epoca_porta.assign(NP,0);
+    D.estado.assign(NP,0);
+    D.pos_ordem.assign(NP,0);
+    const std::vector<int>& ordem = programa->getOrdem();
+    for (size_t k=0; k<ordem.size(); k++) D.pos_ordem[ordem[k]] = k;
+  }
+  if (++D.epoca==0)
+  {
+    // A contagem deu a volta: as epocas antigas poderiam coincidir com a nova
+    std::fill(D.epoca_porta.begin(), D.epoca_porta.end(), 0);
+    D.epoca = 1;
+  }
+  demanda_pendente = true;
+}
+
+// Avalia o cone de entrada do sinal de indice S por uma busca em profundidade pelas
+// portas ainda nao avaliadas nesta epoca (as jah avaliadas sao constantes)
+// Sem realimentacao no cone, cada porta eh avaliada ao sair da busca (pos-ordem),
+// depois de todas as suas entradas. Ao encontrar uma porta que ainda estah na pilha,
+// ha um laco: as portas concluidas antes dele jah estao corretas (nao dependem do
+// laco), e as demais portas visitadas, que formam um cone fechado, sao avaliadas
+// como em CircuitoCompilado::simular (a partir de ?, na ordem de simulacao, enquanto
+// alguma porta indefinida passar a ser definida)
+bool3S Circuito::avaliarSobDemanda(int S) const
+{
+  const int NI = demanda->programa->getNumInputs();
+  if (S<NI || demanda->epoca_porta[S-NI]==demanda->epoca) return (*sinais)[S];
+
+  // Nao altera os sinais nem o estado de outras copias do circuito
+  if (sinais.use_count()>1) sinais = std::make_shared<std::vector<bool3S>>(*sinais);
+  if (demanda.use_count()>1) demanda = std::make_shared<Demanda>(*demanda);
+  Demanda& D = *demanda;
+  const CircuitoCompilado& P = *D.programa;
+  bool3S* s = sinais->data();
+
+  bool laco = false;
+  D.cone.assign(1,S-NI);
+  D.pilha.assign(1,std::make_pair(S-NI,0));
+  D.estado[S-NI] = 1;
+  while (!D.pilha.empty())
+  {
+    const int IP = D.pilha.back().first;
+    const int I = D.pilha.back().second;
+    if (I<P.getNumInputsPorta(IP))
+    {
+      D.pilha.back().second++;
+      const int J = P.getIndiceEntrada(IP,I)-NI;
+      if (J<0 || D.epoca_porta[J]==D.epoca || D.estado[J]==2) continue;
+      if (D.estado[J]==1)
+      {
+        laco = true;
+        continue;
+      }
+      D.estado[J] = 1;
+      D.cone.push_back(J);
+      D.pilha.push_back(std::make_pair(J,0));
+      continue;
+    }
+    D.estado[IP] = 2;
+    D.pilha.pop_back();
+    if (!laco)
+    {
+      s[NI+IP] = P.simularPorta(IP,s);
+      D.epoca_porta[IP] = D.epoca;
+    }
+  }
+
+  if (laco)
+  {
+    // As portas restantes do cone, na ordem de simulacao
+    std::vector<int> resto;
+    for (int IP : D.cone)
+    {
+      if (D.epoca_porta[IP]!=D.epoca) resto.push_back(IP);
+    }
+    std::sort(resto.begin(), resto.end(),
+              [&D](int A, int B) {return D.pos_ordem[A]<D.pos_ordem[B];});
+    for (int IP : resto) s[NI+IP] = bool3S::UNDEF;
+    bool tudo_def, alguma_def;
+    do
+    {
+      tudo_def = true;
+      alguma_def = false;
+      for (int IP : resto)
+      {
+        if (s[NI+IP]==bool3S::UNDEF)
+        {
+          s[NI+IP] = P.simularPorta(IP,s);
+          if (s[NI+IP]==bool3S::UNDEF) tudo_def = false;
+          else alguma_def = true;
+        }
+      }
+    }
+    while (!tudo_def && alguma_def);
+    for (int IP : resto) D.epoca_porta[IP] = D.epoca;
+  }
+
+  for (int IP : D.cone) D.estado[IP] = 0;
+  return s[S];
+}
+
+// Simula 64 vetores de entrada em paralelo, pela versao compilada do circuito
+bool Circuito::simularLote(const std::vector<Lote3S>& in_circ, std::vector<Lote3S>& out_lote)
+{
+  std::vector<Lote3S> sinais_lote;
+  return simularLote(in_circ, out_lote, sinais_lote);
+}
+
+bool Circuito::simularLote(const std::vector<Lote3S>& in_circ, std::vector<Lote3S>& out_lote,
+                           std::vector<Lote3S>& sinais_lote)
+{
+  if (int(in_circ.size())!=getNumInputs()) return false;
+  if (!getCompilado()) return false;
+
+  sinais_lote.resize(programa->getNumSinais());
+  out_lote.resize(getNumOutputs());
+  programa->simularLote(in_circ.data(), sinais_lote.data(), out_lote.data());
+  return true;
+}
+
+// Retorna a versao compilada do circuito, construindo-a caso necessario
+std::shared_ptr<const CircuitoCompilado> Circuito::getCompilado()
+{
+  if (!programa)
+  {
+    std::shared_ptr<CircuitoCompilado> prov = std::make_shared<CircuitoCompilado>();
+    if (!prov->compilar(*this)) return nullptr;
+    programa = prov;
+    validado = true;
+  }
+  return programa;
+}
@@ -0,0 +1,558 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include "compressao.h"
+
+///
+/// CODEC DE BLOCOS
+///
+
+// Formato de uma sequencia: um byte com o numero de literais (4 bits altos) e o
+// comprimento da copia menos 4 (4 bits baixos), os bytes extras do numero de
+// literais (se for 15: bytes somados ateh um diferente de 255), os literais, a
+// distancia da copia (2 bytes, little-endian) e os bytes extras do comprimento
+// A ultima sequencia tem apenas literais (termina no fim dos dados)
+
+// O menor comprimento de uma copia
+static const size_t MIN_COPIA = 4;
+// Os ultimos bytes de um bloco sao sempre literais, e nenhuma copia comeca nos
+// ultimos MARGEM bytes
+static const size_t FIM_LITERAIS = 5;
+static const size_t MARGEM = 12;
+// A maior distancia de uma copia
+static const size_t MAX_DISTANCIA = 65535;
+// O numero de bits da tabela de hash
+static const int BITS_HASH = 16;
+
+static inline uint32_t ler32(const unsigned char* p)
+{
+  uint32_t v;
+  std::memcpy(&v, p, 4);
+  return v;
+}
+
+static inline uint32_t hash32(uint32_t v)
+{
+  return (v*2654435761u) >> (32-BITS_HASH);
+}
+
+// Escreve um comprimento que passou de 15 (bytes de 255 seguidos do resto)
+static inline void escreverExtra(size_t N, std::string& Saida)
+{
+  for (; N>=255; N-=255) Saida.push_back(char(255));
+  Saida.push_back(char(N));
+}
+
+// Escreve uma sequencia: NLit literais a partir de Lit e uma copia de Comp bytes a
+// Distancia bytes para tras (Comp==0: sem copia, a ultima sequencia)
+static void escreverSequencia(const unsigned char* Lit, size_t NLit, size_t Distancia,
+                              size_t Comp, std::string& Saida)
+{
+  const size_t extra = (Comp>0 ? Comp-MIN_COPIA : 0);
+  Saida.push_back(char((std::min<size_t>(NLit,15)<<4) | std::min<size_t>(extra,15)));
+  if (NLit>=15) escreverExtra(NLit-15, Saida);
+  Saida.append(reinterpret_cast<const char*>(Lit), NLit);
+  if (Comp==0) return;
+  Saida.push_back(char(Distancia & 0xFF));
+  Saida.push_back(char(Distancia >> 8));
+  if (extra>=15) escreverExtra(extra-15, Saida);
+}
+
+void CodecBlocos::comprimir(const char* Dados, size_t N, std::string& Saida)
+{
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(Dados);
+  // A ultima posicao em que cada hash de 4 bytes foi visto (reaproveitada)
+  thread_local std::vector<int64_t> tabela;
+  tabela.assign(size_t(1)<<BITS_HASH, -1);
+
+  size_t ancora = 0, i = 0;
+  if (N>=MARGEM)
+  {
+    const size_t limite = N-MARGEM;
+    while (i<=limite)
+    {
+      const uint32_t v = ler32(in+i);
+      const uint32_t h = hash32(v);
+      const int64_t c = tabela[h];
+      tabela[h] = i;
+      if (c<0 || i-c>MAX_DISTANCIA || ler32(in+c)!=v)
+      {
+        // Aceleracao: quanto mais longe da ultima copia, maiores os saltos
+        i += 1 + ((i-ancora)>>6);
+        continue;
+      }
+
+      // Estende a copia para tras (sobre os literais) e para frente
+      size_t ini = i, orig = c;
+      while (ini>ancora && orig>0 && in[ini-1]==in[orig-1])
+      {
+        ini--;
+        orig--;
+      }
+      const size_t max_comp = N-FIM_LITERAIS-ini;
+      size_t comp = 0;
+      while (comp<max_comp && in[orig+comp]==in[ini+comp]) comp++;
+
+      escreverSequencia(in+ancora, ini-ancora, ini-orig, comp, Saida);
+      i = ini+comp;
+      ancora = i;
+      if (i-2<=limite) tabela[hash32(ler32(in+i-2))] = i-2;
+    }
+  }
+  escreverSequencia(in+ancora, N-ancora, 0, 0, Saida);
+}
+
+// Leh um comprimento extra (ver escreverExtra)
+static inline bool lerExtra(const unsigned char*& p, const unsigned char* fim, size_t& N)
+{
+  unsigned char b;
+  do
+  {
+    if (p==fim) return false;
+    b = *p++;
+    N += b;
+  }
+  while (b==255);
+  return true;
+}
+
+bool CodecBlocos::descomprimir(const char* Dados, size_t N, char* Saida, size_t NOriginal)
+{
+  const unsigned char* p = reinterpret_cast<const unsigned char*>(Dados);
+  const unsigned char* const fim = p+N;
+  size_t o = 0;
+
+  while (p<fim)
+  {
+    const unsigned char token = *p++;
+    size_t nlit = token>>4;
+    if (nlit==15 && !lerExtra(p,fim,nlit)) return false;
+    if (nlit>size_t(fim-p) || nlit>NOriginal-o) return false;
+    // Poucos literais longe dos fins: copia de tamanho fixo
+    if (nlit<=16 && fim-p>=16 && NOriginal-o>=16) std::memcpy(Saida+o, p, 16);
+    else std::memcpy(Saida+o, p, nlit);
+    p += nlit;
+    o += nlit;
+    // A ultima sequencia nao tem copia
+    if (p==fim) break;
+
+    if (fim-p<2) return false;
+    const size_t distancia = p[0] | (size_t(p[1])<<8);
+    p += 2;
+    size_t comp = (token & 15);
+    if (comp==15 && !lerExtra(p,fim,comp)) return false;
+    comp += MIN_COPIA;
+    if (distancia==0 || distancia>o || comp>NOriginal-o) return false;
+
+    char* destino = Saida+o;
+    const char* origem = destino-distancia;
+    if (distancia>=8 && NOriginal-o>=comp+8)
+    {
+      // Em palavras de 8 bytes, que podem passar do fim da copia (mas nao da saida):
+      // com distancia>=8, cada palavra jah foi escrita antes de ser lida
+      for (size_t k=0; k<comp; k+=8) std::memcpy(destino+k, origem+k, 8);
+    }
+    else if (distancia>=comp) std::memcpy(destino, origem, comp);
+    // Copia sobreposta (repeticao de um padrao curto): byte a byte
+    else for (size_t k=0; k<comp; k++) destino[k] = origem[k];
+    o += comp;
+  }
+  return o==NOriginal;
+}
+
+///
+/// FORMATO DO ARQUIVO
+///
+
+static const char MARCA_INICIO[8] = {'B','L','C','3','S','\0','\0','\0'};
+static const char MARCA_FIM[8] = {'B','L','C','3','S','F','I','M'};
+// No indice, o bit mais alto do tamanho comprimido indica um bloco sem compressao
+static const uint32_t SEM_COMPRESSAO = 0x80000000u;
+// O maior tamanho de um bloco
+static const size_t MAX_BLOCO = size_t(1)<<30;
+
+///
+/// CLASSE SAIDA COMPRIMIDA
+///
+
+SaidaComprimida::Buffer::Buffer():
+  ArqO(), tam_bloco(0), num_threads(1), atual(), cheios(), posicao(), tam_comprimido(),
+  tam_original(), total(0)
+{
+}
+
+bool SaidaComprimida::Buffer::abrir(const std::string& Arq, size_t TamBloco, int NumThreads)
+{
+  fechar();
+  ArqO.open(Arq, std::ios::binary);
+  if (!ArqO.is_open()) return false;
+
+  tam_bloco = std::min(std::max<size_t>(TamBloco,1024), MAX_BLOCO);
+  num_threads = std::max(1,NumThreads);
+  posicao.clear();
+  tam_comprimido.clear();
+  tam_original.clear();
+  total = 0;
+  const uint64_t tam = tam_bloco;
+  ArqO.write(MARCA_INICIO, 8);
+  ArqO.write(reinterpret_cast<const char*>(&tam), sizeof(tam));
+  atual.assign(tam_bloco, '\0');
+  setp(&atual[0], &atual[0]+tam_bloco);
+  return ArqO.good();
+}
+
+bool SaidaComprimida::Buffer::aberto() const
+{
+  return ArqO.is_open();
+}
+
+// Passa o bloco atual (se nao estiver vazio) para a lista de cheios
+void SaidaComprimida::Buffer::fecharBloco(bool Forcar)
+{
+  const size_t N = pptr()-pbase();
+  if (N>0)
+  {
+    atual.resize(N);
+    cheios.push_back(std::move(atual));
+    total += N;
+  }
+  if (int(cheios.size())>=num_threads || Forcar) gravarCheios();
+  atual.assign(tam_bloco, '\0');
+  setp(&atual[0], &atual[0]+tam_bloco);
+}
+
+// Comprime os blocos cheios (um por thread) e os grava em ordem
+void SaidaComprimida::Buffer::gravarCheios()
+{
+  const int NB = cheios.size();
+  if (NB==0) return;
+  std::vector<std::string> comp(NB);
+  auto trabalho = [&](int t)
+  {
+    for (int k=t; k<NB; k+=num_threads) CodecBlocos::comprimir(cheios[k].data(), cheios[k].size(), comp[k]);
+  };
+  std::vector<std::thread> threads;
+  for (int t=1; t<std::min(num_threads,NB); t++) threads.emplace_back(trabalho, t);
+  trabalho(0);
+  for (std::thread& th : threads) th.join();
+
+  uint64_t pos = (posicao.empty() ? 16 : posicao.back()+(tam_comprimido.back() & ~SEM_COMPRESSAO));
+  for (int k=0; k<NB; k++)
+  {
+    // Um bloco que nao diminui fica sem compressao
+    const bool bruto = (comp[k].size()>=cheios[k].size());
+    const std::string& B = (bruto ? cheios[k] : comp[k]);
+    ArqO.write(B.data(), B.size());
+    posicao.push_back(pos);
+    tam_comprimido.push_back(uint32_t(B.size()) | (bruto ? SEM_COMPRESSAO : 0));
+    tam_original.push_back(cheios[k].size());
+    pos += B.size();
+  }
+  cheios.clear();
+}
+
+SaidaComprimida::Buffer::int_type SaidaComprimida::Buffer::overflow(int_type c)
+{
+  if (!ArqO.is_open()) return traits_type::eof();
+  fecharBloco(false);
+  if (!ArqO.good()) return traits_type::eof();
+  if (!traits_type::eq_int_type(c, traits_type::eof()))
+  {
+    *pptr() = traits_type::to_char_type(c);
+    pbump(1);
+  }
+  return traits_type::not_eof(c);
+}
+
+// Grava os blocos restantes, o indice e o final
+bool SaidaComprimida::Buffer::fechar()
+{
+  if (!ArqO.is_open()) return true;
+  fecharBloco(true);
+
+  const uint64_t pos_indice = (posicao.empty() ? 16 : posicao.back()+(tam_comprimido.back() & ~SEM_COMPRESSAO));
+  for (size_t k=0; k<posicao.size(); k++)
+  {
+    ArqO.write(reinterpret_cast<const char*>(&posicao[k]), sizeof(uint64_t));
+    ArqO.write(reinterpret_cast<const char*>(&tam_comprimido[k]), sizeof(uint32_t));
+    ArqO.write(reinterpret_cast<const char*>(&tam_original[k]), sizeof(uint32_t));
+  }
+  const uint64_t final[3] = {uint64_t(posicao.size()), total, pos_indice};
+  ArqO.write(reinterpret_cast<const char*>(final), sizeof(final));
+  ArqO.write(MARCA_FIM, 8);
+
+  const bool ok = ArqO.good();
+  ArqO.close();
+  atual.clear();
+  atual.shrink_to_fit();
+  setp(nullptr, nullptr);
+  return ok;
+}
+
+SaidaComprimida::SaidaComprimida():
+  std::ostream(nullptr), buf()
+{
+  rdbuf(&buf);
+}
+
+SaidaComprimida::SaidaComprimida(const std::string& Arq, size_t TamBloco, int NumThreads):
+  SaidaComprimida()
+{
+  abrir(Arq, TamBloco, NumThreads);
+}
+
+SaidaComprimida::~SaidaComprimida()
+{
+  fechar();
+}
+
+bool SaidaComprimida::abrir(const std::string& Arq, size_t TamBloco, int NumThreads)
+{
+  clear();
+  if (!buf.abrir(Arq, TamBloco, NumThreads))
+  {
+    setstate(std::ios::failbit);
+    return false;
+  }
+  return true;
+}
+
+bool SaidaComprimida::fechar()
+{
+  if (!buf.aberto()) return !fail();
+  const bool ok = buf.fechar();
+  if (!ok) setstate(std::ios::badbit);
+  return ok && !fail();
+}
+
+bool SaidaComprimida::aberto() const
+{
+  return buf.aberto();
+}
+
+///
+/// CLASSE ARQUIVO COMPRIMIDO
+///
+
+ArquivoComprimido::ArquivoComprimido():
+  ArqI(), mtx(), total(0), posicao(), tam_comprimido(), tam_original(), inicio()
+{
+}
+
+bool ArquivoComprimido::isComprimido(const std::string& Arq)
+{
+  std::ifstream A(Arq, std::ios::binary);
+  char marca[8];
+  A.read(marca, 8);
+  return A.good() && std::memcmp(marca, MARCA_INICIO, 8)==0;
+}
+
+bool ArquivoComprimido::abrir(const std::string& Arq)
+{
+  fechar();
+  ArqI.open(Arq, std::ios::binary);
+  if (!ArqI.is_open()) return false;
+
+  char marca[8];
+  uint64_t final[3];
+  ArqI.seekg(0, std::ios::end);
+  const uint64_t tam_arquivo = ArqI.tellg();
+  ArqI.seekg(0);
+  ArqI.read(marca, 8);
+  bool ok = (ArqI.good() && tam_arquivo>=16+32 && std::memcmp(marca, MARCA_INICIO, 8)==0);
+  if (ok)
+  {
+    ArqI.seekg(tam_arquivo-32);
+    ArqI.read(reinterpret_cast<char*>(final), sizeof(final));
+    ArqI.read(marca, 8);
+    ok = (ArqI.good() && std::memcmp(marca, MARCA_FIM, 8)==0 && final[2]>=16 &&
+          final[2]<=tam_arquivo-32 && final[0]==(tam_arquivo-32-final[2])/16 &&
+          (tam_arquivo-32-final[2])%16==0);
+  }
+  if (ok)
+  {
+    const size_t NB = final[0];
+    std::vector<char> indice(16*NB);
+    ArqI.seekg(final[2]);
+    ArqI.read(indice.data(), indice.size());
+    ok = ArqI.good();
+    posicao.resize(NB);
+    tam_comprimido.resize(NB);
+    tam_original.resize(NB);
+    inicio.assign(NB+1, 0);
+    for (size_t k=0; k<NB && ok; k++)
+    {
+      std::memcpy(&posicao[k], &indice[16*k], 8);
+      std::memcpy(&tam_comprimido[k], &indice[16*k+8], 4);
+      std::memcpy(&tam_original[k], &indice[16*k+12], 4);
+      const uint32_t tc = tam_comprimido[k] & ~SEM_COMPRESSAO;
+      ok = (posicao[k]>=16 && posicao[k]+tc<=final[2] && tam_original[k]<=MAX_BLOCO &&
+            (!(tam_comprimido[k] & SEM_COMPRESSAO) || tc==tam_original[k]));
+      inicio[k+1] = inicio[k]+tam_original[k];
+    }
+    total = final[1];
+    ok = ok && inicio[NB]==total;
+  }
+  if (!ok) fechar();
+  return ok;
+}
+
+void ArquivoComprimido::fechar()
+{
+  if (ArqI.is_open()) ArqI.close();
+  ArqI.clear();
+  total = 0;
+  posicao.clear();
+  tam_comprimido.clear();
+  tam_original.clear();
+  inicio.clear();
+}
+
+bool ArquivoComprimido::aberto() const
+{
+  return ArqI.is_open();
+}
+
+uint64_t ArquivoComprimido::getTamanho() const
+{
+  return total;
+}
+
+size_t ArquivoComprimido::getNumBlocos() const
+{
+  return posicao.size();
+}
+
+uint64_t ArquivoComprimido::getInicioBloco(size_t K) const
+{
+  return inicio.at(K);
+}
+
+size_t ArquivoComprimido::getTamanhoBloco(size_t K) const
+{
+  return tam_original.at(K);
+}
+
+bool ArquivoComprimido::lerComprimido(size_t K, std::string& Dados) const
+{
+  Dados.resize(tam_comprimido[K] & ~SEM_COMPRESSAO);
+  std::lock_guard<std::mutex> lock(mtx);
+  ArqI.seekg(posicao[K]);
+  ArqI.read(&Dados[0], Dados.size());
+  const bool ok = ArqI.good();
+  ArqI.clear();
+  return ok;
+}
+
+bool ArquivoComprimido::lerBloco(size_t K, std::string& Dados) const
+{
+  if (K>=posicao.size()) return false;
+  if (tam_comprimido[K] & SEM_COMPRESSAO) return lerComprimido(K, Dados);
+  std::string comp;
+  if (!lerComprimido(K, comp)) return false;
+  Dados.resize(tam_original[K]);
+  return CodecBlocos::descomprimir(comp.data(), comp.size(), &Dados[0], Dados.size());
+}
+
+bool ArquivoComprimido::ler(uint64_t Pos, size_t N, char* Dados) const
+{
+  if (Pos>total || N>total-Pos) return false;
+  // O bloco que contem Pos
+  size_t K = std::upper_bound(inicio.begin(), inicio.end(), Pos)-inicio.begin()-1;
+  std::string bloco;
+  while (N>0)
+  {
+    if (!lerBloco(K, bloco)) return false;
+    const size_t desl = Pos-inicio[K];
+    const size_t n = std::min<size_t>(N, bloco.size()-desl);
+    std::memcpy(Dados, bloco.data()+desl, n);
+    Dados += n;
+    Pos += n;
+    N -= n;
+    K++;
+  }
+  return true;
+}
+
+// Cada thread descomprime os seus blocos direto na posicao final do texto
+bool ArquivoComprimido::descomprimir(std::string& Dados, int NumThreads) const
+{
+  if (!aberto()) return false;
+  Dados.resize(total);
+  const size_t NB = posicao.size();
+  const int NT = std::max(1, std::min<int>(NumThreads, NB));
+  std::atomic<bool> ok(true);
+  auto trabalho = [&](int t)
+  {
+    std::string comp;
+    for (size_t k=t; k<NB && ok.load(std::memory_order_relaxed); k+=NT)
+    {
+      if (!lerComprimido(k, comp)) ok = false;
+      else if (tam_comprimido[k] & SEM_COMPRESSAO) std::memcpy(&Dados[inicio[k]], comp.data(), comp.size());
+      else if (!CodecBlocos::descomprimir(comp.data(), comp.size(), &Dados[inicio[k]], tam_original[k])) ok = false;
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int t=1; t<NT; t++) threads.emplace_back(trabalho, t);
+  trabalho(0);
+  for (std::thread& th : threads) th.join();
+  if (!ok) Dados.clear();
+  return ok;
+}
+
+///
+/// CLASSE ENTRADA COMPRIMIDA
+///
+
+EntradaComprimida::Buffer::Buffer():
+  arq(), bloco(), proximo(0)
+{
+}
+
+bool EntradaComprimida::Buffer::abrir(const std::string& Arq)
+{
+  bloco.clear();
+  proximo = 0;
+  setg(nullptr, nullptr, nullptr);
+  return arq.abrir(Arq);
+}
+
+EntradaComprimida::Buffer::int_type EntradaComprimida::Buffer::underflow()
+{
+  if (gptr()<egptr()) return traits_type::to_int_type(*gptr());
+  // Pula blocos vazios
+  while (proximo<arq.getNumBlocos())
+  {
+    if (!arq.lerBloco(proximo++, bloco)) return traits_type::eof();
+    if (!bloco.empty())
+    {
+      setg(&bloco[0], &bloco[0], &bloco[0]+bloco.size());
+      return traits_type::to_int_type(*gptr());
+    }
+  }
+  return traits_type::eof();
+}
+
+EntradaComprimida::EntradaComprimida():
+  std::istream(nullptr), buf()
+{
+  rdbuf(&buf);
+}
+
+EntradaComprimida::EntradaComprimida(const std::string& Arq):
+  EntradaComprimida()
+{
+  abrir(Arq);
+}
+
+bool EntradaComprimida::abrir(const std::string& Arq)
+{
+  clear();
+  if (!buf.abrir(Arq))
+  {
+    setstate(std::ios::failbit);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,186 @@
+#ifndef _COMPRESSAO_H_
+#define _COMPRESSAO_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+///
+/// COMPRESSAO EM BLOCOS
+///
+/// Compressao sem perdas de arquivos de texto muito repetitivos (circuitos salvos,
+/// tabelas verdade, relatorios, VCD), sem dependencias externas.
+///
+/// O codec (CodecBlocos) eh do tipo LZ77, no estilo do LZ4: cada bloco eh uma
+/// sequencia de (literais, copia de ateh 64 KB para tras), com uma tabela de hash das
+/// sequencias de 4 bytes para achar as repeticoes. A compressao e a descompressao
+/// sao rapidas (muito mais que a leitura do texto) e a descompressao confere todos os
+/// limites (um arquivo corrompido gera erro, nunca acesso invalido).
+///
+/// O arquivo comprimido eh dividido em blocos independentes (por padrao, 1 MB de
+/// texto original em cada um), seguidos de um indice com a posicao e os tamanhos de
+/// cada bloco:
+///   "BLC3S\0\0\0" | blocos | indice | num. de blocos, tamanho original,
+///   posicao do indice | "BLC3SFIM"
+/// Um bloco que nao diminui com a compressao eh guardado sem compressao.
+/// Como os blocos sao independentes, eles podem ser comprimidos e descomprimidos em
+/// paralelo, e qualquer trecho do texto original pode ser lido descomprimindo apenas
+/// os blocos que o contem (ArquivoComprimido::ler).
+///
+
+class CodecBlocos {
+public:
+  // Comprime os N bytes de Dados, acrescentando o resultado ao fim de Saida
+  static void comprimir(const char* Dados, size_t N, std::string& Saida);
+  // Descomprime os N bytes de Dados em Saida, que deve ter exatamente NOriginal bytes
+  // Retorna false se os dados estiverem corrompidos
+  static bool descomprimir(const char* Dados, size_t N, char* Saida, size_t NOriginal);
+};
+
+///
+/// CLASSE SAIDA COMPRIMIDA
+///
+/// Um std::ostream que grava um arquivo comprimido: qualquer funcao que escreve em
+/// um ostream (Circuito::imprimir, TabelaBDD::imprimirTabela, etc.) pode gravar
+/// direto no formato comprimido. Os blocos sao comprimidos em NumThreads threads,
+/// NumThreads blocos de cada vez.
+///
+
+class SaidaComprimida : public std::ostream {
+private:
+  class Buffer : public std::streambuf {
+  private:
+    std::ofstream ArqO;
+    size_t tam_bloco;
+    int num_threads;
+    // O bloco sendo preenchido e os blocos cheios ainda nao comprimidos
+    std::string atual;
+    std::vector<std::string> cheios;
+    // O indice: posicao no arquivo, tamanho comprimido e original de cada bloco
+    std::vector<uint64_t> posicao;
+    std::vector<uint32_t> tam_comprimido, tam_original;
+    uint64_t total;
+
+    // Passa o bloco atual para a lista de cheios (comprimindo-os, se for o caso)
+    void fecharBloco(bool Forcar);
+    // Comprime e grava os blocos cheios
+    void gravarCheios();
+
+  protected:
+    int_type overflow(int_type c) override;
+
+  public:
+    Buffer();
+    bool abrir(const std::string& Arq, size_t TamBloco, int NumThreads);
+    bool fechar();
+    bool aberto() const;
+  };
+  Buffer buf;
+
+public:
+  // O tamanho padrao dos blocos (texto original)
+  static constexpr size_t TAM_BLOCO_PADRAO = size_t(1)<<20;
+
+  SaidaComprimida();
+  // Abre o arquivo (ver abrir)
+  explicit SaidaComprimida(const std::string& Arq, size_t TamBloco=TAM_BLOCO_PADRAO,
+                           int NumThreads=1);
+  // Fecha o arquivo (fechar)
+  ~SaidaComprimida();
+
+  // Abre o arquivo para escrita. Retorna false se nao puder ser aberto
+  bool abrir(const std::string& Arq, size_t TamBloco=TAM_BLOCO_PADRAO, int NumThreads=1);
+  // Grava os blocos restantes e o indice e fecha o arquivo
+  // Retorna false se houve erro de escrita em algum momento
+  bool fechar();
+  bool aberto() const;
+};
+
+///
+/// CLASSE ARQUIVO COMPRIMIDO
+///
+/// Acesso a um arquivo gravado por SaidaComprimida: o texto original completo
+/// (descomprimido em paralelo), um bloco ou qualquer trecho (acesso aleatorio).
+/// Os metodos de leitura podem ser chamados por varias threads ao mesmo tempo.
+///
+
+class ArquivoComprimido {
+private:
+  mutable std::ifstream ArqI;
+  mutable std::mutex mtx;
+  uint64_t total;
+  // O indice e a posicao no texto original do inicio de cada bloco (mais o fim)
+  std::vector<uint64_t> posicao;
+  std::vector<uint32_t> tam_comprimido, tam_original;
+  std::vector<uint64_t> inicio;
+
+  // Leh os bytes comprimidos do bloco K
+  bool lerComprimido(size_t K, std::string& Dados) const;
+
+public:
+  ArquivoComprimido();
+
+  // Retorna true se o arquivo Arq comeca com a marca do formato comprimido
+  static bool isComprimido(const std::string& Arq);
+
+  // Abre o arquivo e leh o indice. Retorna false se nao for um arquivo valido
+  bool abrir(const std::string& Arq);
+  void fechar();
+  bool aberto() const;
+
+  // O tamanho do texto original e o numero de blocos
+  uint64_t getTamanho() const;
+  size_t getNumBlocos() const;
+  // A posicao do inicio do bloco K no texto original e o seu tamanho original
+  uint64_t getInicioBloco(size_t K) const;
+  size_t getTamanhoBloco(size_t K) const;
+
+  // Descomprime o bloco K em Dados. Retorna false se K for invalido ou o bloco
+  // estiver corrompido
+  bool lerBloco(size_t K, std::string& Dados) const;
+  // Copia para Dados os N bytes do texto original a partir da posicao Pos,
+  // descomprimindo apenas os blocos necessarios. Retorna false se o trecho passar
+  // do fim do texto ou algum bloco estiver corrompido
+  bool ler(uint64_t Pos, size_t N, char* Dados) const;
+  // Descomprime o texto completo em Dados, em NumThreads threads
+  bool descomprimir(std::string& Dados, int NumThreads=1) const;
+};
+
+///
+/// CLASSE ENTRADA COMPRIMIDA
+///
+/// Um std::istream que leh sequencialmente o texto de um arquivo comprimido,
+/// descomprimindo um bloco de cada vez (por exemplo, para Circuito::ler)
+///
+
+class EntradaComprimida : public std::istream {
+private:
+  class Buffer : public std::streambuf {
+  private:
+    ArquivoComprimido arq;
+    std::string bloco;
+    size_t proximo;
+
+  protected:
+    int_type underflow() override;
+
+  public:
+    Buffer();
+    bool abrir(const std::string& Arq);
+  };
+  Buffer buf;
+
+public:
+  EntradaComprimida();
+  explicit EntradaComprimida(const std::string& Arq);
+  // Abre o arquivo. Retorna false se nao for um arquivo comprimido valido
+  bool abrir(const std::string& Arq);
+};
+
+#endif // _COMPRESSAO_H_
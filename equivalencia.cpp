@@ -0,0 +1,207 @@
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "equivalencia.h"
+#include "estimulos.h"
+#include "circuito.h"
+
+///
+/// CLASSE VERIFICADOR DE EQUIVALENCIA
+///
+
+VerificadorEquivalencia::VerificadorEquivalencia():
+  max_exaustivo(16), num_lotes_aleatorio(1<<14), semente(0), num_threads(0),
+  compativeis(false), equivalentes(false), exaustivo(false), num_vetores(0),
+  entrada(), saida(0), valor1(bool3S::UNDEF), valor2(bool3S::UNDEF)
+{
+}
+
+// Configuracao
+void VerificadorEquivalencia::setMaxEntradasExaustivo(int N)
+{
+  if (N>=0 && N<=EnumeradorExaustivo::MAX_ENTRADAS) max_exaustivo = N;
+}
+
+void VerificadorEquivalencia::setNumLotesAleatorio(long N)
+{
+  if (N>0) num_lotes_aleatorio = N;
+}
+
+void VerificadorEquivalencia::setSemente(uint64_t S)
+{
+  semente = S;
+}
+
+// N <= 0: uma thread por processador
+void VerificadorEquivalencia::setNumThreads(int N)
+{
+  num_threads = N;
+}
+
+int VerificadorEquivalencia::getMaxEntradasExaustivo() const
+{
+  return max_exaustivo;
+}
+
+long VerificadorEquivalencia::getNumLotesAleatorio() const
+{
+  return num_lotes_aleatorio;
+}
+
+// Verifica a equivalencia dos circuitos C1 e C2
+// As threads pegam os lotes em ordem crescente (contador atomico); ao encontrar uma
+// diferenca no lote K, as threads deixam de processar lotes posteriores a K, mas os
+// lotes anteriores ainda em andamento terminam (podem ter uma diferenca anterior)
+bool VerificadorEquivalencia::verificar(Circuito& C1, Circuito& C2)
+{
+  compativeis = equivalentes = exaustivo = false;
+  num_vetores = 0;
+  entrada.clear();
+  saida = 0;
+  valor1 = valor2 = bool3S::UNDEF;
+
+  std::shared_ptr<const CircuitoCompilado> P1 = C1.getCompilado();
+  std::shared_ptr<const CircuitoCompilado> P2 = C2.getCompilado();
+  if (!P1 || !P2 || P1->getNumInputs()!=P2->getNumInputs() ||
+      P1->getNumOutputs()!=P2->getNumOutputs()) return false;
+  compativeis = true;
+
+  const int Nin = P1->getNumInputs();
+  const int Nout = P1->getNumOutputs();
+  exaustivo = (Nin<=max_exaustivo);
+  const EnumeradorExaustivo E(exaustivo ? Nin : 0);
+  const GeradorEstimulos Modelo(Nin, semente);
+  const uint64_t NLotes = (exaustivo ? E.getNumLotes() : uint64_t(num_lotes_aleatorio));
+
+  int NThreads = num_threads;
+  if (NThreads<=0) NThreads = std::thread::hardware_concurrency();
+  if (NThreads<=0) NThreads = 1;
+  if (uint64_t(NThreads)>NLotes) NThreads = int(NLotes);
+
+  std::atomic<uint64_t> proximo(0);
+  // O numero do primeiro vetor diferente encontrado (ou NLotes*64, se nenhum)
+  std::atomic<uint64_t> primeiro_erro(NLotes*NUM_PISTAS);
+  std::atomic<uint64_t> testados(0);
+  std::mutex trava;
+
+  auto trabalho = [&]()
+  {
+    // O mesmo buffer de estimulos serve para os dois circuitos
+    std::vector<Lote3S> in_lote(Nin), out1(Nout), out2(Nout);
+    std::vector<Lote3S> sinais1(P1->getNumSinais()), sinais2(P2->getNumSinais());
+    GeradorEstimulos G(Modelo);
+    uint64_t K;
+
+    while ((K = proximo.fetch_add(1)) < NLotes && K*NUM_PISTAS < primeiro_erro.load())
+    {
+      int NPistas = NUM_PISTAS;
+      if (exaustivo) NPistas = E.gerarLote(K, in_lote.data());
+      else
+      {
+        // Cada lote tem a sua propria semente: o lote K eh sempre o mesmo
+        G.reiniciar(semente ^ (K*0x9e3779b97f4a7c15ULL));
+        G.gerarLote(in_lote.data());
+      }
+      P1->simularLote(in_lote.data(), sinais1.data(), out1.data());
+      P2->simularLote(in_lote.data(), sinais2.data(), out2.data());
+      testados += NPistas;
+
+      const uint64_t validas = (NPistas==NUM_PISTAS ? ~uint64_t(0) : (uint64_t(1)<<NPistas)-1);
+      uint64_t difere = 0;
+      for (int j=0; j<Nout; j++) difere |= diferenca(out1[j], out2[j]);
+      difere &= validas;
+      if (difere==0) continue;
+
+      // A primeira pista diferente do lote e a primeira saida diferente nessa pista
+      const int k = __builtin_ctzll(difere);
+      const uint64_t R = K*NUM_PISTAS+k;
+      std::lock_guard<std::mutex> guarda(trava);
+      if (R < primeiro_erro.load())
+      {
+        primeiro_erro = R;
+        entrada.resize(Nin);
+        for (int i=0; i<Nin; i++) entrada[i] = getPista(in_lote[i], k);
+        for (int j=0; j<Nout; j++)
+        {
+          if ((diferenca(out1[j], out2[j])>>k) & 1)
+          {
+            saida = j+1;
+            valor1 = getPista(out1[j], k);
+            valor2 = getPista(out2[j], k);
+            break;
+          }
+        }
+      }
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int t=1; t<NThreads; t++) threads.emplace_back(trabalho);
+  trabalho();
+  for (std::thread& T : threads) T.join();
+
+  num_vetores = testados;
+  equivalentes = (saida==0);
+  return equivalentes;
+}
+
+// Resultado da ultima verificacao
+bool VerificadorEquivalencia::isCompativeis() const
+{
+  return compativeis;
+}
+
+bool VerificadorEquivalencia::isEquivalentes() const
+{
+  return equivalentes;
+}
+
+bool VerificadorEquivalencia::isExaustivo() const
+{
+  return exaustivo;
+}
+
+uint64_t VerificadorEquivalencia::getNumVetores() const
+{
+  return num_vetores;
+}
+
+const std::vector<bool3S>& VerificadorEquivalencia::getEntradaDiferente() const
+{
+  return entrada;
+}
+
+int VerificadorEquivalencia::getSaidaDiferente() const
+{
+  return saida;
+}
+
+bool3S VerificadorEquivalencia::getValor1() const
+{
+  return valor1;
+}
+
+bool3S VerificadorEquivalencia::getValor2() const
+{
+  return valor2;
+}
+
+// Imprime o resultado da ultima verificacao
+std::ostream& VerificadorEquivalencia::imprimir(std::ostream& O) const
+{
+  if (!compativeis)
+  {
+    O << "Circuitos invalidos ou com numeros de entradas/saidas diferentes\n";
+    return O;
+  }
+  if (equivalentes)
+  {
+    O << "Circuitos equivalentes (" << num_vetores << " vetores testados, "
+      << (exaustivo ? "todas as combinacoes" : "vetores aleatorios") << ")\n";
+    return O;
+  }
+  O << "Circuitos diferentes. Entradas:";
+  for (bool3S x : entrada) O << ' ' << x;
+  O << " -> saida " << saida << ": " << valor1 << " x " << valor2 << '\n';
+  return O;
+}
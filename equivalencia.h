@@ -0,0 +1,80 @@
+#ifndef _EQUIVALENCIA_H_
+#define _EQUIVALENCIA_H_
+
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+
+class Circuito;
+
+///
+/// CLASSE VERIFICADOR DE EQUIVALENCIA
+///
+/// Verifica se dois circuitos com o mesmo numero de entradas e de saidas calculam as
+/// mesmas saidas (inclusive os valores ?) para os mesmos vetores de entrada.
+/// Os dois circuitos sao simulados lado a lado, 64 vetores por vez, a partir do
+/// mesmo buffer de estimulos (gerado uma unica vez para os dois), por varias threads.
+/// - Se o numero de entradas nao passar de getMaxEntradasExaustivo(), todas as
+///   3^Nin combinacoes sao testadas (EnumeradorExaustivo) e o resultado eh exato;
+/// - caso contrario, sao testados getNumLotesAleatorio() lotes de 64 vetores
+///   aleatorios (GeradorEstimulos); o resultado "equivalentes" eh apenas provavel.
+/// A verificacao para na primeira diferenca: eh informada a diferenca de menor numero
+/// de vetor (o resultado nao depende do numero de threads).
+///
+
+class VerificadorEquivalencia {
+private:
+  // Configuracao
+  int max_exaustivo;
+  long num_lotes_aleatorio;
+  uint64_t semente;
+  int num_threads;
+
+  // Resultado da ultima verificacao
+  bool compativeis;
+  bool equivalentes;
+  bool exaustivo;
+  uint64_t num_vetores;
+  std::vector<bool3S> entrada;
+  int saida;
+  bool3S valor1, valor2;
+
+public:
+  // Configuracao padrao: exaustivo ateh 16 entradas, 2^14 lotes aleatorios,
+  // semente 0 e uma thread por processador
+  VerificadorEquivalencia();
+
+  // Configuracao
+  void setMaxEntradasExaustivo(int N);
+  void setNumLotesAleatorio(long N);
+  void setSemente(uint64_t S);
+  void setNumThreads(int N);
+  int getMaxEntradasExaustivo() const;
+  long getNumLotesAleatorio() const;
+
+  // Verifica a equivalencia dos circuitos C1 e C2
+  // Retorna true se nenhuma diferenca foi encontrada; false se ha diferenca ou se os
+  // circuitos nao sao compativeis (invalidos ou com numeros de entradas/saidas diferentes)
+  bool verificar(Circuito& C1, Circuito& C2);
+
+  // Resultado da ultima verificacao
+  // Se os circuitos eram validos e com os mesmos numeros de entradas e saidas
+  bool isCompativeis() const;
+  // Se nenhuma diferenca foi encontrada
+  bool isEquivalentes() const;
+  // Se todas as combinacoes de entradas foram testadas
+  bool isExaustivo() const;
+  // O numero de vetores testados
+  uint64_t getNumVetores() const;
+  // A primeira diferenca encontrada (caso nao equivalentes): o vetor de entrada,
+  // a id da saida (1 a Nout) e os valores dessa saida em C1 e em C2
+  const std::vector<bool3S>& getEntradaDiferente() const;
+  int getSaidaDiferente() const;
+  bool3S getValor1() const;
+  bool3S getValor2() const;
+
+  // Imprime o resultado da ultima verificacao
+  std::ostream& imprimir(std::ostream& O=std::cout) const;
+};
+
+#endif // _EQUIVALENCIA_H_
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include "escritor.h"
+#include "modulo.h"
+
+///
+/// CLASSE ESCRITOR DE CIRCUITO
+///
+
+EscritorCircuito::EscritorCircuito(int NumThreads, size_t TamBloco):
+  num_threads(NumThreads), tam_bloco(std::max<size_t>(TamBloco,4096))
+{
+  if (num_threads<=0) num_threads = std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+/// ***********************
+/// Formatacao
+/// ***********************
+
+namespace {
+  // Os pares de digitos de 00 a 99
+  struct TabelaDigitos {
+    char d[200];
+    TabelaDigitos()
+    {
+      for (int i=0; i<100; i++)
+      {
+        d[2*i] = char('0'+i/10);
+        d[2*i+1] = char('0'+i%10);
+      }
+    }
+  };
+  const TabelaDigitos DIGITOS;
+
+  // O maior numero de caracteres de um inteiro (com sinal)
+  const size_t MAX_INTEIRO = 11;
+
+  // Escreve o inteiro V a partir de p e retorna a posicao seguinte
+  inline char* escreverInteiro(char* p, int V)
+  {
+    uint32_t u = uint32_t(V);
+    if (V<0)
+    {
+      *p++ = '-';
+      u = 0u-u;
+    }
+    // Os digitos sao gerados do fim para o inicio, 2 de cada vez
+    char prov[10];
+    char* q = prov+10;
+    while (u>=100)
+    {
+      const uint32_t r = u%100;
+      u /= 100;
+      q -= 2;
+      std::memcpy(q, DIGITOS.d+2*r, 2);
+    }
+    if (u>=10)
+    {
+      q -= 2;
+      std::memcpy(q, DIGITOS.d+2*u, 2);
+    }
+    else *--q = char('0'+u);
+    const size_t n = prov+10-q;
+    std::memcpy(p, q, n);
+    return p+n;
+  }
+}
+
+// Formata as linhas "id) TIPO N: id1 id2 ..." das portas I0 a I1-1
+// O texto cresce (dobrando) soh quando o espaco restante nao garante a proxima linha
+void EscritorCircuito::formatarPortas(const Circuito& C, int I0, int I1, std::string& Texto)
+{
+  const Circuito::Portas& P = *C.portas;
+  if (Texto.size()<4096) Texto.resize(4096);
+  size_t pos = 0;
+  for (int i=I0; i<I1; i++)
+  {
+    const int N = P.num_in[i];
+    std::string nome;
+    const char* sigla;
+    size_t tam_sigla;
+    if (P.tipo[i]==CODIGO_INSTANCIA)
+    {
+      // As instancias de modulos (raras) tem o nome completo
+      nome = C.getNamePort(i+1);
+      sigla = nome.c_str();
+      tam_sigla = nome.size();
+    }
+    else
+    {
+      sigla = RegistroPortas::getSigla(P.tipo[i]);
+      tam_sigla = 2;
+    }
+
+    const size_t maximo = 2*MAX_INTEIRO+tam_sigla+6 + size_t(N)*(MAX_INTEIRO+1);
+    if (Texto.size()-pos<maximo) Texto.resize(std::max(2*Texto.size(), pos+maximo));
+    char* const ini = &Texto[0];
+    char* p = ini+pos;
+    p = escreverInteiro(p, i+1);
+    *p++ = ')';
+    *p++ = ' ';
+    std::memcpy(p, sigla, tam_sigla);
+    p += tam_sigla;
+    *p++ = ' ';
+    p = escreverInteiro(p, N);
+    *p++ = ':';
+    const int* id = P.id_in.data()+P.ini_in[i];
+    for (int j=0; j<N; j++)
+    {
+      *p++ = ' ';
+      p = escreverInteiro(p, id[j]);
+    }
+    *p++ = '\n';
+    pos = p-ini;
+  }
+  // Mantem a capacidade do texto para o proximo bloco: soh o tamanho muda
+  Texto.resize(pos);
+}
+
+/// ***********************
+/// Escrita
+/// ***********************
+
+// Escreve o corpo do circuito C
+// Os limites dos blocos sao escolhidos pela estimativa de bytes de cada porta; os
+// blocos sao formatados em grupos de num_threads, e o grupo g eh gravado (em outra
+// thread) enquanto o grupo g+1 eh formatado, cada um no seu conjunto de blocos
+void EscritorCircuito::escreverCorpo(const Circuito& C, std::ostream& O) const
+{
+  const int NP = C.getNumPorts();
+  O << "CIRCUITO " << C.getNumInputs() << ' ' << C.getNumOutputs() << ' ' << NP << '\n';
+  O << "PORTAS\n";
+
+  // Os limites dos blocos
+  std::vector<int> limite(1,0);
+  size_t estimativa = 0;
+  for (int i=0; i<NP; i++)
+  {
+    estimativa += 12 + 8*size_t(C.portas->num_in[i]);
+    if (estimativa>=tam_bloco)
+    {
+      limite.push_back(i+1);
+      estimativa = 0;
+    }
+  }
+  if (limite.back()!=NP) limite.push_back(NP);
+  const int NB = int(limite.size())-1;
+
+  if (NB<=1 || num_threads<=1)
+  {
+    // Um bloco de cada vez, na propria thread
+    std::string texto;
+    for (int b=0; b<NB; b++)
+    {
+      formatarPortas(C, limite[b], limite[b+1], texto);
+      O.write(texto.data(), texto.size());
+    }
+  }
+  else
+  {
+    const int T = std::min(num_threads, NB);
+    std::vector<std::string> blocos(2*T);
+    std::thread escrita;
+    for (int b0=0, g=0; b0<NB; b0+=T, g^=1)
+    {
+      const int nb = std::min(T, NB-b0);
+      // Os blocos deste conjunto foram gravados dois grupos atras: a gravacao jah
+      // terminou, pois a do grupo anterior soh comecou depois dela
+      std::string* const B = blocos.data()+g*T;
+      std::vector<std::thread> threads;
+      for (int t=1; t<nb; t++)
+      {
+        threads.emplace_back([&C, &limite, B, b0, t]()
+        {
+          formatarPortas(C, limite[b0+t], limite[b0+t+1], B[t]);
+        });
+      }
+      formatarPortas(C, limite[b0], limite[b0+1], B[0]);
+      for (std::thread& th : threads) th.join();
+
+      // Este grupo foi formatado enquanto o anterior era gravado
+      if (escrita.joinable()) escrita.join();
+      escrita = std::thread([&O, B, nb]()
+      {
+        for (int t=0; t<nb; t++) O.write(B[t].data(), B[t].size());
+      });
+    }
+    if (escrita.joinable()) escrita.join();
+  }
+
+  // As saidas (poucas, em geral), pelo mesmo formatador de inteiros
+  O << "SAIDAS\n";
+  char linha[2*MAX_INTEIRO+4];
+  for (int i=0; i<C.getNumOutputs(); i++)
+  {
+    char* p = escreverInteiro(linha, i+1);
+    *p++ = ')';
+    *p++ = ' ';
+    p = escreverInteiro(p, C.id_out[i]);
+    *p++ = '\n';
+    O.write(linha, p-linha);
+  }
+}
+
+// Escreve o circuito C em O
+bool EscritorCircuito::escrever(const Circuito& C, std::ostream& O) const
+{
+  if (!C.valid()) return false;
+
+  for (const ptr_Modulo& M : C.modulos)
+  {
+    O << "MODULO " << M->getNome() << '\n';
+    escreverCorpo(M->getCircuito(), O);
+    O << "FIM\n";
+  }
+  escreverCorpo(C, O);
+  if (!C.atrasos.empty())
+  {
+    O << "ATRASOS\n";
+    for (const auto& A : C.atrasos) O << A.first << ' ' << A.second << '\n';
+  }
+  return O.good();
+}
+
+// Escreve o circuito C no arquivo Arq
+bool EscritorCircuito::salvar(const Circuito& C, const std::string& Arq) const
+{
+  if (!C.valid()) return false;
+
+  std::ofstream ArqO(Arq);
+  if (!ArqO.is_open()) return false;
+  if (!escrever(C, ArqO)) return false;
+  ArqO.close();
+  return !ArqO.fail();
+}
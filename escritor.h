@@ -0,0 +1,52 @@
+#ifndef _ESCRITOR_H_
+#define _ESCRITOR_H_
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "circuito.h"
+
+///
+/// CLASSE ESCRITOR DE CIRCUITO
+///
+/// Escreve um circuito no formato de Circuito::ler (o mesmo texto de
+/// Circuito::imprimir) sem passar pelos operadores << de ostream:
+/// - as linhas das portas sao formatadas direto em blocos de texto (um numero eh
+///   convertido de 2 em 2 digitos, por consulta a uma tabela, e o tipo vem da sigla
+///   interna de RegistroPortas, sem criar strings);
+/// - cada bloco tem cerca de TamBloco bytes, e os blocos de um circuito grande sao
+///   formatados em paralelo, NumThreads de cada vez, enquanto o grupo anterior eh
+///   gravado na stream por outra thread;
+/// - os blocos sao reaproveitados de um grupo para o seguinte: depois dos primeiros
+///   grupos, nao ha alocacao de memoria.
+/// Eh usado por Circuito::imprimir, salvar e salvarComprimido.
+///
+
+class EscritorCircuito {
+public:
+  // O tamanho aproximado padrao dos blocos de texto
+  static constexpr size_t TAM_BLOCO_PADRAO = size_t(1)<<20;
+
+private:
+  int num_threads;
+  size_t tam_bloco;
+
+  // Formata em Texto (substituindo o conteudo) as linhas das portas de indice I0 a
+  // I1-1 do circuito C
+  static void formatarPortas(const Circuito& C, int I0, int I1, std::string& Texto);
+  // Escreve o corpo de C (da linha CIRCUITO ateh a secao SAIDAS) em O
+  void escreverCorpo(const Circuito& C, std::ostream& O) const;
+
+public:
+  // NumThreads: o numero de threads de formatacao (0: uma por processador)
+  explicit EscritorCircuito(int NumThreads=0, size_t TamBloco=TAM_BLOCO_PADRAO);
+
+  // Escreve o circuito C em O: os modulos, o circuito e a secao ATRASOS
+  // Retorna false se o circuito nao for valido ou se houver erro de escrita
+  bool escrever(const Circuito& C, std::ostream& O) const;
+  // Escreve o circuito C no arquivo Arq
+  bool salvar(const Circuito& C, const std::string& Arq) const;
+};
+
+#endif // _ESCRITOR_H_
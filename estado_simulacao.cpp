@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include "estado_simulacao.h"
+
+///
+/// ESTADO DE SIMULACAO
+///
+
+EstadoSimulacao::EstadoSimulacao():
+  tempo(0), num_eventos(0), sinais(), projetado(), eventos()
+{
+}
+
+void EstadoSimulacao::clear()
+{
+  tempo = 0;
+  num_eventos = 0;
+  sinais.clear();
+  projetado.clear();
+  eventos.clear();
+}
+
+// Formato: a marca "EST3SIM\0", o cabecalho (tempo, num_eventos, numero de sinais,
+// de portas projetadas e de eventos), as palavras de sinais e de projetado e, para
+// cada evento, duas palavras: o instante e (IP<<2 | valor)
+static const char MARCA_ESTADO[8] = {'E','S','T','3','S','I','M','\0'};
+
+bool EstadoSimulacao::salvar(const std::string& Arq) const
+{
+  std::ofstream ArqO(Arq, std::ios::binary);
+  if (!ArqO.is_open()) return false;
+
+  const uint64_t cabecalho[5] = {uint64_t(tempo), num_eventos, sinais.size(),
+                                 projetado.size(), eventos.size()};
+  ArqO.write(MARCA_ESTADO, 8);
+  ArqO.write(reinterpret_cast<const char*>(cabecalho), sizeof(cabecalho));
+  ArqO.write(reinterpret_cast<const char*>(sinais.data()), sinais.getNumPalavras()*sizeof(uint64_t));
+  ArqO.write(reinterpret_cast<const char*>(projetado.data()), projetado.getNumPalavras()*sizeof(uint64_t));
+  std::vector<uint64_t> ev(2*eventos.size());
+  for (size_t k=0; k<eventos.size(); k++)
+  {
+    ev[2*k] = uint64_t(eventos[k].tempo);
+    ev[2*k+1] = (uint64_t(eventos[k].IP)<<2) | uint64_t(eventos[k].valor);
+  }
+  ArqO.write(reinterpret_cast<const char*>(ev.data()), ev.size()*sizeof(uint64_t));
+  return ArqO.good();
+}
+
+// Leh NV valores compactados de ArqI para V
+static bool lerCompacto(std::istream& ArqI, size_t NV, VetorCompacto3S& V)
+{
+  V.resize(NV);
+  std::vector<uint64_t> P(V.getNumPalavras());
+  ArqI.read(reinterpret_cast<char*>(P.data()), P.size()*sizeof(uint64_t));
+  if (!ArqI.good()) return false;
+  for (size_t W=0; W<P.size(); W++) V.setPalavra(W, P[W]);
+  return true;
+}
+
+bool EstadoSimulacao::ler(const std::string& Arq)
+{
+  std::ifstream ArqI(Arq, std::ios::binary);
+  if (!ArqI.is_open()) return false;
+
+  char marca[8];
+  uint64_t cabecalho[5];
+  ArqI.read(marca, 8);
+  ArqI.read(reinterpret_cast<char*>(cabecalho), sizeof(cabecalho));
+  if (!ArqI.good() || std::memcmp(marca, MARCA_ESTADO, 8)!=0) return false;
+  // Dimensoes absurdas indicam um arquivo corrompido
+  const uint64_t LIMITE = uint64_t(1)<<40;
+  if (cabecalho[2]>LIMITE || cabecalho[3]>LIMITE || cabecalho[4]>LIMITE) return false;
+
+  EstadoSimulacao E;
+  E.tempo = long(cabecalho[0]);
+  E.num_eventos = cabecalho[1];
+  if (!lerCompacto(ArqI, cabecalho[2], E.sinais)) return false;
+  if (!lerCompacto(ArqI, cabecalho[3], E.projetado)) return false;
+  std::vector<uint64_t> ev(2*cabecalho[4]);
+  ArqI.read(reinterpret_cast<char*>(ev.data()), ev.size()*sizeof(uint64_t));
+  if (!ArqI.good()) return false;
+  E.eventos.resize(cabecalho[4]);
+  for (size_t k=0; k<E.eventos.size(); k++)
+  {
+    const int valor = ev[2*k+1] & 3;
+    if (valor==3) return false;
+    E.eventos[k] = EventoPendente{long(ev[2*k]), int(ev[2*k+1]>>2), bool3S(valor)};
+  }
+  *this = std::move(E);
+  return true;
+}
+
+///
+/// CLASSE HISTORICO DE ESTADOS
+///
+
+HistoricoEstados::HistoricoEstados(int IntervaloChave):
+  intervalo(std::max(1,IntervaloChave)), registros(), ultimo()
+{
+}
+
+// As palavras de sinais seguidas das de projetado
+static void juntarPalavras(const EstadoSimulacao& E, std::vector<uint64_t>& Palavras)
+{
+  const size_t NS = E.sinais.getNumPalavras();
+  Palavras.resize(NS+E.projetado.getNumPalavras());
+  std::copy(E.sinais.data(), E.sinais.data()+NS, Palavras.begin());
+  std::copy(E.projetado.data(), E.projetado.data()+E.projetado.getNumPalavras(),
+            Palavras.begin()+NS);
+}
+
+size_t HistoricoEstados::adicionar(const EstadoSimulacao& E)
+{
+  std::vector<uint64_t> atual;
+  juntarPalavras(E, atual);
+
+  Registro R;
+  R.tempo = E.tempo;
+  R.num_eventos = E.num_eventos;
+  R.num_sinais = E.sinais.size();
+  R.num_projetado = E.projetado.size();
+  R.eventos = E.eventos;
+  R.chave = (registros.size()%intervalo==0 || registros.back().num_sinais!=R.num_sinais ||
+             registros.back().num_projetado!=R.num_projetado);
+
+  if (!R.chave)
+  {
+    // As sequencias de palavras alteradas
+    const size_t NW = atual.size();
+    size_t W = 0;
+    while (W<NW && R.dados.size()<NW)
+    {
+      size_t ini = W;
+      while (W<NW && atual[W]==ultimo[W]) W++;
+      if (W==NW) break;
+      const size_t puladas = W-ini;
+      ini = W;
+      while (W<NW && atual[W]!=ultimo[W]) W++;
+      R.dados.push_back((uint64_t(puladas)<<32) | uint64_t(W-ini));
+      for (size_t k=ini; k<W; k++) R.dados.push_back(atual[k]^ultimo[k]);
+    }
+    // O delta nao compensa: guarda o estado completo
+    if (R.dados.size()>=NW) R.chave = true;
+  }
+  if (R.chave) R.dados = atual;
+  R.dados.shrink_to_fit();
+
+  registros.push_back(std::move(R));
+  ultimo.swap(atual);
+  return registros.size()-1;
+}
+
+void HistoricoEstados::reconstruir(size_t K, std::vector<uint64_t>& Palavras) const
+{
+  size_t base = K;
+  while (!registros[base].chave) base--;
+  Palavras = registros[base].dados;
+  for (size_t r=base+1; r<=K; r++)
+  {
+    const std::vector<uint64_t>& D = registros[r].dados;
+    size_t W = 0;
+    for (size_t k=0; k<D.size(); )
+    {
+      W += D[k]>>32;
+      const size_t alteradas = D[k] & 0xFFFFFFFF;
+      k++;
+      for (size_t j=0; j<alteradas; j++) Palavras[W++] ^= D[k++];
+    }
+  }
+}
+
+bool HistoricoEstados::obter(size_t K, EstadoSimulacao& E) const
+{
+  if (K>=registros.size()) return false;
+  const Registro& R = registros[K];
+  std::vector<uint64_t> P;
+  reconstruir(K, P);
+
+  E.tempo = R.tempo;
+  E.num_eventos = R.num_eventos;
+  E.sinais.resize(R.num_sinais);
+  E.projetado.resize(R.num_projetado);
+  const size_t NS = E.sinais.getNumPalavras();
+  for (size_t W=0; W<NS; W++) E.sinais.setPalavra(W, P[W]);
+  for (size_t W=0; W<E.projetado.getNumPalavras(); W++) E.projetado.setPalavra(W, P[NS+W]);
+  E.eventos = R.eventos;
+  return true;
+}
+
+void HistoricoEstados::truncar(size_t N)
+{
+  if (N>=registros.size()) return;
+  registros.resize(N);
+  if (N>0) reconstruir(N-1, ultimo);
+  else ultimo.clear();
+}
+
+void HistoricoEstados::clear()
+{
+  registros.clear();
+  ultimo.clear();
+}
+
+size_t HistoricoEstados::size() const
+{
+  return registros.size();
+}
+
+size_t HistoricoEstados::getNumBytes() const
+{
+  size_t N = 0;
+  for (const Registro& R : registros)
+  {
+    N += sizeof(Registro) + R.dados.capacity()*sizeof(uint64_t)
+       + R.eventos.capacity()*sizeof(EstadoSimulacao::EventoPendente);
+  }
+  return N;
+}
@@ -0,0 +1,105 @@
+#ifndef _ESTADO_SIMULACAO_H_
+#define _ESTADO_SIMULACAO_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "vetor_compacto3S.h"
+
+///
+/// ESTADO DE SIMULACAO (ponto de restauracao)
+///
+/// Guarda de forma compacta (2 bits por valor, VetorCompacto3S) o estado completo de
+/// uma simulacao, para ser restaurado mais tarde ou usado como ponto de partida de
+/// varias continuacoes diferentes:
+/// - de um Circuito (Circuito::salvarEstado): os valores de todos os sinais;
+/// - de uma SimulacaoTemporizada (SimulacaoTemporizada::salvarEstado): tambem o
+///   instante atual, os valores projetados das portas e os eventos pendentes.
+/// Pode ser gravado em um arquivo binario (salvar) e lido de volta (ler), por
+/// exemplo para continuar uma simulacao longa depois de uma falha.
+///
+
+struct EstadoSimulacao {
+  // Um evento pendente: a saida da porta de indice IP passa a ser valor no instante tempo
+  struct EventoPendente {
+    long tempo;
+    int IP;
+    bool3S valor;
+  };
+
+  // O instante e o numero de eventos jah processados (simulacao temporizada)
+  long tempo;
+  uint64_t num_eventos;
+  // Os valores de todos os sinais (indexados por CircuitoCompilado::indiceSinal)
+  VetorCompacto3S sinais;
+  // O ultimo valor agendado para cada porta (vazio para um Circuito)
+  VetorCompacto3S projetado;
+  // Os eventos pendentes, na ordem em que seriam processados
+  std::vector<EventoPendente> eventos;
+
+  EstadoSimulacao();
+  void clear();
+
+  // Grava o estado em um arquivo binario / leh de um arquivo gravado por salvar
+  // Retornam false em caso de erro (ler nao altera o estado)
+  bool salvar(const std::string& Arq) const;
+  bool ler(const std::string& Arq);
+};
+
+///
+/// CLASSE HISTORICO DE ESTADOS
+///
+/// Guarda em memoria uma sequencia de estados (por exemplo, um a cada N vetores de
+/// uma simulacao longa) com compressao delta: em geral, poucos sinais mudam entre
+/// dois estados consecutivos, e cada estado eh guardado apenas como as palavras (de
+/// 32 valores) que mudaram em relacao ao anterior, em sequencias de
+/// (palavras iguais puladas, palavras alteradas). A cada IntervaloChave estados (e
+/// quando o delta nao for menor), o estado eh guardado completo: recuperar um estado
+/// aplica no maximo IntervaloChave-1 deltas.
+/// Os estados devem ser do mesmo circuito (mesmo numero de sinais e portas); um
+/// estado com outras dimensoes eh sempre guardado completo.
+///
+
+class HistoricoEstados {
+private:
+  // Um estado guardado: completo (chave) ou como delta do anterior
+  struct Registro {
+    bool chave;
+    long tempo;
+    uint64_t num_eventos;
+    size_t num_sinais, num_projetado;
+    // Chave: as palavras de sinais seguidas das de projetado
+    // Delta: para cada sequencia, uma palavra com (puladas<<32 | alteradas),
+    // seguida dos XOR das palavras alteradas com as do estado anterior
+    std::vector<uint64_t> dados;
+    std::vector<EstadoSimulacao::EventoPendente> eventos;
+  };
+
+  int intervalo;
+  std::vector<Registro> registros;
+  // As palavras do ultimo estado adicionado (base do proximo delta)
+  std::vector<uint64_t> ultimo;
+
+  // As palavras (sinais seguidos de projetado) do estado de indice K
+  void reconstruir(size_t K, std::vector<uint64_t>& Palavras) const;
+
+public:
+  // Historico vazio, com um estado completo a cada IntervaloChave estados (>= 1)
+  explicit HistoricoEstados(int IntervaloChave=64);
+
+  // Adiciona um estado ao final do historico; retorna o seu indice
+  size_t adicionar(const EstadoSimulacao& E);
+  // Recupera o estado de indice K (0 a size()-1). Retorna false se K for invalido
+  bool obter(size_t K, EstadoSimulacao& E) const;
+  // Descarta os estados a partir do indice N (para seguir outra continuacao)
+  void truncar(size_t N);
+
+  void clear();
+  size_t size() const;
+  // A memoria ocupada pelos estados guardados, em bytes
+  size_t getNumBytes() const;
+};
+
+#endif // _ESTADO_SIMULACAO_H_
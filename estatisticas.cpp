@@ -0,0 +1,227 @@
+#include <fstream>
+#include <thread>
+#include "estatisticas.h"
+#include "estimulos.h"
+#include "circuito.h"
+
+///
+/// CLASSE ESTATISTICAS DE SINAIS
+///
+
+EstatisticasSinais::EstatisticasSinais():
+  Nin(0), NS(0), idx_out(), Nvet(0), nT(), nF(), mudancas(), transicoes(), primeiro(), ultimo()
+{
+}
+
+EstatisticasSinais::EstatisticasSinais(const CircuitoCompilado& P):
+  EstatisticasSinais()
+{
+  iniciar(P);
+}
+
+// Prepara (zera) os contadores para os sinais do circuito compilado P
+void EstatisticasSinais::iniciar(const CircuitoCompilado& P)
+{
+  Nin = P.getNumInputs();
+  NS = P.getNumSinais();
+  idx_out.resize(P.getNumOutputs());
+  for (int j=0; j<P.getNumOutputs(); j++) idx_out[j] = P.getIndiceSaida(j);
+  Nvet = 0;
+  nT.assign(NS,0);
+  nF.assign(NS,0);
+  mudancas.assign(NS,0);
+  transicoes.assign(NS,0);
+  primeiro.assign(NS,bool3S::UNDEF);
+  ultimo.assign(NS,bool3S::UNDEF);
+}
+
+// Acumula os valores de todos os sinais de um vetor simulado
+void EstatisticasSinais::acumular(const bool3S* sinais)
+{
+  if (sinais==nullptr) return;
+  for (int s=0; s<NS; s++)
+  {
+    const bool3S x = sinais[s];
+    if (x==bool3S::TRUE) nT[s]++;
+    else if (x==bool3S::FALSE) nF[s]++;
+    if (Nvet==0) primeiro[s] = x;
+    else if (x!=ultimo[s])
+    {
+      mudancas[s]++;
+      if (x!=bool3S::UNDEF && ultimo[s]!=bool3S::UNDEF) transicoes[s]++;
+    }
+    ultimo[s] = x;
+  }
+  Nvet++;
+}
+
+void EstatisticasSinais::acumular(const Circuito& C)
+{
+  acumular(C.getSinais());
+}
+
+// Acumula NPistas vetores simulados em paralelo
+// A pista anterior a cada pista k eh obtida deslocando as palavras de 1 bit,
+// com o ultimo valor acumulado no lugar da pista 0
+void EstatisticasSinais::acumularLote(const Lote3S* sinais, int NPistas)
+{
+  if (NPistas<=0) return;
+  if (NPistas>NUM_PISTAS) NPistas = NUM_PISTAS;
+
+  const uint64_t validas = (NPistas==NUM_PISTAS ? ~uint64_t(0) : (uint64_t(1)<<NPistas)-1);
+  // No primeiro vetor acumulado nao ha mudanca
+  const uint64_t comparar = (Nvet==0 ? validas & ~uint64_t(1) : validas);
+
+  for (int s=0; s<NS; s++)
+  {
+    const Lote3S x = sinais[s];
+    const Lote3S anterior = {(x.t<<1) | (ultimo[s]==bool3S::TRUE),
+                             (x.f<<1) | (ultimo[s]==bool3S::FALSE)};
+    nT[s] += __builtin_popcountll(x.t & validas);
+    nF[s] += __builtin_popcountll(x.f & validas);
+    mudancas[s] += __builtin_popcountll(diferenca(x,anterior) & comparar);
+    transicoes[s] += __builtin_popcountll(((x.t & anterior.f) | (x.f & anterior.t)) & comparar);
+    if (Nvet==0) primeiro[s] = getPista(x,0);
+    ultimo[s] = getPista(x,NPistas-1);
+  }
+  Nvet += NPistas;
+}
+
+// Acrescenta os contadores de E (cuja sequencia vem logo apos a deste objeto)
+bool EstatisticasSinais::combinar(const EstatisticasSinais& E)
+{
+  if (E.NS!=NS || E.Nin!=Nin) return false;
+  if (E.Nvet==0) return true;
+  if (Nvet==0)
+  {
+    *this = E;
+    return true;
+  }
+  for (int s=0; s<NS; s++)
+  {
+    nT[s] += E.nT[s];
+    nF[s] += E.nF[s];
+    mudancas[s] += E.mudancas[s];
+    transicoes[s] += E.transicoes[s];
+    if (E.primeiro[s]!=ultimo[s])
+    {
+      mudancas[s]++;
+      if (E.primeiro[s]!=bool3S::UNDEF && ultimo[s]!=bool3S::UNDEF) transicoes[s]++;
+    }
+    ultimo[s] = E.ultimo[s];
+  }
+  Nvet += E.Nvet;
+  return true;
+}
+
+// Consultas
+int EstatisticasSinais::getNumSinais() const
+{
+  return NS;
+}
+
+uint64_t EstatisticasSinais::getNumVetores() const
+{
+  return Nvet;
+}
+
+uint64_t EstatisticasSinais::getNumTrue(int S) const
+{
+  return nT.at(S);
+}
+
+uint64_t EstatisticasSinais::getNumFalse(int S) const
+{
+  return nF.at(S);
+}
+
+uint64_t EstatisticasSinais::getNumUndef(int S) const
+{
+  return Nvet-nT.at(S)-nF.at(S);
+}
+
+uint64_t EstatisticasSinais::getNumMudancas(int S) const
+{
+  return mudancas.at(S);
+}
+
+uint64_t EstatisticasSinais::getNumTransicoes(int S) const
+{
+  return transicoes.at(S);
+}
+
+// Exporta um relatorio CSV
+bool EstatisticasSinais::salvarCSV(const std::string& Arq) const
+{
+  std::ofstream ArqO(Arq);
+  if (!ArqO.is_open()) return false;
+
+  const double N = (Nvet>0 ? double(Nvet) : 1.0);
+  const double NT = (Nvet>1 ? double(Nvet-1) : 1.0);
+  // Uma linha do relatorio para o sinal S
+  auto linha = [&](const std::string& Nome, int S)
+  {
+    ArqO << Nome << ',' << nT[S] << ',' << nF[S] << ',' << getNumUndef(S) << ','
+         << nT[S]/N << ',' << nF[S]/N << ',' << getNumUndef(S)/N << ','
+         << mudancas[S] << ',' << transicoes[S] << ',' << transicoes[S]/NT << '\n';
+  };
+
+  ArqO << "sinal,num_T,num_F,num_U,prob_T,prob_F,prob_U,mudancas,transicoes,atividade\n";
+  for (int s=0; s<NS; s++)
+  {
+    linha((s<Nin ? "E" + std::to_string(s+1) : "P" + std::to_string(s-Nin+1)), s);
+  }
+  for (size_t j=0; j<idx_out.size(); j++) linha("S" + std::to_string(j+1), idx_out[j]);
+  return ArqO.good();
+}
+
+// Exporta os contadores em formato binario
+bool EstatisticasSinais::salvarBinario(const std::string& Arq) const
+{
+  std::ofstream ArqO(Arq, std::ios::binary);
+  if (!ArqO.is_open()) return false;
+
+  const uint64_t cabecalho[3] = {uint64_t(Nin), uint64_t(NS), Nvet};
+  ArqO.write("EST3S\0\0\0", 8);
+  ArqO.write(reinterpret_cast<const char*>(cabecalho), sizeof(cabecalho));
+  for (const std::vector<uint64_t>* V : {&nT, &nF, &mudancas, &transicoes})
+  {
+    ArqO.write(reinterpret_cast<const char*>(V->data()), V->size()*sizeof(uint64_t));
+  }
+  return ArqO.good();
+}
+
+// Simula NLotes lotes de 64 vetores aleatorios em NThreads threads
+// Cada thread acumula as suas estatisticas separadamente; elas sao combinadas
+// na ordem das threads ao final
+EstatisticasSinais EstatisticasSinais::simularAleatorio(Circuito& C, const GeradorEstimulos& Modelo,
+                                                        uint64_t Semente, long NLotes, int NThreads)
+{
+  std::shared_ptr<const CircuitoCompilado> P = C.getCompilado();
+  if (!P || Modelo.getNumInputs()!=P->getNumInputs()) return EstatisticasSinais();
+  if (NThreads<1) NThreads = 1;
+
+  std::vector<EstatisticasSinais> parcial(NThreads, EstatisticasSinais(*P));
+  auto trabalho = [&](int t)
+  {
+    const long NL = NLotes/NThreads + (t<NLotes%NThreads ? 1 : 0);
+    GeradorEstimulos G(Modelo);
+    std::vector<Lote3S> in_lote(P->getNumInputs()), sinais_lote(P->getNumSinais()),
+                        out_lote(P->getNumOutputs());
+    G.reiniciar(Semente, t);
+    for (long k=0; k<NL; k++)
+    {
+      G.gerarLote(in_lote.data());
+      P->simularLote(in_lote.data(), sinais_lote.data(), out_lote.data());
+      parcial[t].acumularLote(sinais_lote.data());
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int t=1; t<NThreads; t++) threads.emplace_back(trabalho, t);
+  trabalho(0);
+  for (std::thread& T : threads) T.join();
+
+  for (int t=1; t<NThreads; t++) parcial[0].combinar(parcial[t]);
+  return parcial[0];
+}
@@ -0,0 +1,85 @@
+#ifndef _ESTATISTICAS_H_
+#define _ESTATISTICAS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "lote3S.h"
+#include "circuito_compilado.h"
+
+class Circuito;
+class GeradorEstimulos;
+
+///
+/// CLASSE ESTATISTICAS DE SINAIS
+///
+/// Acumula, para cada sinal do circuito (entradas e saidas das portas), ao longo de
+/// uma sequencia de vetores simulados:
+/// - em quantos vetores o sinal foi T, F e ? (probabilidade do sinal);
+/// - quantas vezes o valor mudou entre vetores consecutivos (qualquer mudanca) e
+///   quantas dessas mudancas foram transicoes T <-> F (atividade para estimativa de
+///   potencia).
+/// Os contadores sao atualizados pelos resultados da simulacao de um vetor
+/// (acumular) ou de 64 vetores em paralelo (acumularLote, com popcount sobre
+/// as palavras de Lote3S).
+/// Varias threads podem acumular sequencias independentes em objetos separados,
+/// que sao combinados no final (combinar), e o resultado exportado em CSV ou binario.
+///
+
+class EstatisticasSinais {
+private:
+  int Nin, NS;
+  // Os indices (em sinais) das saidas do circuito
+  std::vector<int> idx_out;
+  // O numero de vetores acumulados
+  uint64_t Nvet;
+  // Os contadores de cada sinal
+  std::vector<uint64_t> nT, nF, mudancas, transicoes;
+  // O valor de cada sinal no primeiro e no ultimo vetor acumulado
+  std::vector<bool3S> primeiro, ultimo;
+
+public:
+  EstatisticasSinais();
+  // Prepara (zera) os contadores para os sinais do circuito compilado P
+  explicit EstatisticasSinais(const CircuitoCompilado& P);
+  void iniciar(const CircuitoCompilado& P);
+
+  // Acumula os valores de todos os sinais de um vetor simulado
+  // (indexados por CircuitoCompilado::indiceSinal)
+  void acumular(const bool3S* sinais);
+  // Acumula os valores calculados na ultima simulacao de C (C.getSinais())
+  void acumular(const Circuito& C);
+  // Acumula NPistas vetores simulados em paralelo (as pistas 0 a NPistas-1, em ordem)
+  void acumularLote(const Lote3S* sinais, int NPistas=NUM_PISTAS);
+
+  // Acrescenta os contadores de E, considerando que a sequencia de E vem logo apos
+  // a sequencia deste objeto (a mudanca entre o ultimo vetor deste e o primeiro de E
+  // tambem eh contada). Retorna false se os circuitos forem diferentes
+  bool combinar(const EstatisticasSinais& E);
+
+  // Consultas (S: indice do sinal, em CircuitoCompilado::indiceSinal)
+  int getNumSinais() const;
+  uint64_t getNumVetores() const;
+  uint64_t getNumTrue(int S) const;
+  uint64_t getNumFalse(int S) const;
+  uint64_t getNumUndef(int S) const;
+  uint64_t getNumMudancas(int S) const;
+  uint64_t getNumTransicoes(int S) const;
+
+  // Exporta um relatorio CSV, com uma linha por entrada (E1...), porta (P1...) e
+  // saida do circuito (S1...). Retorna false se houve erro
+  bool salvarCSV(const std::string& Arq) const;
+  // Exporta os contadores em formato binario (cabecalho "EST3S" seguido de
+  // Nin, NS, Nvet e dos vetores de contadores, em uint64_t). Retorna false se houve erro
+  bool salvarBinario(const std::string& Arq) const;
+
+  // Simula NLotes lotes de 64 vetores aleatorios, gerados a partir de Modelo
+  // (cada thread usa uma copia de Modelo com a semente Semente e o fluxo igual ao
+  // numero da thread), dividindo os lotes entre NThreads threads, e retorna as
+  // estatisticas combinadas. Retorna estatisticas vazias se o circuito for invalido
+  static EstatisticasSinais simularAleatorio(Circuito& C, const GeradorEstimulos& Modelo,
+                                             uint64_t Semente, long NLotes, int NThreads=1);
+};
+
+#endif // _ESTATISTICAS_H_
@@ -0,0 +1,232 @@
+#include <cmath>
+#include "estimulos.h"
+
+///
+/// CLASSE GERADOR ALEATORIO
+///
+
+// Inicializa o estado a partir da semente (via splitmix64) e avanca para o fluxo
+GeradorAleatorio::GeradorAleatorio(uint64_t Semente, int Fluxo)
+{
+  for (int i=0; i<4; i++)
+  {
+    uint64_t z = (Semente += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z>>30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z>>27)) * 0x94d049bb133111ebULL;
+    s[i] = z ^ (z>>31);
+  }
+  for (int k=0; k<Fluxo; k++) saltar();
+}
+
+// Avanca 2^128 numeros na sequencia (funcao jump do xoshiro256**)
+void GeradorAleatorio::saltar()
+{
+  static const uint64_t SALTO[4] = {0x180ec6d33cfd0abaULL, 0xd5a61266f0c9392cULL,
+                                    0xa9582618e03fc9aaULL, 0x39abdc4529b1661cULL};
+  uint64_t prov[4] = {0, 0, 0, 0};
+  for (int i=0; i<4; i++)
+  {
+    for (int b=0; b<64; b++)
+    {
+      if (SALTO[i] & (uint64_t(1)<<b))
+      {
+        for (int j=0; j<4; j++) prov[j] ^= s[j];
+      }
+      proximo();
+    }
+  }
+  for (int j=0; j<4; j++) s[j] = prov[j];
+}
+
+///
+/// CLASSE GERADOR DE ESTIMULOS
+///
+
+// A representacao das probabilidades (em 1/65536)
+static const uint32_t PROB_UM = 1<<16;
+
+// Gerador para um circuito com NIn entradas, todas com T, F e ? equiprovaveis
+GeradorEstimulos::GeradorEstimulos(int NIn, uint64_t Semente, int Fluxo):
+  Nin(NIn>0 ? NIn : 0), rng(Semente, Fluxo), dist(Nin)
+{
+  setProbabilidades(1.0, 1.0, 1.0);
+}
+
+int GeradorEstimulos::getNumInputs() const
+{
+  return Nin;
+}
+
+// Reinicia a sequencia aleatoria com outra semente e fluxo
+void GeradorEstimulos::reiniciar(uint64_t Semente, int Fluxo)
+{
+  rng = GeradorAleatorio(Semente, Fluxo);
+}
+
+// Retorna true se IdInput eh uma id de entrada valida (entre -1 e -Nin)
+bool GeradorEstimulos::validIdInput(int IdInput) const
+{
+  return (IdInput<=-1 && IdInput>=-Nin);
+}
+
+// Converte as probabilidades (PT, PF, PU) para a representacao interna:
+// P(T) e P(F | nao T), arredondadas para multiplos de 1/65536
+bool GeradorEstimulos::converter(double PT, double PF, double PU, Distribuicao& D)
+{
+  if (PT<0.0 || PF<0.0 || PU<0.0 || PT+PF+PU<=0.0) return false;
+  const double soma = PT+PF+PU;
+  D.pt = uint32_t(std::lround(PT/soma*PROB_UM));
+  D.pf = (PF+PU>0.0 ? uint32_t(std::lround(PF/(PF+PU)*PROB_UM)) : 0);
+  D.fixa = false;
+  D.valor = lote3S(bool3S::UNDEF);
+  return true;
+}
+
+// Fixa as probabilidades de T, F e ? de todas as entradas nao fixadas
+bool GeradorEstimulos::setProbabilidades(double PT, double PF, double PU)
+{
+  Distribuicao prov;
+  if (!converter(PT, PF, PU, prov)) return false;
+  for (Distribuicao& D : dist) if (!D.fixa) D = prov;
+  return true;
+}
+
+// Fixa as probabilidades de T, F e ? da entrada IdInput
+bool GeradorEstimulos::setProbabilidades(int IdInput, double PT, double PF, double PU)
+{
+  if (!validIdInput(IdInput)) return false;
+  return converter(PT, PF, PU, dist[-IdInput-1]);
+}
+
+// Fixa a entrada IdInput no valor Valor em todos os vetores gerados
+void GeradorEstimulos::fixarEntrada(int IdInput, bool3S Valor)
+{
+  if (!validIdInput(IdInput)) return;
+  dist[-IdInput-1].fixa = true;
+  dist[-IdInput-1].valor = lote3S(Valor);
+}
+
+// Retorna uma mascara em que cada bit vale 1 com probabilidade P/65536
+// Percorrendo os bits de P do menos para o mais significativo, cada palavra
+// aleatoria r faz m <- m|r (bit 1) ou m <- m&r (bit 0): ao final, cada bit de m
+// vale 1 com probabilidade 0.b15 b14 ... b0 (em binario) = P/65536.
+// Os bits 0 menos significativos nao alteram o resultado e sao pulados.
+uint64_t GeradorEstimulos::mascara(uint32_t P)
+{
+  if (P==0) return 0;
+  if (P>=PROB_UM) return ~uint64_t(0);
+  int b = __builtin_ctz(P);
+  uint64_t m = 0;
+  for (; b<16; b++)
+  {
+    if ((P>>b) & 1) m |= rng.proximo();
+    else m &= rng.proximo();
+  }
+  return m;
+}
+
+// Gera um lote de 64 vetores de entrada
+void GeradorEstimulos::gerarLote(Lote3S* in_circ)
+{
+  for (int i=0; i<Nin; i++)
+  {
+    const Distribuicao& D(dist[i]);
+    if (D.fixa)
+    {
+      in_circ[i] = D.valor;
+      continue;
+    }
+    in_circ[i].t = mascara(D.pt);
+    in_circ[i].f = mascara(D.pf) & ~in_circ[i].t;
+  }
+}
+
+void GeradorEstimulos::gerarLote(std::vector<Lote3S>& in_circ)
+{
+  in_circ.resize(Nin);
+  gerarLote(in_circ.data());
+}
+
+// Gera NLotes lotes em sequencia
+void GeradorEstimulos::gerarLotes(Lote3S* buffer, long NLotes)
+{
+  for (long k=0; k<NLotes; k++) gerarLote(buffer+k*Nin);
+}
+
+///
+/// CLASSE ENUMERADOR EXAUSTIVO
+///
+
+// Enumerador para NIn entradas (entre 0 e MAX_ENTRADAS)
+EnumeradorExaustivo::EnumeradorExaustivo(int NIn):
+  Nin(0), total(0)
+{
+  // Um numero de entradas invalido deixa o enumerador vazio (total 0)
+  if (NIn<0 || NIn>MAX_ENTRADAS) return;
+  Nin = NIn;
+  total = 1;
+  for (int i=0; i<Nin; i++) total *= 3;
+}
+
+bool EnumeradorExaustivo::valid() const
+{
+  return total>0;
+}
+
+int EnumeradorExaustivo::getNumInputs() const
+{
+  return Nin;
+}
+
+uint64_t EnumeradorExaustivo::getNumVetores() const
+{
+  return total;
+}
+
+uint64_t EnumeradorExaustivo::getNumLotes() const
+{
+  return (total+NUM_PISTAS-1)/NUM_PISTAS;
+}
+
+// Gera o lote K
+// Os digitos do primeiro vetor do lote sao calculados uma vez; os seguintes sao
+// obtidos incrementando o numero na base 3 (mesma regra de gerarTabela)
+int EnumeradorExaustivo::gerarLote(uint64_t K, Lote3S* in_circ) const
+{
+  if (K>=getNumLotes()) return 0;
+  const uint64_t R0 = K*NUM_PISTAS;
+  const int NPistas = int(total-R0<uint64_t(NUM_PISTAS) ? total-R0 : NUM_PISTAS);
+  int digito[MAX_ENTRADAS];
+
+  uint64_t prov = R0;
+  for (int i=Nin-1; i>=0; i--)
+  {
+    digito[i] = prov%3;
+    prov /= 3;
+    in_circ[i] = lote3S(bool3S::UNDEF);
+  }
+  for (int k=0; k<NPistas; k++)
+  {
+    for (int i=0; i<Nin; i++)
+    {
+      in_circ[i].t |= uint64_t(digito[i]==int(bool3S::TRUE)) << k;
+      in_circ[i].f |= uint64_t(digito[i]==int(bool3S::FALSE)) << k;
+    }
+    int i = Nin-1;
+    while (i>=0 && digito[i]==2) digito[i--] = 0;
+    if (i>=0) digito[i]++;
+  }
+  return NPistas;
+}
+
+// Retorna o vetor de numero R (R em base 3)
+std::vector<bool3S> EnumeradorExaustivo::getVetor(uint64_t R) const
+{
+  std::vector<bool3S> prov(Nin);
+  for (int i=Nin-1; i>=0; i--)
+  {
+    prov[i] = bool3S(R%3);
+    R /= 3;
+  }
+  return prov;
+}
@@ -0,0 +1,155 @@
+#ifndef _ESTIMULOS_H_
+#define _ESTIMULOS_H_
+
+#include <cstdint>
+#include <vector>
+#include "bool3S.h"
+#include "lote3S.h"
+
+///
+/// CLASSE GERADOR ALEATORIO
+///
+/// Gerador de numeros pseudo-aleatorios xoshiro256** (rapido, periodo 2^256-1).
+/// A mesma semente gera sempre a mesma sequencia. Para varias threads, cada uma
+/// deve usar um fluxo diferente: o fluxo k comeca 2^128*k numeros adiante no
+/// periodo (funcao jump), de modo que os fluxos nunca se sobrepoem na pratica.
+///
+
+class GeradorAleatorio {
+private:
+  uint64_t s[4];
+
+public:
+  // Inicializa o estado a partir da semente (via splitmix64) e avanca para o fluxo
+  explicit GeradorAleatorio(uint64_t Semente=0, int Fluxo=0);
+
+  // Retorna o proximo numero de 64 bits
+  inline uint64_t proximo()
+  {
+    const uint64_t resultado = rotl(s[1]*5, 7)*9;
+    const uint64_t t = s[1]<<17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotl(s[3], 45);
+    return resultado;
+  }
+
+  // Avanca 2^128 numeros na sequencia (passa para o proximo fluxo)
+  void saltar();
+
+private:
+  static inline uint64_t rotl(uint64_t x, int k)
+  {
+    return (x<<k) | (x>>(64-k));
+  }
+};
+
+///
+/// CLASSE GERADOR DE ESTIMULOS
+///
+/// Gera vetores de entrada aleatorios para um circuito, ja empacotados em lotes
+/// de 64 vetores (um Lote3S por entrada), prontos para Circuito::simularLote ou
+/// CircuitoCompilado::simularLote, sem passar por std::vector<bool3S>.
+/// - cada entrada tem probabilidades configuraveis de ser T, F ou ?;
+/// - uma entrada pode ser fixada em um valor constante (restricao);
+/// - a sequencia gerada depende apenas da semente e do fluxo (reprodutivel).
+/// As 64 pistas de um lote sao sorteadas de uma vez: uma mascara de 64 bits em que
+/// cada bit vale 1 com probabilidade p eh obtida combinando (AND/OR) algumas palavras
+/// aleatorias, uma para cada bit da representacao binaria de p (precisao de 1/65536).
+///
+/// ATENCAO PARA A CONVENCAO: as entradas sao identificadas por IdInput (-1 a -Nin)
+///
+
+class GeradorEstimulos {
+private:
+  // Como cada entrada eh sorteada
+  struct Distribuicao {
+    uint32_t pt;     // probabilidade de T (em 1/65536)
+    uint32_t pf;     // probabilidade de F quando nao eh T (em 1/65536)
+    bool fixa;       // se a entrada estah fixada em um valor constante
+    Lote3S valor;    // o valor constante, caso fixa
+  };
+
+  int Nin;
+  GeradorAleatorio rng;
+  std::vector<Distribuicao> dist;
+
+  // Retorna true se IdInput eh uma id de entrada valida (entre -1 e -Nin)
+  bool validIdInput(int IdInput) const;
+  // Retorna uma mascara em que cada bit vale 1 com probabilidade P/65536
+  uint64_t mascara(uint32_t P);
+  // Converte as probabilidades (PT, PF, PU) para a representacao interna
+  static bool converter(double PT, double PF, double PU, Distribuicao& D);
+
+public:
+  // Gerador para um circuito com NIn entradas, todas com T, F e ? equiprovaveis
+  GeradorEstimulos(int NIn, uint64_t Semente, int Fluxo=0);
+
+  int getNumInputs() const;
+
+  // Reinicia a sequencia aleatoria com outra semente e fluxo, mantendo as
+  // probabilidades e as entradas fixadas (por exemplo, em copias para varias threads)
+  void reiniciar(uint64_t Semente, int Fluxo=0);
+
+  // Fixa as probabilidades de T, F e ? de todas as entradas nao fixadas
+  // (valores >= 0 e com soma > 0; sao normalizados). Retorna false se invalidas
+  bool setProbabilidades(double PT, double PF, double PU);
+  // Fixa as probabilidades de T, F e ? da entrada IdInput (e a libera, se estava fixada)
+  bool setProbabilidades(int IdInput, double PT, double PF, double PU);
+
+  // Fixa a entrada IdInput no valor Valor em todos os vetores gerados
+  void fixarEntrada(int IdInput, bool3S Valor);
+
+  // Gera um lote de 64 vetores de entrada: in_circ deve ter Nin elementos
+  void gerarLote(Lote3S* in_circ);
+  // O mesmo, redimensionando o vector para Nin elementos
+  void gerarLote(std::vector<Lote3S>& in_circ);
+  // Gera NLotes lotes em sequencia: buffer deve ter NLotes*Nin elementos
+  // (o lote k ocupa as posicoes k*Nin ateh k*Nin+Nin-1)
+  void gerarLotes(Lote3S* buffer, long NLotes);
+};
+
+///
+/// CLASSE ENUMERADOR EXAUSTIVO
+///
+/// Gera todas as 3^Nin combinacoes de entradas, na mesma ordem da tabela verdade
+/// (gerarTabela: a primeira entrada eh o digito mais significativo e cada entrada
+/// segue a ordem do operador ++ de bool3S: ?, F, T), ja empacotadas em lotes de 64.
+/// O vetor de numero R (0 a 3^Nin-1) eh a representacao de R na base 3; o lote K
+/// contem os vetores 64*K ateh 64*K+63, de modo que qualquer lote pode ser gerado
+/// diretamente (por exemplo, por threads diferentes).
+///
+
+class EnumeradorExaustivo {
+private:
+  int Nin;
+  uint64_t total;
+
+public:
+  // O maior numero de entradas enumeravel (3^40 < 2^64)
+  static const int MAX_ENTRADAS = 40;
+
+  // Enumerador para NIn entradas (entre 0 e MAX_ENTRADAS)
+  // Com NIn fora desse intervalo, o enumerador fica vazio (valid() == false, sem
+  // nenhum vetor nem lote), em vez de enumerar apenas parte das entradas
+  explicit EnumeradorExaustivo(int NIn);
+
+  // Retorna true se o numero de entradas do construtor era enumeravel
+  bool valid() const;
+  int getNumInputs() const;
+  // O numero total de vetores (3^Nin) e de lotes
+  uint64_t getNumVetores() const;
+  uint64_t getNumLotes() const;
+
+  // Gera o lote K: in_circ deve ter Nin elementos
+  // Retorna o numero de pistas validas (64, exceto no ultimo lote; 0 se K invalido)
+  int gerarLote(uint64_t K, Lote3S* in_circ) const;
+
+  // Retorna o vetor de numero R (R em base 3, mesma ordem de gerarTabela)
+  std::vector<bool3S> getVetor(uint64_t R) const;
+};
+
+#endif // _ESTIMULOS_H_
@@ -0,0 +1,61 @@
+#include "kernels.h"
+
+// A tabela de kernels especializados, indexada por [operacao][inversao][N-1]
+static const KernelPorta tabelaKernels[3][2][MAX_FANIN_KERNEL] = {
+  {{kernelPorta<OpPorta::AND,false,1>, kernelPorta<OpPorta::AND,false,2>,
+    kernelPorta<OpPorta::AND,false,3>, kernelPorta<OpPorta::AND,false,4>},
+   {kernelPorta<OpPorta::AND,true,1>, kernelPorta<OpPorta::AND,true,2>,
+    kernelPorta<OpPorta::AND,true,3>, kernelPorta<OpPorta::AND,true,4>}},
+  {{kernelPorta<OpPorta::OR,false,1>, kernelPorta<OpPorta::OR,false,2>,
+    kernelPorta<OpPorta::OR,false,3>, kernelPorta<OpPorta::OR,false,4>},
+   {kernelPorta<OpPorta::OR,true,1>, kernelPorta<OpPorta::OR,true,2>,
+    kernelPorta<OpPorta::OR,true,3>, kernelPorta<OpPorta::OR,true,4>}},
+  {{kernelPorta<OpPorta::XOR,false,1>, kernelPorta<OpPorta::XOR,false,2>,
+    kernelPorta<OpPorta::XOR,false,3>, kernelPorta<OpPorta::XOR,false,4>},
+   {kernelPorta<OpPorta::XOR,true,1>, kernelPorta<OpPorta::XOR,true,2>,
+    kernelPorta<OpPorta::XOR,true,3>, kernelPorta<OpPorta::XOR,true,4>}}
+};
+
+// A tabela de kernels genericos, indexada por [operacao][inversao]
+static const KernelPorta tabelaGenericos[3][2] = {
+  {kernelPortaGenerico<OpPorta::AND,false>, kernelPortaGenerico<OpPorta::AND,true>},
+  {kernelPortaGenerico<OpPorta::OR,false>, kernelPortaGenerico<OpPorta::OR,true>},
+  {kernelPortaGenerico<OpPorta::XOR,false>, kernelPortaGenerico<OpPorta::XOR,true>}
+};
+
+// Retorna o kernel apropriado para uma porta com operacao OP, inversao INV
+// e N entradas: o especializado, se N <= MAX_FANIN_KERNEL, ou o generico
+KernelPorta selecionarKernel(OpPorta OP, bool INV, int N)
+{
+  if (N<1) return nullptr;
+  if (N<=MAX_FANIN_KERNEL) return tabelaKernels[int(OP)][INV][N-1];
+  return tabelaGenericos[int(OP)][INV];
+}
+
+// As mesmas tabelas, para a simulacao de 64 vetores em paralelo
+#define KERNELS_LOTE(OP,INV) \
+  {kernelPorta<OP,INV,1,Lote3S>, kernelPorta<OP,INV,2,Lote3S>, \
+   kernelPorta<OP,INV,3,Lote3S>, kernelPorta<OP,INV,4,Lote3S>}
+
+static const KernelLote tabelaKernelsLote[3][2][MAX_FANIN_KERNEL] = {
+  {KERNELS_LOTE(OpPorta::AND,false), KERNELS_LOTE(OpPorta::AND,true)},
+  {KERNELS_LOTE(OpPorta::OR,false), KERNELS_LOTE(OpPorta::OR,true)},
+  {KERNELS_LOTE(OpPorta::XOR,false), KERNELS_LOTE(OpPorta::XOR,true)}
+};
+
+#undef KERNELS_LOTE
+
+static const KernelLote tabelaGenericosLote[3][2] = {
+  {kernelPortaGenerico<OpPorta::AND,false,Lote3S>, kernelPortaGenerico<OpPorta::AND,true,Lote3S>},
+  {kernelPortaGenerico<OpPorta::OR,false,Lote3S>, kernelPortaGenerico<OpPorta::OR,true,Lote3S>},
+  {kernelPortaGenerico<OpPorta::XOR,false,Lote3S>, kernelPortaGenerico<OpPorta::XOR,true,Lote3S>}
+};
+
+// Retorna o kernel de lote apropriado para uma porta com operacao OP, inversao INV
+// e N entradas: o especializado, se N <= MAX_FANIN_KERNEL, ou o generico
+KernelLote selecionarKernelLote(OpPorta OP, bool INV, int N)
+{
+  if (N<1) return nullptr;
+  if (N<=MAX_FANIN_KERNEL) return tabelaKernelsLote[int(OP)][INV][N-1];
+  return tabelaGenericosLote[int(OP)][INV];
+}
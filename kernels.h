@@ -0,0 +1,197 @@
+#ifndef _KERNELS_H_
+#define _KERNELS_H_
+
+#include <cstdint>
+#include "bool3S.h"
+#include "lote3S.h"
+
+///
+/// KERNELS ESPECIALIZADOS DE SIMULACAO DE PORTAS
+///
+/// Cada kernel eh gerado em tempo de compilacao a partir de:
+/// - a operacao basica da porta (AND, OR ou XOR);
+/// - se a saida eh invertida (NAND, NOR, NXOR; NOT = AND de 1 entrada invertido);
+/// - o numero de entradas (fan-in), para os casos mais comuns (1 a 4).
+/// O laco sobre as entradas eh desenrolado pelo compilador e cada operacao
+/// eh uma consulta a uma tabela constexpr, sem desvios.
+/// Portas com mais de 4 entradas usam um kernel generico com laco.
+/// Ha duas familias de kernels com a mesma estrutura: uma para simular um unico
+/// vetor de entradas (bool3S) e outra para simular 64 vetores em paralelo (Lote3S).
+///
+
+// A operacao basica de uma porta
+enum class OpPorta : uint8_t {
+  AND,
+  OR,
+  XOR
+};
+
+// O maior numero de entradas com kernel desenrolado
+constexpr int MAX_FANIN_KERNEL = 4;
+
+// Assinatura comum a todos os kernels:
+// - sinais: vetor com os valores atuais de todos os sinais do circuito
+// - idx: os indices (em sinais) das entradas da porta
+// - N: o numero de entradas (soh usado pelo kernel generico)
+typedef bool3S (*KernelPorta)(const bool3S* sinais, const int* idx, int N);
+// O mesmo, para a simulacao de 64 vetores em paralelo
+typedef Lote3S (*KernelLote)(const Lote3S* sinais, const int* idx, int N);
+
+// As tabelas verdade das operacoes de bool3S, indexadas pelo valor inteiro
+// de bool3S (UNDEF=0, FALSE=1, TRUE=2)
+namespace tabela3S {
+  constexpr bool3S U = bool3S::UNDEF;
+  constexpr bool3S F = bool3S::FALSE;
+  constexpr bool3S T = bool3S::TRUE;
+
+  constexpr bool3S NOT[3] = {U, T, F};
+  constexpr bool3S OPER[3][3][3] = {
+    // AND
+    {{U, F, U},
+     {F, F, F},
+     {U, F, T}},
+    // OR
+    {{U, U, T},
+     {U, F, T},
+     {T, T, T}},
+    // XOR
+    {{U, U, U},
+     {U, F, T},
+     {U, T, F}}
+  };
+
+  // Aplica a operacao OP aos valores x1 e x2
+  template<OpPorta OP>
+  constexpr bool3S aplicar(bool3S x1, bool3S x2)
+  {
+    return OPER[int(OP)][int(x1)][int(x2)];
+  }
+
+  // Inverte (ou nao) um valor
+  template<bool INV>
+  constexpr bool3S inverter(bool3S x)
+  {
+    return INV ? NOT[int(x)] : x;
+  }
+
+  // As mesmas funcoes, para lotes de 64 valores
+  template<OpPorta OP>
+  inline Lote3S aplicar(Lote3S x1, Lote3S x2)
+  {
+    return (OP==OpPorta::AND ? x1 & x2 :
+            OP==OpPorta::OR ? x1 | x2 :
+            x1 ^ x2);
+  }
+
+  template<bool INV>
+  inline Lote3S inverter(Lote3S x)
+  {
+    return INV ? ~x : x;
+  }
+}
+
+// A reducao das N entradas de uma porta pela operacao OP, desenrolada em
+// tempo de compilacao: R<N> = OP(R<N-1>, in[N-1])
+// O tipo V eh o tipo dos valores simulados (bool3S ou Lote3S)
+template<OpPorta OP, int N, class V>
+struct ReducaoPorta {
+  static inline V calcular(const V* sinais, const int* idx)
+  {
+    return tabela3S::aplicar<OP>(ReducaoPorta<OP,N-1,V>::calcular(sinais,idx), sinais[idx[N-1]]);
+  }
+};
+
+template<OpPorta OP, class V>
+struct ReducaoPorta<OP,1,V> {
+  static inline V calcular(const V* sinais, const int* idx)
+  {
+    return sinais[idx[0]];
+  }
+};
+
+// Kernel especializado para a operacao OP, inversao INV e N entradas
+template<OpPorta OP, bool INV, int N, class V=bool3S>
+V kernelPorta(const V* sinais, const int* idx, int /*N*/)
+{
+  return tabela3S::inverter<INV>(ReducaoPorta<OP,N,V>::calcular(sinais,idx));
+}
+
+// Kernel generico (qualquer numero de entradas >= 1)
+template<OpPorta OP, bool INV, class V=bool3S>
+V kernelPortaGenerico(const V* sinais, const int* idx, int N)
+{
+  V prov = sinais[idx[0]];
+  for (int i=1; i<N; i++) prov = tabela3S::aplicar<OP>(prov, sinais[idx[i]]);
+  return tabela3S::inverter<INV>(prov);
+}
+
+// Retorna o kernel apropriado para uma porta com operacao OP, inversao INV
+// e N entradas: o especializado, se N <= MAX_FANIN_KERNEL, ou o generico
+KernelPorta selecionarKernel(OpPorta OP, bool INV, int N);
+// O mesmo, para a simulacao de 64 vetores em paralelo
+KernelLote selecionarKernelLote(OpPorta OP, bool INV, int N);
+
+// Kernels de outros tipos de porta, com numero de entradas fixo ou estrutura
+// propria (ver registro_portas.h). Assim como os anteriores, servem tanto para
+// bool3S quanto para Lote3S
+
+// Multiplexador: entradas (sel, x0, x1), saida x0 se sel==F e x1 se sel==T
+// Com sel indefinido, a saida eh definida quando x0==x1 (termo de consenso x0.x1)
+template<class V>
+V kernelMux(const V* sinais, const int* idx, int /*N*/)
+{
+  using namespace tabela3S;
+  const V sel = sinais[idx[0]], x0 = sinais[idx[1]], x1 = sinais[idx[2]];
+  return aplicar<OpPorta::OR>(aplicar<OpPorta::OR>(aplicar<OpPorta::AND>(inverter<true>(sel),x0),
+                                                   aplicar<OpPorta::AND>(sel,x1)),
+                              aplicar<OpPorta::AND>(x0,x1));
+}
+
+// Maioria de 3 entradas: T (F) se pelo menos duas entradas forem T (F)
+template<class V>
+V kernelMaioria(const V* sinais, const int* idx, int /*N*/)
+{
+  using namespace tabela3S;
+  const V x0 = sinais[idx[0]], x1 = sinais[idx[1]], x2 = sinais[idx[2]];
+  return aplicar<OpPorta::OR>(aplicar<OpPorta::OR>(aplicar<OpPorta::AND>(x0,x1),
+                                                   aplicar<OpPorta::AND>(x0,x2)),
+                              aplicar<OpPorta::AND>(x1,x2));
+}
+
+// Tri-state: entradas (dado, habilita), saida igual ao dado se habilita==T
+// Com habilita F (alta impedancia) ou indefinido, a saida eh indefinida
+inline bool3S kernelTriState(const bool3S* sinais, const int* idx, int /*N*/)
+{
+  return (sinais[idx[1]]==bool3S::TRUE ? sinais[idx[0]] : bool3S::UNDEF);
+}
+
+inline Lote3S kernelTriState(const Lote3S* sinais, const int* idx, int /*N*/)
+{
+  const Lote3S d = sinais[idx[0]], h = sinais[idx[1]];
+  return Lote3S{d.t & h.t, d.f & h.t};
+}
+
+// Portas compostas de dois niveis, com as entradas agrupadas em pares:
+// AOI: NOT((x0 AND x1) OR (x2 AND x3) OR ...)  -> DENTRO=AND, FORA=OR
+// OAI: NOT((x0 OR x1) AND (x2 OR x3) AND ...)  -> DENTRO=OR, FORA=AND
+template<OpPorta DENTRO, OpPorta FORA, class V>
+V kernelPares(const V* sinais, const int* idx, int N)
+{
+  using namespace tabela3S;
+  V prov = aplicar<DENTRO>(sinais[idx[0]], sinais[idx[1]]);
+  for (int i=2; i+1<N; i+=2)
+  {
+    prov = aplicar<FORA>(prov, aplicar<DENTRO>(sinais[idx[i]], sinais[idx[i+1]]));
+  }
+  return inverter<true>(prov);
+}
+
+// Flip-flop tipo D fora da simulacao com relogio (SimulacaoSincrona): a saida eh o
+// valor guardado, que nao depende da entrada e eh desconhecido (?)
+template<class V>
+V kernelFlipFlop(const V* /*sinais*/, const int* /*idx*/, int /*N*/)
+{
+  return V{};
+}
+
+#endif // _KERNELS_H_
@@ -0,0 +1,83 @@
+#ifndef _LOTE3S_H_
+#define _LOTE3S_H_
+
+#include <cstdint>
+#include "bool3S.h"
+
+///
+/// LOTE DE 64 VALORES BOOL3S SIMULADOS EM PARALELO (bit-parallel)
+///
+/// Cada Lote3S guarda o valor de um mesmo sinal em 64 simulacoes independentes
+/// (64 "pistas", uma por bit), com a codificacao em dois trilhos (dual-rail):
+/// - bit k de t == 1: na pista k o sinal eh bool3S::TRUE
+/// - bit k de f == 1: na pista k o sinal eh bool3S::FALSE
+/// - ambos os bits == 0: na pista k o sinal eh bool3S::UNDEF
+/// (ambos os bits iguais a 1 nunca ocorre)
+/// Com essa codificacao, os operadores de bool3S viram poucas operacoes
+/// logicas sobre palavras de 64 bits, sem nenhum desvio.
+///
+
+struct Lote3S {
+  uint64_t t;
+  uint64_t f;
+};
+
+// O numero de pistas (simulacoes em paralelo) em um Lote3S
+constexpr int NUM_PISTAS = 64;
+
+// Um lote com o mesmo valor em todas as pistas
+inline Lote3S lote3S(bool3S x)
+{
+  return Lote3S{x==bool3S::TRUE ? ~uint64_t(0) : 0,
+                x==bool3S::FALSE ? ~uint64_t(0) : 0};
+}
+
+// O valor da pista k (0 a NUM_PISTAS-1)
+inline bool3S getPista(const Lote3S& L, int k)
+{
+  if ((L.t>>k) & 1) return bool3S::TRUE;
+  if ((L.f>>k) & 1) return bool3S::FALSE;
+  return bool3S::UNDEF;
+}
+
+// Fixa o valor da pista k (0 a NUM_PISTAS-1)
+inline void setPista(Lote3S& L, int k, bool3S x)
+{
+  const uint64_t m = uint64_t(1)<<k;
+  L.t = (L.t & ~m) | (x==bool3S::TRUE ? m : 0);
+  L.f = (L.f & ~m) | (x==bool3S::FALSE ? m : 0);
+}
+
+// As pistas em que os dois lotes diferem
+inline uint64_t diferenca(const Lote3S& x1, const Lote3S& x2)
+{
+  return (x1.t ^ x2.t) | (x1.f ^ x2.f);
+}
+
+// Os operadores logicos de bool3S aplicados pista a pista
+
+// NOT 3S
+inline Lote3S operator~(Lote3S x)
+{
+  return Lote3S{x.f, x.t};
+}
+
+// AND 3S
+inline Lote3S operator&(Lote3S x1, Lote3S x2)
+{
+  return Lote3S{x1.t & x2.t, x1.f | x2.f};
+}
+
+// OR 3S
+inline Lote3S operator|(Lote3S x1, Lote3S x2)
+{
+  return Lote3S{x1.t | x2.t, x1.f & x2.f};
+}
+
+// XOR 3S
+inline Lote3S operator^(Lote3S x1, Lote3S x2)
+{
+  return Lote3S{(x1.t & x2.f) | (x1.f & x2.t), (x1.t & x2.t) | (x1.f & x2.f)};
+}
+
+#endif // _LOTE3S_H_
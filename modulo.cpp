@@ -0,0 +1,54 @@
+#include <cctype>
+#include "modulo.h"
+
+///
+/// CLASSE MODULO
+///
+
+// Cria o modulo Nome a partir de uma copia do circuito C, e o compila
+Modulo::Modulo(const std::string& Nome, const Circuito& C):
+  nome(Nome), circuito(C), programa()
+{
+  programa = circuito.getCompilado();
+}
+
+bool Modulo::valid() const
+{
+  return bool(programa);
+}
+
+const std::string& Modulo::getNome() const
+{
+  return nome;
+}
+
+const Circuito& Modulo::getCircuito() const
+{
+  return circuito;
+}
+
+std::shared_ptr<const CircuitoCompilado> Modulo::getCompilado() const
+{
+  return programa;
+}
+
+int Modulo::getNumInputs() const
+{
+  return circuito.getNumInputs();
+}
+
+int Modulo::getNumOutputs() const
+{
+  return circuito.getNumOutputs();
+}
+
+// Retorna true se Nome eh um nome valido de modulo
+bool Modulo::validNome(const std::string& Nome)
+{
+  if (Nome.empty() || !isalpha((unsigned char)Nome.at(0))) return false;
+  for (char c : Nome)
+  {
+    if (!isalnum((unsigned char)c) && c!='_') return false;
+  }
+  return true;
+}
@@ -0,0 +1,45 @@
+#ifndef _MODULO_H_
+#define _MODULO_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include "circuito.h"
+
+///
+/// CLASSE MODULO
+///
+/// Um subcircuito com nome (somador, multiplexador, etc.), que pode ser instanciado
+/// por portas SB de outros circuitos: "SB NOME:Saida NIn: id1 id2 ...", com as
+/// entradas da porta ligadas as entradas do modulo (ver Circuito::Portas::instancias).
+/// O modulo eh compilado (CircuitoCompilado) uma unica vez, ao ser criado, e nunca
+/// mais alterado: todas as instancias, em todos os circuitos e copias de circuitos,
+/// compartilham o mesmo Modulo (ptr_Modulo) e o mesmo circuito compilado.
+///
+
+class Modulo {
+private:
+  std::string nome;
+  Circuito circuito;
+  std::shared_ptr<const CircuitoCompilado> programa;
+
+public:
+  // Cria o modulo Nome a partir de uma copia do circuito C, e o compila
+  // Se C nao for valido, o modulo fica invalido (valid() == false)
+  Modulo(const std::string& Nome, const Circuito& C);
+
+  // Retorna true se o modulo eh valido (o circuito foi compilado)
+  bool valid() const;
+
+  const std::string& getNome() const;
+  const Circuito& getCircuito() const;
+  std::shared_ptr<const CircuitoCompilado> getCompilado() const;
+  int getNumInputs() const;
+  int getNumOutputs() const;
+
+  // Retorna true se Nome eh um nome valido de modulo: letras, digitos e '_',
+  // comecando por letra
+  static bool validNome(const std::string& Nome);
+};
+
+#endif // _MODULO_H_
@@ -0,0 +1,343 @@
+#include <algorithm>
+#include "particionamento.h"
+
+///
+/// CLASSE PARTICIONAMENTO DE CIRCUITO
+///
+
+ParticionamentoCircuito::ParticionamentoCircuito():
+  Nin(0), particao(), nivel(), num_cortes(0), partes(), entradas(), saidas(),
+  pos_troca(), num_troca(0), idx_saida()
+{
+}
+
+void ParticionamentoCircuito::clear()
+{
+  Nin = 0;
+  particao.clear();
+  nivel.clear();
+  num_cortes = 0;
+  partes.clear();
+  entradas.clear();
+  saidas.clear();
+  pos_troca.clear();
+  num_troca = 0;
+  idx_saida.clear();
+}
+
+// Divide o circuito C em K particoes
+bool ParticionamentoCircuito::particionar(Circuito& C, int K, double Desbalanco)
+{
+  clear();
+
+  std::shared_ptr<const CircuitoCompilado> P = C.getCompilado();
+  if (!P) return false;
+  // As particoes nao tem instancias de modulos: usa o circuito achatado
+  if (P->isHierarquico())
+  {
+    Circuito plano(C.achatar());
+    P = plano.getCompilado();
+    if (!P) return false;
+  }
+  if (!P->isAciclico()) return false;
+
+  const int NP = P->getNumPorts();
+  Nin = P->getNumInputs();
+  K = std::max(1,std::min(K,NP));
+
+  // Os niveis, na ordem topologica
+  nivel.assign(NP,0);
+  for (int IP : P->getOrdem())
+  {
+    int n = 0;
+    for (int I=0; I<P->getNumInputsPorta(IP); I++)
+    {
+      const int S = P->getIndiceEntrada(IP,I);
+      if (S>=Nin) n = std::max(n,nivel[S-Nin]);
+    }
+    nivel[IP] = n+1;
+  }
+
+  // A divisao inicial: faixas de niveis de mesmo peso
+  std::vector<int> ordem(P->getOrdem());
+  std::stable_sort(ordem.begin(),ordem.end(),[this](int A, int B) {return nivel[A]<nivel[B];});
+  long total = 0;
+  for (int IP=0; IP<NP; IP++) total += 1+P->getNumInputsPorta(IP);
+  particao.assign(NP,0);
+  long acumulado = 0;
+  for (int IP : ordem)
+  {
+    particao[IP] = std::min<long>(K-1,acumulado*K/total);
+    acumulado += 1+P->getNumInputsPorta(IP);
+  }
+  // Portas muito pesadas podem deixar faixas vazias: as particoes sao renumeradas
+  std::vector<int> novo(K,-1);
+  int usadas = 0;
+  for (int IP : ordem)
+  {
+    if (novo[particao[IP]]<0) novo[particao[IP]] = usadas++;
+    particao[IP] = novo[particao[IP]];
+  }
+  K = usadas;
+
+  refinar(*P,K,Desbalanco);
+  if (!montar(*P,K))
+  {
+    clear();
+    return false;
+  }
+  return true;
+}
+
+// Passagens de refinamento: cada porta eh movida para a particao vizinha (anterior ou
+// seguinte) se o numero de sinais cortados diminuir
+// - uma porta soh pode ir para a particao seguinte se todos os seus consumidores jah
+//   estiverem nela ou depois, e para a anterior se todas as portas de que depende
+//   estiverem nela ou antes (a ordem entre as particoes eh mantida);
+// - o peso da particao de destino nao pode passar do limite
+// externos[v] eh o numero de ligacoes da saida da porta v para portas de outras
+// particoes: o sinal de v estah cortado se externos[v]>0
+void ParticionamentoCircuito::refinar(const CircuitoCompilado& P, int K, double Desbalanco)
+{
+  if (K<2) return;
+  const int NP = P.getNumPorts();
+
+  std::vector<long> peso(K,0);
+  long total = 0, maior = 0;
+  for (int IP=0; IP<NP; IP++)
+  {
+    const long w = 1+P.getNumInputsPorta(IP);
+    peso[particao[IP]] += w;
+    total += w;
+    maior = std::max(maior,w);
+  }
+  const long limite = std::max<long>(maior,(1.0+std::max(0.0,Desbalanco))*total/K);
+
+  std::vector<int> externos(NP,0);
+  for (int IP=0; IP<NP; IP++)
+  {
+    const int* fo = P.getFanout(Nin+IP);
+    for (int k=0; k<P.getNumFanout(Nin+IP); k++) externos[IP] += (particao[fo[k]]!=particao[IP]);
+  }
+
+  // As portas de que cada porta depende, sem repeticao, com o numero de ligacoes
+  std::vector<std::pair<int,int>> produtores;
+  auto listarProdutores = [&](int V)
+  {
+    produtores.clear();
+    for (int I=0; I<P.getNumInputsPorta(V); I++)
+    {
+      const int S = P.getIndiceEntrada(V,I);
+      if (S>=Nin) produtores.push_back(std::make_pair(S-Nin,1));
+    }
+    std::sort(produtores.begin(),produtores.end());
+    size_t n = 0;
+    for (size_t k=0; k<produtores.size(); k++)
+    {
+      if (n>0 && produtores[n-1].first==produtores[k].first) produtores[n-1].second++;
+      else produtores[n++] = produtores[k];
+    }
+    produtores.resize(n);
+  };
+
+  const int MAX_PASSAGENS = 8;
+  for (int passagem=0; passagem<MAX_PASSAGENS; passagem++)
+  {
+    bool moveu = false;
+    for (int V=0; V<NP; V++)
+    {
+      const int A = particao[V];
+      const int* fo = P.getFanout(Nin+V);
+      const int NF = P.getNumFanout(Nin+V);
+      listarProdutores(V);
+
+      // A menor particao dos consumidores e a maior das portas de que depende
+      int min_cons = K, max_prod = -1;
+      for (int k=0; k<NF; k++) min_cons = std::min(min_cons,particao[fo[k]]);
+      for (const std::pair<int,int>& u : produtores) max_prod = std::max(max_prod,particao[u.first]);
+
+      const long w = 1+P.getNumInputsPorta(V);
+      for (int B : {A-1, A+1})
+      {
+        // Nenhuma particao fica vazia
+        if (B<0 || B>=K || peso[B]+w>limite || peso[A]==w) continue;
+        if (B>A && min_cons<B) continue;
+        if (B<A && max_prod>B) continue;
+
+        // O ganho: os cortes que deixam de existir menos os que passam a existir
+        int externos_v = 0;
+        for (int k=0; k<NF; k++) externos_v += (particao[fo[k]]!=B);
+        int ganho = (externos[V]>0) - (externos_v>0);
+        for (const std::pair<int,int>& u : produtores)
+        {
+          const int pu = particao[u.first];
+          const int novo = externos[u.first] + u.second*((pu!=B)-(pu!=A));
+          ganho += (externos[u.first]>0) - (novo>0);
+        }
+        if (ganho<=0) continue;
+
+        for (const std::pair<int,int>& u : produtores)
+        {
+          const int pu = particao[u.first];
+          externos[u.first] += u.second*((pu!=B)-(pu!=A));
+        }
+        externos[V] = externos_v;
+        particao[V] = B;
+        peso[A] -= w;
+        peso[B] += w;
+        moveu = true;
+        break;
+      }
+    }
+    if (!moveu) break;
+  }
+}
+
+// Monta os subcircuitos: as portas de cada particao (na ordem dos indices), as
+// entradas (sinais de fora da particao, na ordem do primeiro uso) e as saidas
+// (sinais cortados ou usados como saida do circuito)
+bool ParticionamentoCircuito::montar(const CircuitoCompilado& P, int K)
+{
+  const int NP = P.getNumPorts();
+  const int NO = P.getNumOutputs();
+
+  // Os sinais que precisam sair da sua particao
+  std::vector<char> exportado(NP,0);
+  for (int IO=0; IO<NO; IO++)
+  {
+    const int S = P.getIndiceSaida(IO);
+    if (S>=Nin) exportado[S-Nin] = 1;
+  }
+  num_cortes = 0;
+  for (int IP=0; IP<NP; IP++)
+  {
+    const int* fo = P.getFanout(Nin+IP);
+    bool cortado = false;
+    for (int k=0; k<P.getNumFanout(Nin+IP); k++) cortado |= (particao[fo[k]]!=particao[IP]);
+    num_cortes += cortado;
+    if (cortado) exportado[IP] = 1;
+  }
+
+  std::vector<std::vector<int>> locais(K);
+  for (int IP=0; IP<NP; IP++) locais[particao[IP]].push_back(IP);
+
+  partes.assign(K,Circuito());
+  entradas.assign(K,std::vector<int>());
+  saidas.assign(K,std::vector<int>());
+  pos_troca.assign(P.getNumSinais(),-1);
+  num_troca = 0;
+  // A id de cada sinal no subcircuito da particao em montagem (0: nao pertence)
+  std::vector<int> id_local(P.getNumSinais(),0);
+
+  for (int p=0; p<K; p++)
+  {
+    const std::vector<int>& L = locais[p];
+    if (L.empty()) return false;
+    for (size_t k=0; k<L.size(); k++) id_local[Nin+L[k]] = k+1;
+    for (int IP : L)
+    {
+      for (int I=0; I<P.getNumInputsPorta(IP); I++)
+      {
+        const int S = P.getIndiceEntrada(IP,I);
+        if (id_local[S]!=0) continue;
+        entradas[p].push_back(S);
+        id_local[S] = -int(entradas[p].size());
+      }
+      if (exportado[IP]) saidas[p].push_back(Nin+IP);
+    }
+    // Um subcircuito precisa de ao menos uma saida
+    if (saidas[p].empty()) saidas[p].push_back(Nin+L.back());
+    // As posicoes no buffer de troca ficam agrupadas por particao
+    for (int S : saidas[p]) pos_troca[S] = num_troca++;
+
+    Circuito& sub = partes[p];
+    sub.resize(entradas[p].size(),saidas[p].size(),L.size());
+    for (size_t k=0; k<L.size(); k++)
+    {
+      const int IP = L[k];
+      sub.setPort(k+1,P.getCodigoPorta(IP),P.getNumInputsPorta(IP));
+      for (int I=0; I<P.getNumInputsPorta(IP); I++)
+      {
+        sub.setId_inPort(k+1,I,id_local[P.getIndiceEntrada(IP,I)]);
+      }
+    }
+    for (size_t j=0; j<saidas[p].size(); j++) sub.setIdOutput(j+1,id_local[saidas[p][j]]);
+
+    for (int IP : L) id_local[Nin+IP] = 0;
+    for (int S : entradas[p]) id_local[S] = 0;
+    if (!sub.getCompilado()) return false;
+  }
+
+  idx_saida.resize(NO);
+  for (int IO=0; IO<NO; IO++) idx_saida[IO] = P.getIndiceSaida(IO);
+  return true;
+}
+
+/// ***********************
+/// Consultas
+/// ***********************
+
+bool ParticionamentoCircuito::valid() const
+{
+  return !partes.empty();
+}
+
+int ParticionamentoCircuito::getNumParticoes() const
+{
+  return partes.size();
+}
+
+int ParticionamentoCircuito::getNumInputs() const
+{
+  return Nin;
+}
+
+int ParticionamentoCircuito::getNumOutputs() const
+{
+  return idx_saida.size();
+}
+
+int ParticionamentoCircuito::getParticao(int IP) const
+{
+  return particao.at(IP);
+}
+
+int ParticionamentoCircuito::getNivel(int IP) const
+{
+  return nivel.at(IP);
+}
+
+int ParticionamentoCircuito::getNumCortes() const
+{
+  return num_cortes;
+}
+
+const Circuito& ParticionamentoCircuito::getSubcircuito(int p) const
+{
+  return partes.at(p);
+}
+
+const std::vector<int>& ParticionamentoCircuito::getEntradas(int p) const
+{
+  return entradas.at(p);
+}
+
+const std::vector<int>& ParticionamentoCircuito::getSaidas(int p) const
+{
+  return saidas.at(p);
+}
+
+int ParticionamentoCircuito::getPosTroca(int S) const
+{
+  return pos_troca.at(S);
+}
+
+int ParticionamentoCircuito::getNumTroca() const
+{
+  return num_troca;
+}
+
+int ParticionamentoCircuito::getIndiceSaida(int IO) const
+{
+  return idx_saida.at(IO);
+}
@@ -0,0 +1,84 @@
+#ifndef _PARTICIONAMENTO_H_
+#define _PARTICIONAMENTO_H_
+
+#include <vector>
+#include "circuito.h"
+
+///
+/// CLASSE PARTICIONAMENTO DE CIRCUITO
+///
+/// Divide as portas de um circuito sem realimentacao em K particoes ordenadas, para
+/// simulacao em paralelo como uma linha de producao (ver SimuladorParticionado):
+/// a particao p so depende das entradas do circuito e das particoes anteriores.
+/// - niveis: cada porta tem nivel 1 + o maior nivel das portas de que depende. As
+///   portas sao ordenadas por nivel e divididas em K faixas de mesmo peso (peso de
+///   uma porta: 1 + numero de entradas), o que jah garante a ordem entre particoes;
+/// - corte minimo: passagens de refinamento (no estilo Fiduccia-Mattheyses) movem
+///   portas da fronteira para a particao vizinha quando o numero de sinais cortados
+///   (sinais usados em outra particao) diminui, sem violar a ordem entre as
+///   particoes nem o limite de desbalanceamento do peso.
+/// Cada particao vira um subcircuito proprio (Circuito), cujas entradas sao as
+/// entradas do circuito e os sinais cortados que ela usa, e cujas saidas sao os seus
+/// sinais cortados e os que vao para as saidas do circuito. Apenas esses sinais
+/// precisam ser trocados entre as particoes (o "buffer de troca").
+/// Os circuitos com instancias de modulos sao achatados antes.
+///
+
+class ParticionamentoCircuito {
+private:
+  int Nin;
+  // A particao de cada porta (indice do circuito compilado achatado) e o seu nivel
+  std::vector<int> particao;
+  std::vector<int> nivel;
+  int num_cortes;
+  // Os subcircuitos das particoes, e os indices dos sinais (do circuito compilado
+  // achatado) correspondentes as suas entradas e saidas
+  std::vector<Circuito> partes;
+  std::vector<std::vector<int>> entradas, saidas;
+  // A posicao de cada sinal no buffer de troca (-1: sinal nao trocado)
+  std::vector<int> pos_troca;
+  int num_troca;
+  // O indice do sinal de origem de cada saida do circuito
+  std::vector<int> idx_saida;
+
+  // Refina as particoes por movimentos de portas da fronteira (ver acima)
+  void refinar(const CircuitoCompilado& P, int K, double Desbalanco);
+  // Monta os subcircuitos e o buffer de troca
+  bool montar(const CircuitoCompilado& P, int K);
+
+public:
+  // Particionamento vazio
+  ParticionamentoCircuito();
+
+  // Divide o circuito C em ateh K particoes (menos se houver poucas portas), com o
+  // peso de cada particao no maximo (1+Desbalanco) vezes a media
+  // Retorna false (e fica vazio) se C for invalido ou tiver realimentacao
+  bool particionar(Circuito& C, int K, double Desbalanco=0.1);
+
+  void clear();
+  bool valid() const;
+  int getNumParticoes() const;
+  int getNumInputs() const;
+  int getNumOutputs() const;
+
+  // A particao e o nivel da porta de indice IP (do circuito achatado)
+  int getParticao(int IP) const;
+  int getNivel(int IP) const;
+  // O numero de sinais cortados (usados fora da sua particao)
+  int getNumCortes() const;
+
+  // O subcircuito da particao p e os sinais correspondentes as suas entradas e
+  // saidas (indices de sinal do circuito achatado: entradas de 0 a Nin-1)
+  const Circuito& getSubcircuito(int p) const;
+  const std::vector<int>& getEntradas(int p) const;
+  const std::vector<int>& getSaidas(int p) const;
+
+  // O buffer de troca: a posicao do sinal S (-1: nao trocado) e o numero de sinais
+  int getPosTroca(int S) const;
+  int getNumTroca() const;
+  // O indice do sinal de origem da saida do circuito de indice IO (0 a Nout-1):
+  // uma entrada do circuito ou um sinal do buffer de troca
+  int getIndiceSaida(int IO) const;
+};
+
+#endif // _PARTICIONAMENTO_H_
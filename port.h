@@ -83,6 +83,11 @@ public:
   // Deve ser utilizada para imprimir uma porta
   virtual std::string getName() const = 0;
 
+  // Funcao virtual pura que retorna a sigla do tipo da porta (AN, NT, SB, etc.), em
+  // uma string estatica (interna, nunca alocada nem liberada). Eh igual a getName,
+  // exceto nas portas SB, cujo nome tambem tem o modulo e a saida
+  virtual const char* getSigla() const = 0;
+
   // Caracteristicas da porta
   int getNumInputs() const;
 
@@ -185,6 +190,7 @@ public:
   ptr_Port clone() const;
   // Retorna "NT"
   std::string getName() const;
+  const char* getSigla() const;
 
   bool validNumInputs(int NI) const;
 
@@ -208,6 +214,7 @@ public:
   ptr_Port clone() const;
   // Retorna "AN"
   std::string getName() const;
+  const char* getSigla() const;
 
   // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
   // se no for, faz out_port <- UNDEF e retorna.
@@ -223,6 +230,7 @@ public:
   ptr_Port clone() const;
   // Retorna "NA"
   std::string getName() const;
+  const char* getSigla() const;
 
   // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
   // se nao for, faz out_port <- UNDEF e retorna.
@@ -238,6 +246,7 @@ public:
   ptr_Port clone() const;
   // Retorna "OR"
   std::string getName() const;
+  const char* getSigla() const;
 
   // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
   // se nao for, faz out_port <- UNDEF e retorna.
@@ -253,6 +262,7 @@ public:
   ptr_Port clone() const;
   // Retorna "NO"
   std::string getName() const;
+  const char* getSigla() const;
 
   // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
   // se nao for, faz out_port <- UNDEF e retorna.
@@ -268,6 +278,7 @@ public:
   ptr_Port clone() const;
   // Retorna "XO"
   std::string getName() const;
+  const char* getSigla() const;
 
   // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
   // se nao for, faz out_port <- UNDEF e retorna.
@@ -283,6 +294,7 @@ public:
   ptr_Port clone() const;
   // Retorna "NX"
   std::string getName() const;
+  const char* getSigla() const;
 
   // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta;
   // se nao for, faz out_port <- UNDEF e retorna.
@@ -291,4 +303,48 @@ public:
   void simular(const std::vector<bool3S>& in_port);
 };
 
+///
+/// O FLIP-FLOP TIPO D
+///
+/// Elemento de memoria com uma entrada (D) e um relogio implicito, comum a todos os
+/// flip-flops do circuito. A saida (Q) eh o valor guardado, que soh muda na borda do
+/// relogio (clock), quando passa a ser o valor da entrada D naquele momento.
+/// Nos arquivos, eh o tipo FF ("id) FF 1: idD").
+/// Na simulacao combinacional (simular), a saida eh o valor guardado, e nao depende do
+/// valor atual da entrada: um flip-flop recem-criado guarda ?. A simulacao com relogio
+/// de circuitos com flip-flops eh feita por SimulacaoSincrona
+///
+
+class Port_DFF: public Port {
+private:
+  // O valor guardado (Q)
+  bool3S estado;
+
+public:
+  Port_DFF();
+  // Retorna new Port_DFF(*this)
+  ptr_Port clone() const;
+  // Retorna "FF"
+  std::string getName() const;
+  const char* getSigla() const;
+
+  bool validNumInputs(int NI) const;
+
+  // Leh um flip-flop do teclado: apenas a id da entrada D (como na porta NOT)
+  void digitar();
+
+  // Testa se a dimensao do vetor in_port eh igual ao numero de entradas da porta (1);
+  // se nao for, faz out_port <- UNDEF e retorna.
+  // A saida eh o valor guardado
+  void simular(const std::vector<bool3S>& in_port);
+
+  // Borda do relogio: guarda o valor da entrada D (in_port com dimensao 1) e o
+  // coloca na saida
+  void clock(const std::vector<bool3S>& in_port);
+
+  // O valor guardado e a sua alteracao direta (por exemplo, para o estado inicial)
+  bool3S getEstado() const;
+  void setEstado(bool3S Q);
+};
+
 #endif // _PORT_H_
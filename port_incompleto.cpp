@@ -246,6 +246,11 @@ ptr_Port Port_NOT::clone() const
 
 ///OK
 std::string Port_NOT::getName() const
+{
+  return getSigla();
+}
+
+const char* Port_NOT::getSigla() const
 {
   return "NT";
 }
@@ -299,6 +304,11 @@ ptr_Port Port_AND::clone() const
 
 ///OK
 std::string Port_AND::getName() const
+{
+    return getSigla();
+}
+
+const char* Port_AND::getSigla() const
 {
     return "AN";
 }
@@ -340,6 +350,11 @@ ptr_Port Port_NAND::clone() const
 
 ///OK
 std::string Port_NAND::getName() const
+{
+    return getSigla();
+}
+
+const char* Port_NAND::getSigla() const
 {
     return "NA";
 }
@@ -380,6 +395,11 @@ ptr_Port Port_OR::clone() const
 
 ///OK
 std::string Port_OR::getName() const
+{
+    return getSigla();
+}
+
+const char* Port_OR::getSigla() const
 {
     return "OR";
 }
@@ -418,6 +438,11 @@ ptr_Port Port_NOR::clone() const
 
 ///OK
 std::string Port_NOR::getName() const
+{
+    return getSigla();
+}
+
+const char* Port_NOR::getSigla() const
 {
     return "NO";
 }
@@ -458,6 +483,11 @@ ptr_Port Port_XOR::clone() const
 
 ///OK
 std::string Port_XOR::getName() const
+{
+    return getSigla();
+}
+
+const char* Port_XOR::getSigla() const
 {
     return "XO";
 }
@@ -496,6 +526,11 @@ ptr_Port Port_NXOR::clone() const
 
 ///OK
 std::string Port_NXOR::getName() const
+{
+    return getSigla();
+}
+
+const char* Port_NXOR::getSigla() const
 {
     return "NX";
 }
@@ -518,3 +553,72 @@ void Port_NXOR::simular(const std::vector<bool3S>& in_port)
 
     out_port = ~out_port;
 }
+
+//FLIP-FLOP D
+
+Port_DFF::Port_DFF():
+    Port(1), estado(bool3S::UNDEF)
+{
+
+}
+
+ptr_Port Port_DFF::clone() const
+{
+    return new Port_DFF(*this);
+}
+
+std::string Port_DFF::getName() const
+{
+    return getSigla();
+}
+
+const char* Port_DFF::getSigla() const
+{
+    return "FF";
+}
+
+bool Port_DFF::validNumInputs(int NI) const
+{
+    return(NI == 1);
+}
+
+void Port_DFF::digitar()
+{
+    int id;
+
+    do
+    {
+        std::cout << "Digite o ID da entrada D do flip-flop: " << std::endl;
+        std::cin >> id;
+    }while(id == 0);
+
+    setId_in(0, id);
+}
+
+void Port_DFF::simular(const std::vector<bool3S>& in_port)
+{
+    if(in_port.size() != 1)
+    {
+        out_port = bool3S::UNDEF;
+        return;
+    }
+
+    out_port = estado;
+}
+
+void Port_DFF::clock(const std::vector<bool3S>& in_port)
+{
+    estado = (in_port.size() == 1 ? in_port[0] : bool3S::UNDEF);
+    out_port = estado;
+}
+
+bool3S Port_DFF::getEstado() const
+{
+    return estado;
+}
+
+void Port_DFF::setEstado(bool3S Q)
+{
+    estado = Q;
+    out_port = estado;
+}
@@ -0,0 +1,383 @@
+#include <cctype>
+#include <numeric>
+#include "registro_portas.h"
+
+///
+/// Funcoes auxiliares dos tipos pre-definidos
+///
+
+// Kernels das portas basicas (AND, OR ou XOR de N entradas, invertida ou nao)
+template<OpPorta OP, bool INV>
+static KernelPorta kernelBasico(int N)
+{
+  return selecionarKernel(OP,INV,N);
+}
+
+template<OpPorta OP, bool INV>
+static KernelLote kernelBasicoLote(int N)
+{
+  return selecionarKernelLote(OP,INV,N);
+}
+
+// Kernels que nao dependem do numero de entradas
+template<KernelPorta K>
+static KernelPorta kernelFixo(int /*N*/)
+{
+  return K;
+}
+
+template<KernelLote K>
+static KernelLote kernelFixoLote(int /*N*/)
+{
+  return K;
+}
+
+// O nome da funcao do codigo gerado que corresponde a cada operacao
+static const char* nomeOperacao(OpPorta OP)
+{
+  static const char* nome[3] = {"a_", "o_", "x_"};
+  return nome[int(OP)];
+}
+
+// Expressao das portas basicas: OP(OP(x0, x1), x2)..., invertida ou nao
+template<OpPorta OP, bool INV>
+static std::string expressaoBasica(const std::vector<std::string>& In)
+{
+  std::string expr = In.at(0);
+  for (size_t j=1; j<In.size(); j++)
+  {
+    expr = std::string(nomeOperacao(OP)) + "(" + expr + ", " + In[j] + ")";
+  }
+  return (INV ? "n_(" + expr + ")" : expr);
+}
+
+static std::string expressaoMux(const std::vector<std::string>& In)
+{
+  const std::string& sel(In.at(0));
+  const std::string& x0(In.at(1));
+  const std::string& x1(In.at(2));
+  return "o_(o_(a_(n_(" + sel + "), " + x0 + "), a_(" + sel + ", " + x1 + ")), a_(" +
+         x0 + ", " + x1 + "))";
+}
+
+static std::string expressaoMaioria(const std::vector<std::string>& In)
+{
+  const std::string& x0(In.at(0));
+  const std::string& x1(In.at(1));
+  const std::string& x2(In.at(2));
+  return "o_(o_(a_(" + x0 + ", " + x1 + "), a_(" + x0 + ", " + x2 + ")), a_(" +
+         x1 + ", " + x2 + "))";
+}
+
+static std::string expressaoTriState(const std::vector<std::string>& In)
+{
+  const std::string& d(In.at(0));
+  const std::string& h(In.at(1));
+  return "L{" + d + ".t & " + h + ".t, " + d + ".f & " + h + ".t}";
+}
+
+template<OpPorta DENTRO, OpPorta FORA>
+static std::string expressaoPares(const std::vector<std::string>& In)
+{
+  std::string expr;
+  for (size_t j=0; j+1<In.size(); j+=2)
+  {
+    std::string par = std::string(nomeOperacao(DENTRO)) + "(" + In[j] + ", " + In[j+1] + ")";
+    expr = (j==0 ? par : std::string(nomeOperacao(FORA)) + "(" + expr + ", " + par + ")");
+  }
+  return "n_(" + expr + ")";
+}
+
+// A saida do flip-flop na simulacao combinacional: o estado, que eh desconhecido
+static std::string expressaoFlipFlop(const std::vector<std::string>& /*In*/)
+{
+  return "L{0, 0}";
+}
+
+// Cria uma porta de uma classe propria (Port_AND, etc.)
+template<class P>
+static ptr_Port criarPorta()
+{
+  return new P;
+}
+
+///
+/// O REGISTRO
+///
+
+namespace {
+  // O numero de nomes possiveis (2 letras)
+  const int NUM_NOMES = 26*26;
+
+  struct Registro {
+    // Os tipos registrados, indexados pelo codigo
+    std::vector<TipoPorta> tipos;
+    // O codigo de cada nome, indexado por indiceNome
+    CodigoPorta codigo[NUM_NOMES];
+    // Os nomes (terminados em '\0'), indexados pelo codigo: ao contrario de tipos,
+    // nao mudam de lugar quando um tipo eh incluido
+    char sigla[256][3];
+
+    Registro();
+  };
+
+  // A posicao de um nome de 2 letras (maiusculas ou minusculas) na tabela de
+  // codigos, ou -1 se o nome nao tiver 2 letras
+  inline int indiceNome(const std::string& Nome)
+  {
+    if (Nome.size()!=2) return -1;
+    // | 0x20 converte as maiusculas em minusculas; os demais caracteres ficam fora
+    // do intervalo de 0 a 25 (a subtracao sem sinal transforma negativos em grandes)
+    const unsigned c0 = (unsigned(static_cast<unsigned char>(Nome[0])) | 0x20u) - 'a';
+    const unsigned c1 = (unsigned(static_cast<unsigned char>(Nome[1])) | 0x20u) - 'a';
+    if (c0>=26 || c1>=26) return -1;
+    return c0*26+c1;
+  }
+
+  // Inclui um tipo no registro R
+  CodigoPorta incluir(Registro& R, TipoPorta T)
+  {
+    const int pos = indiceNome(T.nome);
+    if (pos<0 || R.codigo[pos]!=CODIGO_INVALIDO) return CODIGO_INVALIDO;
+    if (R.tipos.size()>=CODIGO_INSTANCIA) return CODIGO_INVALIDO;
+    if (T.kernel==nullptr || T.kernel_lote==nullptr || T.expressao==nullptr) return CODIGO_INVALIDO;
+    if (T.min_entradas<1 || T.passo_entradas<1) return CODIGO_INVALIDO;
+
+    T.nome[0] = toupper(T.nome[0]);
+    T.nome[1] = toupper(T.nome[1]);
+    R.codigo[pos] = R.tipos.size();
+    R.sigla[R.codigo[pos]][0] = T.nome[0];
+    R.sigla[R.codigo[pos]][1] = T.nome[1];
+    R.tipos.push_back(T);
+    return R.codigo[pos];
+  }
+
+  // Registra os tipos pre-definidos
+  Registro::Registro():
+    tipos()
+  {
+    for (int i=0; i<NUM_NOMES; i++) codigo[i] = CODIGO_INVALIDO;
+    for (int c=0; c<256; c++)
+    {
+      sigla[c][0] = sigla[c][1] = '?';
+      sigla[c][2] = '\0';
+    }
+    sigla[CODIGO_INSTANCIA][0] = 'S';
+    sigla[CODIGO_INSTANCIA][1] = 'B';
+
+    incluir(*this, {"NT", 1, 1, 1, kernelBasico<OpPorta::AND,true>,
+                    kernelBasicoLote<OpPorta::AND,true>,
+                    expressaoBasica<OpPorta::AND,true>, criarPorta<Port_NOT>});
+    incluir(*this, {"AN", 2, 0, 1, kernelBasico<OpPorta::AND,false>,
+                    kernelBasicoLote<OpPorta::AND,false>,
+                    expressaoBasica<OpPorta::AND,false>, criarPorta<Port_AND>});
+    incluir(*this, {"NA", 2, 0, 1, kernelBasico<OpPorta::AND,true>,
+                    kernelBasicoLote<OpPorta::AND,true>,
+                    expressaoBasica<OpPorta::AND,true>, criarPorta<Port_NAND>});
+    incluir(*this, {"OR", 2, 0, 1, kernelBasico<OpPorta::OR,false>,
+                    kernelBasicoLote<OpPorta::OR,false>,
+                    expressaoBasica<OpPorta::OR,false>, criarPorta<Port_OR>});
+    incluir(*this, {"NO", 2, 0, 1, kernelBasico<OpPorta::OR,true>,
+                    kernelBasicoLote<OpPorta::OR,true>,
+                    expressaoBasica<OpPorta::OR,true>, criarPorta<Port_NOR>});
+    incluir(*this, {"XO", 2, 0, 1, kernelBasico<OpPorta::XOR,false>,
+                    kernelBasicoLote<OpPorta::XOR,false>,
+                    expressaoBasica<OpPorta::XOR,false>, criarPorta<Port_XOR>});
+    incluir(*this, {"NX", 2, 0, 1, kernelBasico<OpPorta::XOR,true>,
+                    kernelBasicoLote<OpPorta::XOR,true>,
+                    expressaoBasica<OpPorta::XOR,true>, criarPorta<Port_NXOR>});
+
+    // O buffer eh uma AND de 1 entrada
+    incluir(*this, {"BF", 1, 1, 1, kernelBasico<OpPorta::AND,false>,
+                    kernelBasicoLote<OpPorta::AND,false>,
+                    expressaoBasica<OpPorta::AND,false>, nullptr});
+    incluir(*this, {"MX", 3, 3, 1, kernelFixo<kernelMux<bool3S>>,
+                    kernelFixoLote<kernelMux<Lote3S>>, expressaoMux, nullptr});
+    incluir(*this, {"MJ", 3, 3, 1, kernelFixo<kernelMaioria<bool3S>>,
+                    kernelFixoLote<kernelMaioria<Lote3S>>, expressaoMaioria, nullptr});
+    incluir(*this, {"TS", 2, 2, 1, kernelFixo<kernelTriState>,
+                    kernelFixoLote<kernelTriState>, expressaoTriState, nullptr});
+    incluir(*this, {"AI", 2, 0, 2, kernelFixo<kernelPares<OpPorta::AND,OpPorta::OR,bool3S>>,
+                    kernelFixoLote<kernelPares<OpPorta::AND,OpPorta::OR,Lote3S>>,
+                    expressaoPares<OpPorta::AND,OpPorta::OR>, nullptr});
+    incluir(*this, {"OI", 2, 0, 2, kernelFixo<kernelPares<OpPorta::OR,OpPorta::AND,bool3S>>,
+                    kernelFixoLote<kernelPares<OpPorta::OR,OpPorta::AND,Lote3S>>,
+                    expressaoPares<OpPorta::OR,OpPorta::AND>, nullptr});
+
+    // O flip-flop: fora da simulacao com relogio, a saida eh o estado, desconhecido
+    incluir(*this, {"FF", 1, 1, 1, kernelFixo<kernelFlipFlop<bool3S>>,
+                    kernelFixoLote<kernelFlipFlop<Lote3S>>, expressaoFlipFlop,
+                    criarPorta<Port_DFF>});
+  }
+
+  // O registro unico, criado no primeiro uso
+  Registro& registro()
+  {
+    static Registro R;
+    return R;
+  }
+}
+
+// Registra um novo tipo de porta e retorna o seu codigo
+CodigoPorta RegistroPortas::registrar(const TipoPorta& T)
+{
+  return incluir(registro(), T);
+}
+
+// Retorna o codigo do tipo de nome Nome, ou CODIGO_INVALIDO se nao existir
+CodigoPorta RegistroPortas::getCodigo(const std::string& Nome)
+{
+  const int pos = indiceNome(Nome);
+  if (pos<0) return CODIGO_INVALIDO;
+  return registro().codigo[pos];
+}
+
+bool RegistroPortas::validCodigo(CodigoPorta Codigo)
+{
+  return Codigo<registro().tipos.size();
+}
+
+const TipoPorta& RegistroPortas::getTipo(CodigoPorta Codigo)
+{
+  return registro().tipos.at(Codigo);
+}
+
+int RegistroPortas::getNumTipos()
+{
+  return registro().tipos.size();
+}
+
+// Retorna o nome do tipo Codigo, sem alocar memoria
+const char* RegistroPortas::getSigla(CodigoPorta Codigo)
+{
+  return registro().sigla[Codigo];
+}
+
+// Retorna os nomes de todos os tipos, separados por virgula
+std::string RegistroPortas::getNomes()
+{
+  std::string prov;
+  for (const TipoPorta& T : registro().tipos)
+  {
+    if (!prov.empty()) prov += ',';
+    prov += T.nome;
+  }
+  return prov;
+}
+
+// Retorna true se NI eh um numero de entradas valido para o tipo Codigo
+bool RegistroPortas::validNumInputs(CodigoPorta Codigo, int NI)
+{
+  if (!validCodigo(Codigo)) return false;
+  const TipoPorta& T(getTipo(Codigo));
+  if (NI<T.min_entradas) return false;
+  if (T.max_entradas>0 && NI>T.max_entradas) return false;
+  return (NI-T.min_entradas)%T.passo_entradas==0;
+}
+
+KernelPorta RegistroPortas::getKernel(CodigoPorta Codigo, int N)
+{
+  if (!validNumInputs(Codigo,N)) return nullptr;
+  return getTipo(Codigo).kernel(N);
+}
+
+KernelLote RegistroPortas::getKernelLote(CodigoPorta Codigo, int N)
+{
+  if (!validNumInputs(Codigo,N)) return nullptr;
+  return getTipo(Codigo).kernel_lote(N);
+}
+
+// Cria uma porta do tipo Codigo
+ptr_Port RegistroPortas::criar(CodigoPorta Codigo)
+{
+  if (!validCodigo(Codigo)) return nullptr;
+  const TipoPorta& T(getTipo(Codigo));
+  if (T.criar!=nullptr) return T.criar();
+  return new Port_Registrada(Codigo);
+}
+
+///
+/// A PORTA DE UM TIPO REGISTRADO
+///
+
+Port_Registrada::Port_Registrada(CodigoPorta Codigo):
+  Port(RegistroPortas::validCodigo(Codigo) ? RegistroPortas::getTipo(Codigo).min_entradas : 0),
+  codigo(Codigo)
+{
+}
+
+ptr_Port Port_Registrada::clone() const
+{
+  return new Port_Registrada(*this);
+}
+
+std::string Port_Registrada::getName() const
+{
+  return getSigla();
+}
+
+const char* Port_Registrada::getSigla() const
+{
+  // Os codigos invalidos tem a sigla "??"
+  return RegistroPortas::getSigla(codigo);
+}
+
+CodigoPorta Port_Registrada::getCodigo() const
+{
+  return codigo;
+}
+
+bool Port_Registrada::validNumInputs(int NI) const
+{
+  return RegistroPortas::validNumInputs(codigo,NI);
+}
+
+// Leh a porta do teclado; o numero de entradas soh eh pedido se puder variar
+void Port_Registrada::digitar()
+{
+  if (!RegistroPortas::validCodigo(codigo)) return;
+  const TipoPorta& T(RegistroPortas::getTipo(codigo));
+  if (T.min_entradas!=T.max_entradas)
+  {
+    Port::digitar();
+    return;
+  }
+  for (int i=0; i<getNumInputs(); i++)
+  {
+    int id;
+    do
+    {
+      std::cout << "  Entrada " << i << " da porta: ";
+      std::cin >> id;
+    }
+    while (id==0);
+    setId_in(i,id);
+  }
+}
+
+// Os indices 0 a N-1, para os kernels lerem as entradas em sequencia
+// O vetor eh compartilhado por todas as portas da thread e soh cresce
+static const int* indicesSequenciais(int N)
+{
+  static thread_local std::vector<int> idx;
+  if (int(idx.size())<N)
+  {
+    const int N0 = idx.size();
+    idx.resize(N);
+    std::iota(idx.begin()+N0,idx.end(),N0);
+  }
+  return idx.data();
+}
+
+// Simula a porta pelo kernel do tipo (as entradas em in_port estao em sequencia)
+void Port_Registrada::simular(const std::vector<bool3S>& in_port)
+{
+  if (!testValidSizeInputs(in_port)) return;
+  KernelPorta K = RegistroPortas::getKernel(codigo,getNumInputs());
+  if (K==nullptr)
+  {
+    out_port = bool3S::UNDEF;
+    return;
+  }
+  out_port = K(in_port.data(),indicesSequenciais(getNumInputs()),getNumInputs());
+}
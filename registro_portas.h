@@ -0,0 +1,138 @@
+#ifndef _REGISTRO_PORTAS_H_
+#define _REGISTRO_PORTAS_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "lote3S.h"
+#include "kernels.h"
+#include "port.h"
+
+///
+/// REGISTRO DOS TIPOS DE PORTA
+///
+/// Cada tipo de porta (NT, AN, MX, etc.) eh identificado por um codigo compacto
+/// (CodigoPorta), atribuido na ordem de registro. O registro guarda, para cada tipo:
+/// - o nome de 2 letras usado nos arquivos de circuito;
+/// - o numero de entradas aceito;
+/// - os kernels de simulacao (bool3S e Lote3S), escolhidos pelo numero de entradas;
+/// - a expressao usada pelo codigo gerado pelo simulador nativo;
+/// - opcionalmente, a funcao que cria a porta (para tipos com classe propria).
+/// A consulta pelo nome eh uma indexacao direta em uma tabela de 26x26 codigos,
+/// sem comparacao de strings. Novos tipos de porta podem ser registrados
+/// (registrar) sem alterar o Circuito nem o CircuitoCompilado; as portas desses
+/// tipos sao da classe Port_Registrada.
+///
+/// Tipos pre-definidos (nesta ordem de codigo):
+///   NT AN NA OR NO XO NX: as portas basicas
+///   BF: buffer (1 entrada)
+///   MX: multiplexador (sel, x0, x1)
+///   MJ: maioria de 3 entradas
+///   TS: tri-state (dado, habilita)
+///   AI: AND-OR-INVERT com as entradas em pares (2, 4, 6, ... entradas)
+///   OI: OR-AND-INVERT com as entradas em pares (2, 4, 6, ... entradas)
+///   FF: flip-flop tipo D (1 entrada, D; classe Port_DFF). Nas simulacoes
+///       combinacionais a saida eh o valor guardado, desconhecido (?); os ciclos de
+///       relogio sao simulados por SimulacaoSincrona
+///
+/// O registro nao eh protegido contra uso simultaneo por varias threads: novos tipos
+/// devem ser registrados antes de ler ou simular circuitos em paralelo.
+///
+
+// O codigo compacto de um tipo de porta
+typedef uint8_t CodigoPorta;
+// Codigo que nao corresponde a nenhum tipo
+constexpr CodigoPorta CODIGO_INVALIDO = 0xFF;
+// Codigo reservado para as instancias de modulo (portas SB) nas portas do Circuito;
+// nunca eh atribuido a um tipo registrado
+constexpr CodigoPorta CODIGO_INSTANCIA = 0xFE;
+
+// A descricao de um tipo de porta
+struct TipoPorta {
+  // O nome (2 letras maiusculas)
+  std::string nome;
+  // Os numeros de entradas aceitos: de min_entradas a max_entradas
+  // (max_entradas<=0: sem limite), variando de passo_entradas em passo_entradas
+  int min_entradas;
+  int max_entradas;
+  int passo_entradas;
+  // Os kernels para N entradas
+  KernelPorta (*kernel)(int N);
+  KernelLote (*kernel_lote)(int N);
+  // A expressao C++ da saida da porta, a partir das expressoes das entradas,
+  // usando o tipo L e as funcoes n_, a_, o_ e x_ do codigo gerado (ver
+  // SimuladorNativo::gerarCodigo)
+  std::string (*expressao)(const std::vector<std::string>& In);
+  // Cria (new) uma porta do tipo. Se nullptr, cria uma Port_Registrada
+  ptr_Port (*criar)();
+};
+
+class RegistroPortas {
+public:
+  // Registra um novo tipo de porta e retorna o seu codigo
+  // Retorna CODIGO_INVALIDO se o nome nao tiver 2 letras, jah estiver registrado,
+  // se faltar algum kernel ou a expressao, ou se nao houver mais codigos livres
+  static CodigoPorta registrar(const TipoPorta& T);
+
+  // Retorna o codigo do tipo de nome Nome (maiusculas ou minusculas),
+  // ou CODIGO_INVALIDO se nao existir
+  static CodigoPorta getCodigo(const std::string& Nome);
+  // Retorna true se Codigo eh o codigo de um tipo registrado
+  static bool validCodigo(CodigoPorta Codigo);
+  // Retorna a descricao do tipo (Codigo deve ser valido)
+  static const TipoPorta& getTipo(CodigoPorta Codigo);
+  // Retorna o numero de tipos registrados
+  static int getNumTipos();
+  // Retorna o nome do tipo Codigo em uma string estatica (interna): o endereco nunca
+  // muda, inclusive quando novos tipos sao registrados, e a consulta nao aloca memoria
+  // Retorna "SB" para CODIGO_INSTANCIA e "??" para um codigo invalido
+  static const char* getSigla(CodigoPorta Codigo);
+  // Retorna os nomes de todos os tipos, separados por virgula (NT,AN,...)
+  static std::string getNomes();
+
+  // Retorna true se NI eh um numero de entradas valido para o tipo Codigo
+  static bool validNumInputs(CodigoPorta Codigo, int NI);
+  // Os kernels do tipo Codigo para N entradas, ou nullptr se N nao for valido
+  static KernelPorta getKernel(CodigoPorta Codigo, int N);
+  static KernelLote getKernelLote(CodigoPorta Codigo, int N);
+
+  // Cria (new) uma porta do tipo Codigo, sem entradas definidas
+  // Retorna nullptr se o codigo nao for valido
+  static ptr_Port criar(CodigoPorta Codigo);
+};
+
+///
+/// A PORTA DE UM TIPO REGISTRADO
+///
+/// Porta generica cujo comportamento (nome, numero de entradas e simulacao) vem
+/// do registro de tipos. Usada para os tipos sem classe propria (BF, MX, etc.)
+///
+
+class Port_Registrada: public Port {
+private:
+  CodigoPorta codigo;
+
+public:
+  // Cria uma porta do tipo Codigo, com o menor numero de entradas aceito
+  explicit Port_Registrada(CodigoPorta Codigo);
+  // Retorna new Port_Registrada(*this)
+  ptr_Port clone() const;
+  // Retorna o nome do tipo
+  std::string getName() const;
+  const char* getSigla() const;
+  // Retorna o codigo do tipo
+  CodigoPorta getCodigo() const;
+
+  // Retorna true se NI eh um numero de entradas aceito pelo tipo
+  bool validNumInputs(int NI) const;
+
+  // Leh a porta do teclado. O numero de entradas soh eh pedido se o tipo
+  // aceitar mais de um
+  void digitar();
+
+  // Simula a porta pelo kernel do tipo
+  void simular(const std::vector<bool3S>& in_port);
+};
+
+#endif // _REGISTRO_PORTAS_H_
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include "resolucao_indefinidos.h"
+#include "circuito.h"
+
+///
+/// CLASSE RESOLUCAO DE INDEFINIDOS
+///
+
+ResolucaoIndefinidos::ResolucaoIndefinidos(Circuito& C):
+  programa(C.getCompilado()), max_divisoes(20), saidas(), exata(), num_lotes(0),
+  entrada(), sinais(), in_lote(), sinais_lote(), out_lote(), peso(), visitado(), pilha()
+{
+  if (!programa) return;
+  sinais.resize(programa->getNumSinais());
+  in_lote.resize(programa->getNumInputs());
+  sinais_lote.resize(programa->getNumSinais());
+  out_lote.resize(programa->getNumOutputs());
+  peso.resize(programa->getNumInputs(),0);
+  visitado.resize(programa->getNumSinais(),0);
+}
+
+bool ResolucaoIndefinidos::valid() const
+{
+  return programa!=nullptr;
+}
+
+void ResolucaoIndefinidos::setMaxDivisoes(int N)
+{
+  max_divisoes = std::max(1,std::min(62,N));
+}
+
+int ResolucaoIndefinidos::getMaxDivisoes() const
+{
+  return max_divisoes;
+}
+
+// Percorre o cone de entrada da saida IO apenas pelos sinais ?
+// Um sinal definido tem o mesmo valor em todas as substituicoes, entao as entradas
+// ? que soh chegam aa saida passando por sinais definidos nao influem nela
+void ResolucaoIndefinidos::entradasRelevantes(int IO, std::vector<int>& Rel)
+{
+  const int Nin = programa->getNumInputs();
+  Rel.clear();
+  pilha.clear();
+
+  const int S0 = programa->getIndiceSaida(IO);
+  visitado[S0] = 1;
+  pilha.push_back(S0);
+  std::vector<int> percorridos(1,S0);
+  while (!pilha.empty())
+  {
+    const int S = pilha.back();
+    pilha.pop_back();
+    if (S<Nin)
+    {
+      Rel.push_back(S);
+      continue;
+    }
+    const int IP = S-Nin;
+    for (int I=0; I<programa->getNumInputsPorta(IP); I++)
+    {
+      const int T = programa->getIndiceEntrada(IP,I);
+      if (sinais[T]!=bool3S::UNDEF) continue;
+      if (T<Nin) peso[T]++;
+      if (!visitado[T])
+      {
+        visitado[T] = 1;
+        percorridos.push_back(T);
+        pilha.push_back(T);
+      }
+    }
+  }
+
+  std::stable_sort(Rel.begin(),Rel.end(),[this](int E1, int E2) {return peso[E1]>peso[E2];});
+  for (int S : percorridos) visitado[S] = 0;
+  for (int E : Rel) peso[E] = 0;
+}
+
+// Resolve a saida de indice IO dividindo os casos pelas entradas Rel, na ordem
+// Cada caso eh uma mascara com os valores (1: T) das entradas jah divididas. A cada
+// passo, os casos ainda ? sao divididos pelas D entradas seguintes, com D escolhido
+// para preencher as 64 pistas (ao menos 1), e os filhos sao simulados 64 por vez
+void ResolucaoIndefinidos::resolver(int IO, const std::vector<int>& Rel)
+{
+  const int K = std::min<int>(Rel.size(),max_divisoes);
+  const int NI = programa->getNumInputs();
+  std::vector<uint64_t> casos(1,0), prox;
+  bool3S comum = bool3S::UNDEF;
+
+  for (int i=0; i<NI; i++) in_lote[i] = lote3S(entrada[i]);
+  for (int L=0; L<K; )
+  {
+    int D = 1;
+    while (L+D<K && (casos.size() << (D+1))<=size_t(NUM_PISTAS)) D++;
+    const size_t total = casos.size() << D;
+    const bool ultimo = (L+D==int(Rel.size()));
+    prox.clear();
+    for (size_t base=0; base<total; base+=NUM_PISTAS)
+    {
+      const int NP = std::min<size_t>(NUM_PISTAS,total-base);
+      // O caso da pista k eh o filho c=base+k: o caso pai c>>D com os bits L a L+D-1
+      // iguais aos D bits baixos de c
+      uint64_t caso[NUM_PISTAS];
+      for (int k=0; k<NP; k++)
+      {
+        const size_t c = base+k;
+        caso[k] = casos[c >> D] | (uint64_t(c & ((size_t(1) << D)-1)) << L);
+      }
+      const uint64_t pistas = (NP==NUM_PISTAS ? ~uint64_t(0) : (uint64_t(1) << NP)-1);
+      for (int j=0; j<L+D; j++)
+      {
+        uint64_t t = 0;
+        for (int k=0; k<NP; k++) t |= ((caso[k] >> j) & 1) << k;
+        in_lote[Rel[j]] = Lote3S{t, ~t & pistas};
+      }
+      programa->simularLote(in_lote.data(),sinais_lote.data(),out_lote.data());
+      num_lotes++;
+
+      for (int k=0; k<NP; k++)
+      {
+        const bool3S v = getPista(out_lote[IO],k);
+        if (v==bool3S::UNDEF)
+        {
+          // Com todas as entradas relevantes fixadas, a saida continua ?
+          if (ultimo) return;
+          prox.push_back(caso[k]);
+        }
+        else if (comum==bool3S::UNDEF) comum = v;
+        // Dois casos discordam: a saida exata eh ?
+        else if (v!=comum) return;
+      }
+    }
+    casos.swap(prox);
+    if (casos.empty())
+    {
+      saidas[IO] = comum;
+      return;
+    }
+    L += D;
+  }
+  // Atingiu o limite de divisoes sem resolver
+  exata[IO] = 0;
+}
+
+// Simula o vetor de entrada in_circ, resolvendo as saidas ?
+bool ResolucaoIndefinidos::simular(const std::vector<bool3S>& in_circ)
+{
+  if (!programa || int(in_circ.size())!=programa->getNumInputs()) return false;
+
+  const int NO = programa->getNumOutputs();
+  entrada = in_circ;
+  saidas.resize(NO);
+  exata.assign(NO,1);
+  num_lotes = 0;
+  programa->simular(entrada.data(),sinais.data(),saidas.data());
+
+  std::vector<int> rel;
+  for (int IO=0; IO<NO; IO++)
+  {
+    if (saidas[IO]!=bool3S::UNDEF) continue;
+    entradasRelevantes(IO,rel);
+    // Sem entradas ? no cone, a saida eh ? em qualquer substituicao
+    if (!rel.empty()) resolver(IO,rel);
+  }
+  return true;
+}
+
+bool3S ResolucaoIndefinidos::getOutput(int IdOutput) const
+{
+  if (IdOutput<1 || IdOutput>int(saidas.size())) return bool3S::UNDEF;
+  return saidas[IdOutput-1];
+}
+
+bool ResolucaoIndefinidos::isExata(int IdOutput) const
+{
+  if (IdOutput<1 || IdOutput>int(exata.size())) return false;
+  return exata[IdOutput-1];
+}
+
+uint64_t ResolucaoIndefinidos::getNumLotes() const
+{
+  return num_lotes;
+}
@@ -0,0 +1,85 @@
+#ifndef _RESOLUCAO_INDEFINIDOS_H_
+#define _RESOLUCAO_INDEFINIDOS_H_
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "bool3S.h"
+#include "lote3S.h"
+#include "circuito_compilado.h"
+
+class Circuito;
+
+///
+/// CLASSE RESOLUCAO DE INDEFINIDOS
+///
+/// A simulacao com bool3S eh pessimista: X AND NOT X resulta em ? (e nao em F), pois
+/// cada porta so ve o valor ? das entradas, e nao a correlacao entre elas. O valor
+/// exato de uma saida, para um vetor com entradas ?, eh o valor comum a todas as
+/// substituicoes das entradas ? por T e F (ou ?, se as substituicoes discordarem).
+/// Em vez de simular as 2^k substituicoes das k entradas ?, a resolucao:
+/// - simula o vetor com bool3S: as saidas definidas jah sao exatas (nenhuma
+///   substituicao muda um valor definido);
+/// - para cada saida ?, percorre o seu cone de entrada apenas pelos sinais ?: as
+///   entradas ? alcancadas sao as unicas que podem influir na saida, e sao ordenadas
+///   pelo numero de portas ? do cone que as usam diretamente (as mais usadas primeiro);
+/// - divide os casos uma entrada por vez (T e F), simulando as divisoes 64 por vez
+///   (simularLote, uma divisao por pista): um caso cuja saida ficou definida nao
+///   precisa mais ser dividido; a resolucao termina quando todos os casos ficam
+///   definidos com o mesmo valor, ou quando dois casos discordam ou um caso com todas
+///   as entradas relevantes fixadas continua ? (a saida exata eh ?).
+/// O numero de entradas divididas por saida eh limitado (setMaxDivisoes); uma saida
+/// que atinge o limite fica ? e eh marcada como nao exata (isExata).
+///
+
+class ResolucaoIndefinidos {
+private:
+  // O circuito compilado (nullptr se o circuito for invalido)
+  std::shared_ptr<const CircuitoCompilado> programa;
+  // O maior numero de entradas divididas por saida
+  int max_divisoes;
+
+  // O resultado da ultima simulacao
+  std::vector<bool3S> saidas;
+  std::vector<char> exata;
+  uint64_t num_lotes;
+
+  // Os vetores de trabalho
+  std::vector<bool3S> entrada, sinais;
+  std::vector<Lote3S> in_lote, sinais_lote, out_lote;
+  // O numero de portas ? do cone que usam cada entrada (0: entrada fora do cone)
+  std::vector<int> peso;
+  std::vector<char> visitado;
+  std::vector<int> pilha;
+
+  // Retorna em Rel as entradas (indices) ? que podem influir na saida de indice IO,
+  // em ordem decrescente de peso
+  void entradasRelevantes(int IO, std::vector<int>& Rel);
+  // Resolve a saida de indice IO dividindo os casos pelas entradas Rel
+  void resolver(int IO, const std::vector<int>& Rel);
+
+public:
+  // Compila o circuito C. Limite padrao: 20 entradas divididas por saida
+  explicit ResolucaoIndefinidos(Circuito& C);
+
+  // Retorna true se o circuito era valido na construcao
+  bool valid() const;
+
+  // O maior numero de entradas divididas por saida (1 a 62)
+  void setMaxDivisoes(int N);
+  int getMaxDivisoes() const;
+
+  // Simula o vetor de entrada in_circ (com getNumInputs() valores), resolvendo as
+  // saidas ?. Retorna false se o circuito for invalido ou a dimensao errada
+  bool simular(const std::vector<bool3S>& in_circ);
+
+  // Os resultados da ultima simulacao
+  // O valor exato da saida IdOutput (1 a Nout), ou ? se nao foi possivel resolver
+  bool3S getOutput(int IdOutput) const;
+  // Retorna false se a saida IdOutput atingiu o limite de divisoes
+  bool isExata(int IdOutput) const;
+  // O numero de simulacoes de 64 casos feitas na resolucao
+  uint64_t getNumLotes() const;
+};
+
+#endif // _RESOLUCAO_INDEFINIDOS_H_
@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <memory>
+#include "simulacao_sincrona.h"
+#include "circuito.h"
+#include "circuito_compilado.h"
+#include "estimulos.h"
+#include "registro_portas.h"
+
+///
+/// CLASSE SIMULACAO SINCRONA
+///
+
+// Cria uma simulacao sem circuito
+SimulacaoSincrona::SimulacaoSincrona():
+  Nin(0), Nout(0), NS(0), num_lotes(0), instr(), idx_in(), num_niveis(0), idx_out(),
+  ff_q(), ff_d(), indice_ff(), sinais(), proximo(), entradas(), saidas(), ciclo(0)
+{
+}
+
+// Prepara a simulacao do circuito C
+// A ordem de nivel eh obtida pelo algoritmo de Kahn sobre as ligacoes entre portas
+// combinacionais (as ligacoes que saem de flip-flops nao contam), seguido de uma
+// ordenacao estavel das portas pelo nivel
+bool SimulacaoSincrona::iniciar(Circuito& C, int NumLotes)
+{
+  *this = SimulacaoSincrona();
+  if (NumLotes<1) return false;
+
+  std::shared_ptr<const CircuitoCompilado> P = C.getCompilado();
+  if (P && P->isHierarquico())
+  {
+    // Os flip-flops dos modulos passam a ser portas do circuito achatado
+    std::shared_ptr<CircuitoCompilado> plano = std::make_shared<CircuitoCompilado>();
+    if (plano->compilar(C.achatar())) P = plano;
+    else P.reset();
+  }
+  if (!P) return false;
+
+  const CodigoPorta FF = RegistroPortas::getCodigo("FF");
+  const int NI = P->getNumInputs();
+  const int NP = P->getNumPorts();
+
+  // Os flip-flops
+  std::vector<int> indice(NP,-1);
+  for (int i=0; i<NP; i++)
+  {
+    if (P->getCodigoPorta(i)!=FF) continue;
+    indice[i] = ff_q.size();
+    ff_q.push_back(NI+i);
+    ff_d.push_back(P->getIndiceEntrada(i,0));
+  }
+
+  // As entradas de cada porta combinacional que vem de outras portas combinacionais
+  std::vector<int> pendentes(NP,0), nivel(NP,0), prontas;
+  for (int i=0; i<NP; i++)
+  {
+    if (indice[i]>=0) continue;
+    for (int j=0; j<P->getNumInputsPorta(i); j++)
+    {
+      const int s = P->getIndiceEntrada(i,j);
+      if (s>=NI && indice[s-NI]<0) pendentes[i]++;
+    }
+    if (pendentes[i]==0) prontas.push_back(i);
+  }
+  for (size_t k=0; k<prontas.size(); k++)
+  {
+    const int i = prontas[k];
+    const int S = NI+i;
+    for (int f=0; f<P->getNumFanout(S); f++)
+    {
+      const int q = P->getFanout(S)[f];
+      if (indice[q]>=0) continue;
+      nivel[q] = std::max(nivel[q], nivel[i]+1);
+      if (--pendentes[q]==0) prontas.push_back(q);
+    }
+  }
+  // Alguma porta combinacional nunca ficou pronta: realimentacao sem flip-flop
+  if (prontas.size()+ff_q.size()!=size_t(NP))
+  {
+    *this = SimulacaoSincrona();
+    return false;
+  }
+  std::stable_sort(prontas.begin(), prontas.end(),
+                   [&nivel](int a, int b) {return nivel[a]<nivel[b];});
+
+  // As instrucoes, com as entradas em sequencia na ordem de simulacao
+  for (int i : prontas)
+  {
+    const int N = P->getNumInputsPorta(i);
+    instr.push_back(Instrucao{RegistroPortas::getKernelLote(P->getCodigoPorta(i),N),
+                              int(idx_in.size()), N, NI+i});
+    for (int j=0; j<N; j++) idx_in.push_back(P->getIndiceEntrada(i,j));
+    num_niveis = std::max(num_niveis, nivel[i]+1);
+  }
+
+  Nin = NI;
+  Nout = P->getNumOutputs();
+  NS = P->getNumSinais();
+  num_lotes = NumLotes;
+  for (int j=0; j<Nout; j++) idx_out.push_back(P->getIndiceSaida(j));
+  // So as portas do circuito original podem ser consultadas
+  indice.resize(std::min(NP, C.getNumPorts()));
+  indice_ff.swap(indice);
+  sinais.assign(size_t(num_lotes)*NS, lote3S(bool3S::UNDEF));
+  proximo.resize(ff_q.size());
+  ciclo = 0;
+  return true;
+}
+
+// Caracteristicas
+int SimulacaoSincrona::getNumInputs() const
+{
+  return Nin;
+}
+
+int SimulacaoSincrona::getNumOutputs() const
+{
+  return Nout;
+}
+
+int SimulacaoSincrona::getNumFlipFlops() const
+{
+  return ff_q.size();
+}
+
+int SimulacaoSincrona::getNumNiveis() const
+{
+  return num_niveis;
+}
+
+int SimulacaoSincrona::getNumLotes() const
+{
+  return num_lotes;
+}
+
+int SimulacaoSincrona::getNumPistas() const
+{
+  return num_lotes*NUM_PISTAS;
+}
+
+long SimulacaoSincrona::getCiclo() const
+{
+  return ciclo;
+}
+
+/// ***********************
+/// Estado
+/// ***********************
+
+int SimulacaoSincrona::indiceFlipFlop(int IdPort) const
+{
+  if (IdPort<1 || IdPort>int(indice_ff.size())) return -1;
+  return indice_ff[IdPort-1];
+}
+
+// Volta ao ciclo 0, com todos os flip-flops iguais a Valor
+// (os demais sinais sao recalculados no proximo passo)
+void SimulacaoSincrona::reiniciar(bool3S Valor)
+{
+  std::fill(sinais.begin(), sinais.end(), lote3S(bool3S::UNDEF));
+  const Lote3S V = lote3S(Valor);
+  for (int L=0; L<num_lotes; L++)
+  {
+    Lote3S* S = sinais.data()+size_t(L)*NS;
+    for (int q : ff_q) S[q] = V;
+  }
+  ciclo = 0;
+}
+
+bool SimulacaoSincrona::setEstado(int IdPort, int L, Lote3S Valor)
+{
+  const int f = indiceFlipFlop(IdPort);
+  if (f<0 || L<0 || L>=num_lotes) return false;
+  // Normaliza as pistas com os dois bits iguais a 1 (invalidas) para ?
+  const uint64_t ambos = Valor.t & Valor.f;
+  sinais[size_t(L)*NS+ff_q[f]] = Lote3S{Valor.t & ~ambos, Valor.f & ~ambos};
+  return true;
+}
+
+Lote3S SimulacaoSincrona::getEstado(int IdPort, int L) const
+{
+  const int f = indiceFlipFlop(IdPort);
+  if (f<0 || L<0 || L>=num_lotes) return lote3S(bool3S::UNDEF);
+  return sinais[size_t(L)*NS+ff_q[f]];
+}
+
+Lote3S SimulacaoSincrona::getSinal(int IdOrig, int L) const
+{
+  if (L<0 || L>=num_lotes) return lote3S(bool3S::UNDEF);
+  int S;
+  if (IdOrig<0 && IdOrig>=-Nin) S = -IdOrig-1;
+  else if (IdOrig>0 && IdOrig<=int(indice_ff.size())) S = Nin+IdOrig-1;
+  else return lote3S(bool3S::UNDEF);
+  return sinais[size_t(L)*NS+S];
+}
+
+/// ***********************
+/// Simulacao
+/// ***********************
+
+// Simula um ciclo de relogio: cada lote eh simulado por inteiro (avaliacao, saidas e
+// borda do relogio) antes do seguinte, enquanto os seus sinais estao na cache
+void SimulacaoSincrona::passo(const Lote3S* in_circ, Lote3S* out_circ)
+{
+  const Instrucao* const I0 = instr.data();
+  const Instrucao* const I1 = I0+instr.size();
+  const int* const idx = idx_in.data();
+  const int NF = ff_q.size();
+
+  for (int L=0; L<num_lotes; L++)
+  {
+    Lote3S* const S = sinais.data()+size_t(L)*NS;
+    std::copy(in_circ+size_t(L)*Nin, in_circ+size_t(L+1)*Nin, S);
+
+    // A logica combinacional, uma unica vez, em ordem de nivel
+    for (const Instrucao* I=I0; I<I1; I++) S[I->destino] = I->kernel(S, idx+I->ini, I->N);
+
+    if (out_circ!=nullptr)
+    {
+      Lote3S* const O = out_circ+size_t(L)*Nout;
+      for (int j=0; j<Nout; j++) O[j] = S[idx_out[j]];
+    }
+
+    // A borda do relogio: primeiro todas as entradas D, depois todas as saidas Q
+    // (um flip-flop alimentado por outro recebe o valor anterior a borda)
+    for (int f=0; f<NF; f++) proximo[f] = S[ff_d[f]];
+    for (int f=0; f<NF; f++) S[ff_q[f]] = proximo[f];
+  }
+  ciclo++;
+}
+
+// Simula NCiclos ciclos com entradas geradas por G
+bool SimulacaoSincrona::executar(long NCiclos, GeradorEstimulos& G, const Observador& Obs)
+{
+  if (G.getNumInputs()!=Nin) return false;
+  entradas.resize(size_t(num_lotes)*Nin);
+  saidas.resize(size_t(num_lotes)*Nout);
+  for (long k=0; k<NCiclos; k++)
+  {
+    G.gerarLotes(entradas.data(), num_lotes);
+    const long atual = ciclo;
+    passo(entradas.data(), Obs ? saidas.data() : nullptr);
+    if (Obs) Obs(atual, saidas.data());
+  }
+  return true;
+}
@@ -0,0 +1,122 @@
+#ifndef _SIMULACAO_SINCRONA_H_
+#define _SIMULACAO_SINCRONA_H_
+
+#include <functional>
+#include <vector>
+#include "bool3S.h"
+#include "kernels.h"
+#include "lote3S.h"
+
+class Circuito;
+class GeradorEstimulos;
+
+///
+/// CLASSE SIMULACAO SINCRONA
+///
+/// Simulacao ciclo a ciclo de circuitos sequenciais sincronos, com o estado guardado
+/// em flip-flops tipo D (portas FF, Port_DFF) com um relogio comum. Em cada ciclo:
+/// - a logica combinacional (todas as portas, exceto os flip-flops) eh avaliada uma
+///   unica vez, em ordem de nivel: as entradas do circuito e as saidas dos
+///   flip-flops (o estado atual) ficam no nivel 0, e cada porta fica um nivel acima
+///   da mais alta das portas que a alimentam;
+/// - as saidas do circuito sao lidas (antes da borda do relogio);
+/// - na borda do relogio, todos os flip-flops guardam, ao mesmo tempo, o valor da
+///   sua entrada D.
+/// Como as realimentacoes passam pelos flip-flops, nao ha iteracao ateh a
+/// convergencia: um circuito com realimentacao combinacional (sem flip-flop no laco)
+/// eh recusado. Circuitos com modulos sao achatados (Circuito::achatar).
+///
+/// Varias sequencias independentes sao simuladas ao mesmo tempo, em paralelo de bits:
+/// cada sinal ocupa um Lote3S (64 pistas) por lote, e cada pista eh uma sequencia
+/// propria, com as suas entradas e o seu estado. Os sinais de cada lote ficam
+/// contiguos, e os ciclos sao simulados sem nenhuma alocacao de memoria.
+///
+/// ATENCAO PARA A CONVENCAO: os flip-flops sao identificados pela IdPort da porta FF
+///
+
+class SimulacaoSincrona {
+public:
+  // Funcao chamada a cada ciclo por executar, com o numero do ciclo (a partir de 0,
+  // contado desde iniciar) e as saidas do circuito nesse ciclo (getNumLotes()*Nout
+  // valores: as saidas do lote L a partir da posicao L*Nout)
+  typedef std::function<void(long Ciclo, const Lote3S* out_circ)> Observador;
+
+private:
+  // Uma porta combinacional, na ordem de simulacao
+  struct Instrucao {
+    KernelLote kernel;  // O kernel da porta
+    int ini;            // Posicao da primeira entrada da porta em idx_in
+    int N;              // Numero de entradas da porta
+    int destino;        // O indice (em sinais) da saida da porta
+  };
+
+  int Nin, Nout, NS;
+  int num_lotes;
+  // As portas combinacionais, em ordem de nivel, e os indices das suas entradas
+  std::vector<Instrucao> instr;
+  std::vector<int> idx_in;
+  // O numero de niveis da logica combinacional
+  int num_niveis;
+  // Os indices (em sinais) das origens das saidas do circuito
+  std::vector<int> idx_out;
+  // Para cada flip-flop: o indice da sua saida Q e o da origem da sua entrada D
+  std::vector<int> ff_q, ff_d;
+  // O indice de cada porta no vetor de flip-flops (-1 se nao for flip-flop)
+  std::vector<int> indice_ff;
+
+  // Os valores dos sinais: o lote L ocupa as posicoes L*NS ateh L*NS+NS-1
+  std::vector<Lote3S> sinais;
+  // Os novos valores dos flip-flops, durante a borda do relogio
+  std::vector<Lote3S> proximo;
+  // Buffers de executar
+  std::vector<Lote3S> entradas, saidas;
+  long ciclo;
+
+  // Retorna o indice do flip-flop IdPort, ou -1 se IdPort nao for um flip-flop
+  int indiceFlipFlop(int IdPort) const;
+
+public:
+  // Cria uma simulacao sem circuito
+  SimulacaoSincrona();
+
+  // Prepara a simulacao do circuito C com NumLotes lotes (64*NumLotes sequencias)
+  // Todos os flip-flops comecam com ?, no ciclo 0
+  // Retorna false se o circuito nao for valido ou tiver realimentacao combinacional
+  bool iniciar(Circuito& C, int NumLotes=1);
+
+  // Caracteristicas
+  int getNumInputs() const;
+  int getNumOutputs() const;
+  int getNumFlipFlops() const;
+  // O numero de niveis da logica combinacional
+  int getNumNiveis() const;
+  // O numero de lotes e de sequencias (pistas) simuladas em paralelo
+  int getNumLotes() const;
+  int getNumPistas() const;
+  // O numero de ciclos simulados desde iniciar (ou reiniciar)
+  long getCiclo() const;
+
+  // Volta ao ciclo 0, com todos os flip-flops de todas as pistas iguais a Valor
+  void reiniciar(bool3S Valor=bool3S::UNDEF);
+  // O estado do flip-flop IdPort nas 64 pistas do lote L
+  // setEstado retorna false se IdPort nao for um flip-flop ou L for invalido
+  bool setEstado(int IdPort, int L, Lote3S Valor);
+  Lote3S getEstado(int IdPort, int L) const;
+  // O valor de um sinal (IdOrig: entrada -1 a -Nin, porta 1 a Nports) no lote L,
+  // na ultima avaliacao (antes da borda do relogio, exceto para os flip-flops)
+  Lote3S getSinal(int IdOrig, int L) const;
+
+  // Simula um ciclo de relogio de todas as pistas
+  // in_circ: getNumLotes()*Nin valores (as entradas do lote L a partir da posicao
+  // L*Nin, como em GeradorEstimulos::gerarLotes)
+  // out_circ: getNumLotes()*Nout valores, que recebem as saidas antes da borda do
+  // relogio (pode ser nullptr)
+  void passo(const Lote3S* in_circ, Lote3S* out_circ);
+
+  // Simula NCiclos ciclos, com as entradas de cada ciclo geradas por G (que deve ter
+  // Nin entradas); Obs, se houver, eh chamado a cada ciclo com as saidas
+  // Retorna false se G tiver outro numero de entradas
+  bool executar(long NCiclos, GeradorEstimulos& G, const Observador& Obs=nullptr);
+};
+
+#endif // _SIMULACAO_SINCRONA_H_
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <map>
+#include <utility>
+#include "simulacao_temporizada.h"
+#include "circuito.h"
+#include "modulo.h"
+#include "estado_simulacao.h"
+
+// O atraso de cada saida de modulo ja calculado (atrasoSaida)
+typedef std::map<std::pair<const Modulo*,int>,int> CacheAtrasos;
+
+static int atrasoSaida(const Circuito& C, const Modulo& M, int Saida, CacheAtrasos& Cache);
+
+// O atraso da porta de M cuja id eh IdPort: o do seu tipo, com os atrasos definidos
+// em C, ou, se for uma instancia, o da saida do modulo instanciado
+static int atrasoPorta(const Circuito& C, const Circuito& M, int IdPort, CacheAtrasos& Cache)
+{
+  int saida;
+  ptr_Modulo mod = M.getModuloPort(IdPort,saida);
+  if (mod) return atrasoSaida(C,*mod,saida,Cache);
+  return C.getAtraso(M.getSiglaPort(IdPort));
+}
+
+// O maior atraso acumulado de uma entrada do circuito M ate a saida da porta
+// cuja id eh IdPort (0 para as entradas do circuito)
+// acum[IP]: -1 se ainda nao calculado, -2 se em calculo (as ligacoes que fecham
+// um laco nao contam)
+static int atrasoCaminho(const Circuito& C, const Circuito& M, int Id, std::vector<int>& acum,
+                         CacheAtrasos& Cache)
+{
+  if (Id<=0) return 0;
+  int& A = acum[Id-1];
+  if (A==-2) return 0;
+  if (A>=0) return A;
+  A = -2;
+  int max_in = 0;
+  for (int I=0; I<M.getNumInputsPort(Id); I++)
+  {
+    max_in = std::max(max_in, atrasoCaminho(C,M,M.getId_inPort(Id,I),acum,Cache));
+  }
+  const int R = max_in + atrasoPorta(C,M,Id,Cache);
+  acum[Id-1] = R;
+  return R;
+}
+
+// O atraso de uma instancia, que eh simulada como uma unica porta: o do caminho
+// mais lento das entradas do modulo ate a saida usada (no minimo 1), com os
+// atrasos dos tipos de porta definidos em C
+static int atrasoSaida(const Circuito& C, const Modulo& M, int Saida, CacheAtrasos& Cache)
+{
+  const std::pair<const Modulo*,int> chave(&M,Saida);
+  CacheAtrasos::const_iterator it = Cache.find(chave);
+  if (it!=Cache.end()) return it->second;
+
+  const Circuito& MC = M.getCircuito();
+  std::vector<int> acum(MC.getNumPorts(),-1);
+  const int R = std::max(1, atrasoCaminho(C,MC,MC.getIdOutput(Saida),acum,Cache));
+  Cache[chave] = R;
+  return R;
+}
+
+///
+/// CLASSE SIMULACAO TEMPORIZADA
+///
+
+// Cria uma simulacao sem circuito
+SimulacaoTemporizada::SimulacaoTemporizada():
+  programa(), atraso(), sinais(), projetado(), pool(), livres(-1), roda(), mascara(0),
+  pendentes(0), tempo(0), avaliar(), marcada(), registrar(false), mudancas(), num_eventos(0)
+{
+}
+
+// Prepara a simulacao do circuito C, com os atrasos definidos em C
+bool SimulacaoTemporizada::iniciar(Circuito& C)
+{
+  programa = C.getCompilado();
+  if (!programa) return false;
+
+  const int NP = programa->getNumPorts();
+  int max_atraso = 1;
+  atraso.resize(NP);
+  CacheAtrasos cache;
+  for (int i=0; i<NP; i++)
+  {
+    atraso[i] = atrasoPorta(C,C,i+1,cache);
+    max_atraso = std::max(max_atraso, atraso[i]);
+  }
+
+  // A roda precisa ter mais posicoes que o maior atraso (potencia de 2)
+  int W = 2;
+  while (W<=max_atraso) W *= 2;
+  roda.assign(W,-1);
+  mascara = W-1;
+
+  sinais.assign(programa->getNumSinais(), bool3S::UNDEF);
+  projetado.assign(NP, bool3S::UNDEF);
+  pool.clear();
+  livres = -1;
+  pendentes = 0;
+  tempo = 0;
+  avaliar.clear();
+  marcada.assign(NP, 0);
+  mudancas.clear();
+  num_eventos = 0;
+  return true;
+}
+
+// Registra (ou nao) as mudancas de sinais a partir de agora
+void SimulacaoTemporizada::setRegistrar(bool Registrar)
+{
+  if (Registrar && !registrar)
+  {
+    for (int s=0; s<int(sinais.size()); s++) mudancas.push_back(Mudanca{tempo, s, sinais[s]});
+  }
+  registrar = Registrar;
+}
+
+// Altera o valor de um sinal no instante atual e marca o seu fan-out
+void SimulacaoTemporizada::mudarSinal(int S, bool3S Valor)
+{
+  sinais[S] = Valor;
+  if (registrar) mudancas.push_back(Mudanca{tempo, S, Valor});
+
+  const int* fo = programa->getFanout(S);
+  for (int k=0; k<programa->getNumFanout(S); k++)
+  {
+    if (!marcada[fo[k]])
+    {
+      marcada[fo[k]] = 1;
+      avaliar.push_back(fo[k]);
+    }
+  }
+}
+
+// Reavalia as portas marcadas, depois de aplicadas todas as mudancas do instante
+// atual (mudancas simultaneas nas entradas de uma porta nao geram pulsos espurios)
+void SimulacaoTemporizada::reavaliar()
+{
+  for (int IP : avaliar)
+  {
+    marcada[IP] = 0;
+    bool3S prov = programa->simularPorta(IP, sinais.data());
+    if (prov!=projetado[IP])
+    {
+      agendar(tempo+atraso[IP], IP, prov);
+      projetado[IP] = prov;
+    }
+  }
+  avaliar.clear();
+}
+
+// Agenda um evento para o instante T, reaproveitando um evento livre do pool
+void SimulacaoTemporizada::agendar(long T, int IP, bool3S Valor)
+{
+  int E;
+  if (livres>=0)
+  {
+    E = livres;
+    livres = pool[E].prox;
+  }
+  else
+  {
+    E = pool.size();
+    pool.push_back(Evento());
+  }
+  int& pos(roda[T & mascara]);
+  pool[E] = Evento{IP, Valor, pos};
+  pos = E;
+  pendentes++;
+}
+
+// Aplica novos valores as entradas do circuito no instante atual
+bool SimulacaoTemporizada::setEntradas(const std::vector<bool3S>& in_circ)
+{
+  if (!programa || int(in_circ.size())!=programa->getNumInputs()) return false;
+  for (int i=0; i<int(in_circ.size()); i++)
+  {
+    if (sinais[i]!=in_circ[i]) mudarSinal(i, in_circ[i]);
+  }
+  reavaliar();
+  return true;
+}
+
+// Avanca a simulacao por NPassos passos de tempo
+void SimulacaoTemporizada::avancar(long NPassos)
+{
+  if (!programa) return;
+  const int Nin = programa->getNumInputs();
+
+  for (long k=0; k<NPassos; k++)
+  {
+    tempo++;
+    int& pos(roda[tempo & mascara]);
+    int E = pos;
+    pos = -1;
+    while (E>=0)
+    {
+      const Evento ev = pool[E];
+      pool[E].prox = livres;
+      livres = E;
+      E = ev.prox;
+      pendentes--;
+      num_eventos++;
+      if (sinais[Nin+ev.IP]!=ev.valor) mudarSinal(Nin+ev.IP, ev.valor);
+    }
+    if (!avaliar.empty()) reavaliar();
+  }
+}
+
+// Avanca a simulacao ateh nao haver eventos pendentes (no maximo NMaxPassos passos)
+bool SimulacaoTemporizada::estabilizar(long NMaxPassos)
+{
+  for (long k=0; k<NMaxPassos && pendentes>0; k++) avancar(1);
+  return pendentes==0;
+}
+
+// Guarda o estado atual
+// Os eventos de cada posicao da roda sao de um unico instante (entre tempo+1 e
+// tempo+mascara) e sao listados na ordem em que seriam processados
+void SimulacaoTemporizada::salvarEstado(EstadoSimulacao& E) const
+{
+  E.clear();
+  E.tempo = tempo;
+  E.num_eventos = num_eventos;
+  E.sinais.empacotar(sinais);
+  E.projetado.empacotar(projetado);
+  E.eventos.reserve(pendentes);
+  for (long d=1; d<=mascara; d++)
+  {
+    const long T = tempo+d;
+    for (int Ev=roda[T & mascara]; Ev>=0; Ev=pool[Ev].prox)
+    {
+      E.eventos.push_back(EstadoSimulacao::EventoPendente{T, pool[Ev].IP, pool[Ev].valor});
+    }
+  }
+}
+
+// Volta ao estado guardado em E
+bool SimulacaoTemporizada::restaurarEstado(const EstadoSimulacao& E)
+{
+  if (!programa) return false;
+  const int NP = programa->getNumPorts();
+  if (int(E.sinais.size())!=programa->getNumSinais() || int(E.projetado.size())!=NP) return false;
+  for (const EstadoSimulacao::EventoPendente& ev : E.eventos)
+  {
+    if (ev.IP<0 || ev.IP>=NP || ev.tempo<=E.tempo || ev.tempo>E.tempo+mascara) return false;
+  }
+
+  E.sinais.desempacotar(sinais);
+  E.projetado.desempacotar(projetado);
+  tempo = E.tempo;
+  num_eventos = E.num_eventos;
+  // Os eventos sao reagendados de tras para frente: agendar insere no inicio da lista
+  // de cada posicao, o que restaura a ordem original
+  std::fill(roda.begin(), roda.end(), -1);
+  pool.clear();
+  livres = -1;
+  pendentes = 0;
+  for (size_t k=E.eventos.size(); k-->0; )
+  {
+    agendar(E.eventos[k].tempo, E.eventos[k].IP, E.eventos[k].valor);
+  }
+
+  mudancas.clear();
+  if (registrar)
+  {
+    for (int s=0; s<int(sinais.size()); s++) mudancas.push_back(Mudanca{tempo, s, sinais[s]});
+  }
+  return true;
+}
+
+// Consultas
+long SimulacaoTemporizada::getTempo() const
+{
+  return tempo;
+}
+
+bool SimulacaoTemporizada::estavel() const
+{
+  return pendentes==0;
+}
+
+long SimulacaoTemporizada::getNumEventos() const
+{
+  return num_eventos;
+}
+
+bool3S SimulacaoTemporizada::getSinal(int S) const
+{
+  if (S<0 || S>=int(sinais.size())) return bool3S::UNDEF;
+  return sinais[S];
+}
+
+const bool3S* SimulacaoTemporizada::getSinais() const
+{
+  return sinais.data();
+}
+
+bool3S SimulacaoTemporizada::getOutput(int IdOutput) const
+{
+  if (!programa || IdOutput<1 || IdOutput>programa->getNumOutputs()) return bool3S::UNDEF;
+  return sinais[programa->getIndiceSaida(IdOutput-1)];
+}
+
+const std::vector<SimulacaoTemporizada::Mudanca>& SimulacaoTemporizada::getMudancas() const
+{
+  return mudancas;
+}
+
+std::shared_ptr<const CircuitoCompilado> SimulacaoTemporizada::getCompilado() const
+{
+  return programa;
+}
+
+// Imprime a forma de onda entre os instantes T0 e T1, a partir das mudancas registradas
+std::ostream& SimulacaoTemporizada::imprimirFormaOnda(std::ostream& O, long T0, long T1) const
+{
+  if (!programa || T1<T0) return O;
+
+  const int Nin = programa->getNumInputs();
+  const int NS = programa->getNumSinais();
+  const int NC = T1-T0+1;
+  std::vector<bool3S> valor(NS, bool3S::UNDEF);
+  std::vector<std::string> linha(NS, std::string(NC,'?'));
+  size_t m = 0;
+
+  for (long t=0; t<=T1; t++)
+  {
+    while (m<mudancas.size() && mudancas[m].tempo<=t)
+    {
+      valor[mudancas[m].sinal] = mudancas[m].valor;
+      m++;
+    }
+    if (t>=T0) for (int s=0; s<NS; s++) linha[s][t-T0] = toChar(valor[s]);
+  }
+
+  O << "t\t";
+  for (long t=T0; t<=T1; t++) O << char('0'+t%10);
+  O << '\n';
+  for (int s=0; s<NS; s++)
+  {
+    if (s<Nin) O << 'E' << s+1;
+    else O << 'P' << s-Nin+1;
+    O << '\t' << linha[s] << '\n';
+  }
+  for (int j=0; j<programa->getNumOutputs(); j++)
+  {
+    O << 'S' << j+1 << '\t' << linha[programa->getIndiceSaida(j)] << '\n';
+  }
+  return O;
+}
@@ -0,0 +1,155 @@
+#ifndef _SIMULACAO_TEMPORIZADA_H_
+#define _SIMULACAO_TEMPORIZADA_H_
+
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "bool3S.h"
+#include "circuito_compilado.h"
+
+class Circuito;
+struct EstadoSimulacao;
+
+///
+/// CLASSE SIMULACAO TEMPORIZADA
+///
+/// Simulacao dirigida por eventos, passo a passo no tempo, em que cada porta tem
+/// um atraso (em passos de tempo) que depende do seu tipo (Circuito::getAtraso).
+/// Uma instancia de modulo (SB) eh simulada como uma unica porta, com o atraso do
+/// caminho mais lento das entradas do modulo ate a saida usada.
+/// Ao contrario de Circuito::simular, que calcula apenas o valor final estavel,
+/// mostra os transitorios: pulsos espurios (glitches), oscilacoes em realimentacoes, etc.
+///
+/// Funcionamento:
+/// - quando um sinal muda no instante t, as portas do seu fan-out sao reavaliadas;
+/// - se a nova saida de uma porta for diferente da ultima saida agendada para ela,
+///   um evento (mudanca da saida) eh agendado para t + atraso da porta
+///   (modelo de atraso de transporte: pulsos mais curtos que o atraso tambem passam);
+/// - os eventos ficam em uma roda de tempo (timing wheel) com uma posicao por passo
+///   de tempo, em numero maior que o maior atraso: o agendamento e a retirada
+///   de eventos sao O(1);
+/// - os eventos sao alocados de um pool reaproveitado (lista de livres), sem
+///   alocacao de memoria durante a simulacao depois que o pool atinge o tamanho maximo.
+///
+/// As mudancas de sinais podem ser registradas (setRegistrar) para gerar a forma
+/// de onda (imprimirFormaOnda).
+/// O estado da simulacao pode ser guardado (salvarEstado) e restaurado depois
+/// (restaurarEstado), por exemplo para explorar varias continuacoes a partir de um
+/// mesmo instante sem simular tudo de novo.
+///
+
+class SimulacaoTemporizada {
+public:
+  // Uma mudanca de valor de um sinal (indice em CircuitoCompilado::indiceSinal)
+  struct Mudanca {
+    long tempo;
+    int sinal;
+    bool3S valor;
+  };
+
+private:
+  // Um evento agendado: a saida da porta de indice IP passa a ser valor
+  // prox: o proximo evento na mesma posicao da roda (ou no pool de livres), ou -1
+  struct Evento {
+    int IP;
+    bool3S valor;
+    int prox;
+  };
+
+  // O circuito compilado sendo simulado
+  std::shared_ptr<const CircuitoCompilado> programa;
+  // O atraso de cada porta
+  std::vector<int> atraso;
+
+  // Os valores atuais de todos os sinais
+  std::vector<bool3S> sinais;
+  // O ultimo valor agendado para a saida de cada porta (ou o atual, se nao houver)
+  std::vector<bool3S> projetado;
+
+  // O pool de eventos e o inicio da lista de eventos livres
+  std::vector<Evento> pool;
+  int livres;
+  // A roda de tempo: o primeiro evento de cada posicao (ou -1)
+  // O evento para o instante t fica na posicao t & mascara
+  std::vector<int> roda;
+  int mascara;
+  // O numero de eventos agendados ainda nao processados
+  long pendentes;
+  // O instante atual
+  long tempo;
+
+  // As portas a reavaliar no instante atual e a marca que evita repeticoes
+  std::vector<int> avaliar;
+  std::vector<char> marcada;
+
+  // Registro das mudancas
+  bool registrar;
+  std::vector<Mudanca> mudancas;
+  // O numero total de eventos processados
+  long num_eventos;
+
+  // Altera o valor de um sinal no instante atual, registra a mudanca e
+  // marca as portas do seu fan-out para reavaliacao
+  void mudarSinal(int S, bool3S Valor);
+  // Reavalia as portas marcadas, agendando os eventos resultantes
+  void reavaliar();
+  // Agenda um evento para o instante T
+  void agendar(long T, int IP, bool3S Valor);
+
+public:
+  // Cria uma simulacao sem circuito
+  SimulacaoTemporizada();
+
+  // Prepara a simulacao do circuito C, com os atrasos definidos em C
+  // Todos os sinais comecam indefinidos, no instante 0
+  // Retorna false se o circuito nao for valido
+  bool iniciar(Circuito& C);
+
+  // Registra (ou nao) as mudancas de sinais a partir de agora (padrao: nao registra)
+  // Ao ligar o registro, os valores atuais de todos os sinais sao registrados
+  void setRegistrar(bool Registrar);
+
+  // Aplica novos valores as entradas do circuito no instante atual
+  // Retorna false se a dimensao do vetor nao for igual ao numero de entradas
+  bool setEntradas(const std::vector<bool3S>& in_circ);
+
+  // Avanca a simulacao por NPassos passos de tempo, processando os eventos
+  void avancar(long NPassos);
+
+  // Avanca a simulacao ateh nao haver mais eventos pendentes ou ateh
+  // completar NMaxPassos passos. Retorna true se estabilizou
+  bool estabilizar(long NMaxPassos);
+
+  // Pontos de restauracao (ver EstadoSimulacao)
+  // Guarda em E o estado atual: instante, sinais, valores projetados e eventos pendentes
+  void salvarEstado(EstadoSimulacao& E) const;
+  // Volta ao estado guardado em E (de uma simulacao do mesmo circuito), que pode
+  // ter sido salvo antes ou depois do instante atual. O registro de mudancas eh
+  // reiniciado: se estiver ligado, registra os valores atuais de todos os sinais
+  // Retorna false (sem alterar a simulacao) se E nao for compativel com o circuito
+  bool restaurarEstado(const EstadoSimulacao& E);
+
+  // Consultas
+  long getTempo() const;
+  // Retorna true se nao ha eventos pendentes
+  bool estavel() const;
+  // O numero total de eventos processados desde iniciar
+  long getNumEventos() const;
+  // O valor atual de um sinal (indice em CircuitoCompilado::indiceSinal)
+  bool3S getSinal(int S) const;
+  // Os valores atuais de todos os sinais (por exemplo, para EscritorVCD::registrar)
+  const bool3S* getSinais() const;
+  // O valor atual da saida do circuito cuja id eh IdOutput (1 a Nout)
+  bool3S getOutput(int IdOutput) const;
+  // As mudancas registradas, em ordem de tempo
+  const std::vector<Mudanca>& getMudancas() const;
+  // O circuito compilado sendo simulado
+  std::shared_ptr<const CircuitoCompilado> getCompilado() const;
+
+  // Imprime a forma de onda (a partir das mudancas registradas) entre os
+  // instantes T0 e T1 (inclusive): uma linha por entrada (E1, E2...), porta
+  // (P1, P2...) e saida (S1, S2...) do circuito, com um caractere (? F T) por instante
+  std::ostream& imprimirFormaOnda(std::ostream& O, long T0, long T1) const;
+};
+
+#endif // _SIMULACAO_TEMPORIZADA_H_
@@ -0,0 +1,214 @@
+#include <algorithm>
+#include "simulador_assincrono.h"
+#include "circuito.h"
+
+///
+/// CLASSE SIMULADOR ASSINCRONO
+///
+
+/// ***********************
+/// Tarefa
+/// ***********************
+
+SimuladorAssincrono::Tarefa::Tarefa():
+  futuro(), cancelada()
+{
+}
+
+bool SimuladorAssincrono::Tarefa::valid() const
+{
+  return futuro.valid();
+}
+
+void SimuladorAssincrono::Tarefa::cancelar()
+{
+  if (cancelada) cancelada->store(true,std::memory_order_relaxed);
+}
+
+void SimuladorAssincrono::Tarefa::esperar() const
+{
+  if (futuro.valid()) futuro.wait();
+}
+
+bool SimuladorAssincrono::Tarefa::esperar(std::chrono::milliseconds Tempo) const
+{
+  if (!futuro.valid()) return false;
+  return futuro.wait_for(Tempo)==std::future_status::ready;
+}
+
+SimuladorAssincrono::Resultado SimuladorAssincrono::Tarefa::get()
+{
+  return futuro.get();
+}
+
+/// ***********************
+/// Simulador
+/// ***********************
+
+// Compila o circuito C e inicia as threads do executor
+SimuladorAssincrono::SimuladorAssincrono(Circuito& C, int NThreads, int TamFila):
+  programa(C.getCompilado()), max_fila(std::max(1,TamFila)), fila(), mutex(),
+  cv_pedido(), cv_espaco(), parar(false), threads()
+{
+  if (!programa) return;
+  if (NThreads<=0) NThreads = std::max(1u,std::thread::hardware_concurrency());
+  for (int t=0; t<NThreads; t++) threads.emplace_back(&SimuladorAssincrono::executar,this);
+}
+
+// Cancela as submissoes que ainda estao na fila e espera as que estao em execucao
+SimuladorAssincrono::~SimuladorAssincrono()
+{
+  std::deque<Pedido> pendentes;
+  {
+    std::lock_guard<std::mutex> trava(mutex);
+    parar = true;
+    pendentes.swap(fila);
+  }
+  cv_pedido.notify_all();
+  cv_espaco.notify_all();
+  for (Pedido& P : pendentes) concluir(P,Resultado{Estado::CANCELADO,{}});
+  for (std::thread& T : threads) T.join();
+}
+
+bool SimuladorAssincrono::valid() const
+{
+  return programa!=nullptr;
+}
+
+int SimuladorAssincrono::getNumThreads() const
+{
+  return threads.size();
+}
+
+int SimuladorAssincrono::getTamFila() const
+{
+  return max_fila;
+}
+
+int SimuladorAssincrono::getNumPendentes()
+{
+  std::lock_guard<std::mutex> trava(mutex);
+  return fila.size();
+}
+
+// O laco de cada thread do executor
+// Os buffers de simulacao sao alocados uma unica vez por thread
+void SimuladorAssincrono::executar()
+{
+  std::vector<Lote3S> in(programa->getNumInputs()), sinais(programa->getNumSinais()),
+                      out(programa->getNumOutputs());
+  while (true)
+  {
+    Pedido P;
+    {
+      std::unique_lock<std::mutex> trava(mutex);
+      cv_pedido.wait(trava,[this] {return parar || !fila.empty();});
+      if (fila.empty()) return;
+      P = std::move(fila.front());
+      fila.pop_front();
+    }
+    cv_espaco.notify_one();
+    concluir(P,simular(P,in,sinais,out));
+  }
+}
+
+// Simula os vetores do pedido P, 64 por vez
+// O pedido de cancelamento eh conferido antes de cada grupo de 64 vetores
+SimuladorAssincrono::Resultado SimuladorAssincrono::simular(const Pedido& P, std::vector<Lote3S>& in,
+                                                            std::vector<Lote3S>& sinais,
+                                                            std::vector<Lote3S>& out) const
+{
+  const int NI = programa->getNumInputs();
+  const int NO = programa->getNumOutputs();
+  const size_t NV = P.entradas.size();
+  Resultado R{Estado::OK,{}};
+
+  for (const std::vector<bool3S>& E : P.entradas)
+  {
+    if (int(E.size())!=NI) return Resultado{Estado::ERRO,{}};
+  }
+
+  R.saidas.resize(NV);
+  for (size_t base=0; base<NV; base+=NUM_PISTAS)
+  {
+    if (P.cancelada->load(std::memory_order_relaxed)) return Resultado{Estado::CANCELADO,{}};
+
+    const int NP = std::min<size_t>(NUM_PISTAS,NV-base);
+    std::fill(in.begin(),in.end(),lote3S(bool3S::UNDEF));
+    for (int k=0; k<NP; k++)
+    {
+      const bool3S* e = P.entradas[base+k].data();
+      for (int i=0; i<NI; i++) setPista(in[i],k,e[i]);
+    }
+    programa->simularLote(in.data(),sinais.data(),out.data());
+    for (int k=0; k<NP; k++)
+    {
+      std::vector<bool3S>& s(R.saidas[base+k]);
+      s.resize(NO);
+      for (int j=0; j<NO; j++) s[j] = getPista(out[j],k);
+    }
+  }
+  return R;
+}
+
+// Chama o callback e entrega o resultado ao futuro do pedido P
+// Uma excecao gerada pelo callback eh entregue ao futuro no lugar do resultado
+void SimuladorAssincrono::concluir(Pedido& P, Resultado&& R)
+{
+  try
+  {
+    if (P.callback) P.callback(R);
+  }
+  catch (...)
+  {
+    P.promessa.set_exception(std::current_exception());
+    return;
+  }
+  P.promessa.set_value(std::move(R));
+}
+
+// Coloca Entradas na fila
+SimuladorAssincrono::Tarefa SimuladorAssincrono::enfileirar(std::vector<std::vector<bool3S>>& Entradas,
+                                                            Callback& Ao_terminar, bool Bloquear)
+{
+  Tarefa T;
+  Pedido P;
+  P.cancelada = std::make_shared<std::atomic<bool>>(false);
+
+  if (!programa)
+  {
+    P.callback = std::move(Ao_terminar);
+    T.futuro = P.promessa.get_future();
+    T.cancelada = P.cancelada;
+    concluir(P,Resultado{Estado::ERRO,{}});
+    return T;
+  }
+
+  {
+    std::unique_lock<std::mutex> trava(mutex);
+    if (Bloquear) cv_espaco.wait(trava,[this] {return parar || fila.size()<max_fila;});
+    if (parar || fila.size()>=max_fila) return T;
+
+    P.entradas = std::move(Entradas);
+    P.callback = std::move(Ao_terminar);
+    T.futuro = P.promessa.get_future();
+    T.cancelada = P.cancelada;
+    fila.push_back(std::move(P));
+  }
+  cv_pedido.notify_one();
+  return T;
+}
+
+// Submete um conjunto de vetores de entrada, bloqueando enquanto a fila estiver cheia
+SimuladorAssincrono::Tarefa SimuladorAssincrono::submeter(std::vector<std::vector<bool3S>>&& Entradas,
+                                                          Callback Ao_terminar)
+{
+  return enfileirar(Entradas,Ao_terminar,true);
+}
+
+// Submete um conjunto de vetores de entrada, sem bloquear
+SimuladorAssincrono::Tarefa SimuladorAssincrono::tentarSubmeter(std::vector<std::vector<bool3S>>&& Entradas,
+                                                                Callback Ao_terminar)
+{
+  return enfileirar(Entradas,Ao_terminar,false);
+}
@@ -0,0 +1,141 @@
+#ifndef _SIMULADOR_ASSINCRONO_H_
+#define _SIMULADOR_ASSINCRONO_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "bool3S.h"
+#include "lote3S.h"
+#include "circuito_compilado.h"
+
+class Circuito;
+
+///
+/// CLASSE SIMULADOR ASSINCRONO
+///
+/// Simula conjuntos de vetores de entrada de um circuito sem bloquear quem os submete:
+/// cada submissao (submeter) vai para uma fila de tamanho limitado e retorna logo uma
+/// Tarefa, com um std::future do resultado. Um numero fixo de threads (o executor
+/// interno, sem criar uma thread por submissao) retira as submissoes da fila, em
+/// ordem, e simula os vetores 64 por vez (CircuitoCompilado::simularLote).
+/// - Contrapressao: com a fila cheia, submeter bloqueia ateh haver espaco, e
+///   tentarSubmeter retorna uma Tarefa invalida sem bloquear;
+/// - Cancelamento: uma tarefa cancelada (Tarefa::cancelar) que ainda estah na fila
+///   nao eh simulada; se jah estiver sendo simulada, para no proximo grupo de 64 vetores;
+/// - Callback: opcionalmente chamada na thread do executor com o resultado, antes de
+///   o resultado ser entregue ao futuro.
+/// As entradas e as saidas sao movidas (nunca copiadas) entre quem submete, o executor
+/// e o futuro. O circuito eh compilado na construcao: alteracoes posteriores no
+/// Circuito nao afetam o simulador.
+///
+
+class SimuladorAssincrono {
+public:
+  // A situacao final de uma submissao
+  enum class Estado : uint8_t {
+    OK,
+    CANCELADO,
+    ERRO        // circuito invalido ou vetor de entrada com dimensao errada
+  };
+
+  // O resultado de uma submissao: as saidas do circuito para cada vetor de entrada,
+  // na mesma ordem (vazio se a submissao foi cancelada ou teve erro)
+  struct Resultado {
+    Estado estado;
+    std::vector<std::vector<bool3S>> saidas;
+  };
+
+  // Funcao chamada ao termino de uma submissao (inclusive cancelada ou com erro)
+  typedef std::function<void(const Resultado&)> Callback;
+
+  // Uma submissao em andamento
+  class Tarefa {
+  private:
+    std::future<Resultado> futuro;
+    std::shared_ptr<std::atomic<bool>> cancelada;
+    friend class SimuladorAssincrono;
+
+  public:
+    Tarefa();
+    // Retorna false se a submissao nao foi aceita (tentarSubmeter com a fila cheia)
+    // ou se o resultado jah foi retirado (get)
+    bool valid() const;
+    // Pede o cancelamento da submissao
+    void cancelar();
+    // Espera o termino da submissao
+    void esperar() const;
+    // Espera o termino por no maximo Tempo; retorna true se terminou
+    bool esperar(std::chrono::milliseconds Tempo) const;
+    // Espera o termino e retorna (move) o resultado. Soh pode ser chamada uma vez
+    // Se o callback gerar uma excecao, ela eh gerada novamente aqui
+    Resultado get();
+  };
+
+private:
+  // Uma submissao na fila
+  struct Pedido {
+    std::vector<std::vector<bool3S>> entradas;
+    Callback callback;
+    std::promise<Resultado> promessa;
+    std::shared_ptr<std::atomic<bool>> cancelada;
+  };
+
+  // O circuito compilado (nullptr se o circuito for invalido)
+  std::shared_ptr<const CircuitoCompilado> programa;
+  // O numero maximo de submissoes esperando na fila
+  size_t max_fila;
+
+  std::deque<Pedido> fila;
+  std::mutex mutex;
+  // Sinalizam que ha submissoes na fila (ou que o simulador estah parando) e que
+  // ha espaco livre na fila, respectivamente
+  std::condition_variable cv_pedido, cv_espaco;
+  bool parar;
+  std::vector<std::thread> threads;
+
+  // O laco de cada thread do executor
+  void executar();
+  // Simula os vetores do pedido P, usando os buffers (de uma thread) in, sinais e out
+  Resultado simular(const Pedido& P, std::vector<Lote3S>& in, std::vector<Lote3S>& sinais,
+                    std::vector<Lote3S>& out) const;
+  // Chama o callback e entrega o resultado ao futuro do pedido P
+  static void concluir(Pedido& P, Resultado&& R);
+  // Coloca Entradas na fila, esperando por espaco se Bloquear; senao retorna uma
+  // Tarefa invalida (sem mover Entradas) se a fila estiver cheia
+  Tarefa enfileirar(std::vector<std::vector<bool3S>>& Entradas, Callback& Ao_terminar, bool Bloquear);
+
+public:
+  // Compila o circuito C e inicia NThreads threads (<=0: uma por processador),
+  // com uma fila de no maximo TamFila submissoes esperando (>=1)
+  explicit SimuladorAssincrono(Circuito& C, int NThreads=0, int TamFila=64);
+  // Cancela as submissoes que ainda estao na fila e espera as que estao em execucao
+  ~SimuladorAssincrono();
+
+  SimuladorAssincrono(const SimuladorAssincrono&) = delete;
+  void operator=(const SimuladorAssincrono&) = delete;
+
+  // Retorna true se o circuito era valido na construcao
+  bool valid() const;
+  int getNumThreads() const;
+  int getTamFila() const;
+  // O numero de submissoes esperando na fila (nao inclui as em execucao)
+  int getNumPendentes();
+
+  // Submete um conjunto de vetores de entrada (cada um com getNumInputs() valores),
+  // que sao movidos para o simulador. Bloqueia enquanto a fila estiver cheia
+  // Se o circuito for invalido, a tarefa retornada jah termina com Estado::ERRO
+  Tarefa submeter(std::vector<std::vector<bool3S>>&& Entradas, Callback Ao_terminar=nullptr);
+  // O mesmo, sem bloquear: se a fila estiver cheia, retorna uma Tarefa invalida e
+  // Entradas nao eh alterado (pode ser submetido novamente)
+  Tarefa tentarSubmeter(std::vector<std::vector<bool3S>>&& Entradas, Callback Ao_terminar=nullptr);
+};
+
+#endif // _SIMULADOR_ASSINCRONO_H_
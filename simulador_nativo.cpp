@@ -0,0 +1,307 @@
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <fstream>
+#ifndef _WIN32
+#include <dlfcn.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+#include "simulador_nativo.h"
+#include "circuito.h"
+
+// Numero maximo de portas em cada funcao do codigo gerado
+// (funcoes muito longas tornam a compilacao lenta)
+static const int PORTAS_POR_BLOCO = 4096;
+
+// Versao do gerador: faz parte do codigo gerado e, portanto, do hash,
+// invalidando o cache quando o formato do codigo gerado mudar
+static const char* VERSAO_GERADOR = "simulador_nativo 1";
+
+///
+/// CLASSE SIMULADOR NATIVO
+///
+
+SimuladorNativo::SimuladorNativo():
+  biblioteca(nullptr), funcao(nullptr), Nin(0), Nout(0), Nsinais(0)
+{
+}
+
+SimuladorNativo::~SimuladorNativo()
+{
+  descarregar();
+}
+
+SimuladorNativo::SimuladorNativo(SimuladorNativo&& S) noexcept:
+  biblioteca(S.biblioteca), funcao(S.funcao), Nin(S.Nin), Nout(S.Nout), Nsinais(S.Nsinais),
+  sinais(std::move(S.sinais))
+{
+  S.biblioteca = nullptr;
+  S.funcao = nullptr;
+  S.Nin = S.Nout = S.Nsinais = 0;
+  S.sinais.clear();
+}
+
+void SimuladorNativo::operator=(SimuladorNativo&& S) noexcept
+{
+  if (this == &S) return;
+  descarregar();
+  biblioteca = S.biblioteca;
+  funcao = S.funcao;
+  Nin = S.Nin;
+  Nout = S.Nout;
+  Nsinais = S.Nsinais;
+  sinais = std::move(S.sinais);
+  S.biblioteca = nullptr;
+  S.funcao = nullptr;
+  S.Nin = S.Nout = S.Nsinais = 0;
+  S.sinais.clear();
+}
+
+// Gera o codigo fonte C++ do simulador de um circuito compilado
+// Cada porta vira uma atribuicao s[saida] = expressao do tipo da porta (TipoPorta::expressao),
+// em ordem topologica. Se houver realimentacao, cada bloco de portas retorna as
+// pistas que mudaram e o conjunto de blocos eh repetido ate nada mudar
+std::string SimuladorNativo::gerarCodigo(const CircuitoCompilado& P)
+{
+  const std::vector<int>& ordem(P.getOrdem());
+  const bool aciclico = P.isAciclico();
+  const int NP = P.getNumPorts();
+  const int Nblocos = (NP+PORTAS_POR_BLOCO-1)/PORTAS_POR_BLOCO;
+  std::ostringstream O;
+
+  O << "// Codigo gerado automaticamente (" << VERSAO_GERADOR << "): nao editar\n";
+  O << "// Circuito: " << P.getNumInputs() << " entradas, " << P.getNumOutputs()
+    << " saidas, " << NP << " portas\n";
+  O << "#include <cstdint>\n";
+  O << "struct L { uint64_t t, f; };\n";
+  O << "static inline L n_(L a) { return L{a.f, a.t}; }\n";
+  O << "static inline L a_(L a, L b) { return L{a.t & b.t, a.f | b.f}; }\n";
+  O << "static inline L o_(L a, L b) { return L{a.t | b.t, a.f & b.f}; }\n";
+  O << "static inline L x_(L a, L b) { return L{(a.t & b.f) | (a.f & b.t), (a.t & b.t) | (a.f & b.f)}; }\n";
+  O << "static inline uint64_t d_(L a, L b) { return (a.t ^ b.t) | (a.f ^ b.f); }\n";
+
+  for (int b=0; b<Nblocos; b++)
+  {
+    O << (aciclico ? "static void" : "static uint64_t") << " b" << b << "(L* s)\n{\n";
+    if (!aciclico) O << "  uint64_t m = 0;\n  L v;\n";
+    for (int k=b*PORTAS_POR_BLOCO; k<NP && k<(b+1)*PORTAS_POR_BLOCO; k++)
+    {
+      const int i = ordem[k];
+      std::vector<std::string> in(P.getNumInputsPorta(i));
+      for (size_t j=0; j<in.size(); j++) in[j] = "s[" + std::to_string(P.getIndiceEntrada(i,j)) + "]";
+      const std::string expr = RegistroPortas::getTipo(P.getCodigoPorta(i)).expressao(in);
+
+      const int saida = P.getNumInputs()+i;
+      if (aciclico) O << "  s[" << saida << "] = " << expr << ";\n";
+      else O << "  v = " << expr << "; m |= d_(v, s[" << saida << "]); s[" << saida << "] = v;\n";
+    }
+    if (!aciclico) O << "  return m;\n";
+    O << "}\n";
+  }
+
+  O << "extern \"C\" int circuito_num_sinais() { return " << P.getNumSinais() << "; }\n";
+  O << "extern \"C\" void simular_circuito(const L* in, L* s, L* out)\n{\n";
+  O << "  for (int i=0; i<" << P.getNumInputs() << "; i++) s[i] = in[i];\n";
+  O << "  for (int i=" << P.getNumInputs() << "; i<" << P.getNumSinais() << "; i++) s[i] = L{0, 0};\n";
+  if (aciclico)
+  {
+    for (int b=0; b<Nblocos; b++) O << "  b" << b << "(s);\n";
+  }
+  else
+  {
+    O << "  uint64_t m;\n  do\n  {\n    m = 0;\n";
+    for (int b=0; b<Nblocos; b++) O << "    m |= b" << b << "(s);\n";
+    O << "  }\n  while (m != 0);\n";
+  }
+  for (int j=0; j<P.getNumOutputs(); j++)
+  {
+    O << "  out[" << j << "] = s[" << P.getIndiceSaida(j) << "];\n";
+  }
+  O << "}\n";
+  return O.str();
+}
+
+// O hash (FNV-1a de 64 bits) de um codigo fonte
+uint64_t SimuladorNativo::hashCodigo(const std::string& Codigo)
+{
+  uint64_t h = 14695981039346656037ULL;
+  for (unsigned char c : Codigo)
+  {
+    h ^= c;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// O diretorio de cache padrao
+std::string SimuladorNativo::diretorioCachePadrao()
+{
+  const char* dir = std::getenv("XDG_CACHE_HOME");
+  if (dir!=nullptr && dir[0]!='\0') return std::string(dir) + "/simulador_circuito";
+  dir = std::getenv("HOME");
+  if (dir!=nullptr && dir[0]!='\0') return std::string(dir) + "/.cache/simulador_circuito";
+  return "/tmp/simulador_circuito";
+}
+
+#ifndef _WIN32
+
+// Cria um diretorio e os diretorios acima dele, caso nao existam
+static bool criarDiretorio(const std::string& Dir)
+{
+  for (size_t pos=Dir.find('/',1); ; pos=Dir.find('/',pos+1))
+  {
+    std::string prov = Dir.substr(0,pos);
+    if (mkdir(prov.c_str(),0755)!=0)
+    {
+      struct stat st;
+      if (stat(prov.c_str(),&st)!=0 || !S_ISDIR(st.st_mode)) return false;
+    }
+    if (pos==std::string::npos) return true;
+  }
+}
+
+// Um argumento entre aspas simples para o shell (std::system): cada ' do texto
+// vira '\'' (fecha as aspas, uma aspa escapada, reabre as aspas)
+static std::string aspasShell(const std::string& Texto)
+{
+  std::string R("'");
+  for (char c : Texto)
+  {
+    if (c=='\'') R += "'\\''";
+    else R += c;
+  }
+  return R + "'";
+}
+
+// Gera, compila (caso nao esteja no cache) e carrega o simulador do circuito C
+bool SimuladorNativo::carregar(Circuito& C, const std::string& DirCache)
+{
+  descarregar();
+
+  std::shared_ptr<const CircuitoCompilado> P = C.getCompilado();
+  if (!P) return false;
+  // O codigo gerado nao tem instancias de modulos: usa o circuito achatado
+  // (as portas de C mantem as ids; as portas dos modulos vem depois)
+  if (P->isHierarquico())
+  {
+    Circuito plano(C.achatar());
+    P = plano.getCompilado();
+    if (!P) return false;
+  }
+
+  const std::string codigo = gerarCodigo(*P);
+  char nome[32];
+  std::snprintf(nome, sizeof(nome), "circ_%016llx", (unsigned long long)hashCodigo(codigo));
+  const std::string base = DirCache + "/" + nome;
+  const std::string arq_so = base + ".so";
+
+  struct stat st;
+  if (stat(arq_so.c_str(),&st)!=0)
+  {
+    // Nao estah no cache: gera o fonte e compila para um nome temporario,
+    // que soh eh renomeado quando a compilacao termina (outro processo pode
+    // estar compilando o mesmo circuito ao mesmo tempo)
+    if (!criarDiretorio(DirCache)) return false;
+    const std::string tmp = base + "." + std::to_string(getpid());
+    const std::string arq_cpp = tmp + ".cpp";
+    const std::string arq_tmp = tmp + ".so";
+    {
+      std::ofstream ArqO(arq_cpp);
+      if (!ArqO.is_open()) return false;
+      ArqO << codigo;
+      if (!ArqO.good()) return false;
+    }
+
+    const char* cxx = std::getenv("CXX");
+    std::string cmd = std::string(cxx!=nullptr && cxx[0]!='\0' ? cxx : "c++") +
+                      " -O2 -shared -fPIC -o " + aspasShell(arq_tmp) + " " + aspasShell(arq_cpp);
+    bool ok = (std::system(cmd.c_str())==0) && (std::rename(arq_tmp.c_str(),arq_so.c_str())==0);
+    std::remove(arq_cpp.c_str());
+    if (!ok)
+    {
+      std::remove(arq_tmp.c_str());
+      return false;
+    }
+  }
+
+  biblioteca = dlopen(arq_so.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (biblioteca==nullptr) return false;
+  funcao = reinterpret_cast<FuncSimulacao>(dlsym(biblioteca,"simular_circuito"));
+  typedef int (*FuncNumSinais)();
+  FuncNumSinais num_sinais = reinterpret_cast<FuncNumSinais>(dlsym(biblioteca,"circuito_num_sinais"));
+  if (funcao==nullptr || num_sinais==nullptr || num_sinais()!=P->getNumSinais())
+  {
+    descarregar();
+    return false;
+  }
+  Nin = P->getNumInputs();
+  Nout = P->getNumOutputs();
+  Nsinais = P->getNumSinais();
+  sinais.resize(Nsinais);
+  return true;
+}
+
+// Descarrega a biblioteca, caso haja uma carregada
+void SimuladorNativo::descarregar()
+{
+  if (biblioteca!=nullptr) dlclose(biblioteca);
+  biblioteca = nullptr;
+  funcao = nullptr;
+  Nin = Nout = Nsinais = 0;
+  sinais.clear();
+}
+
+#else // _WIN32
+
+// Sem dlopen: o simulador nativo nao estah disponivel
+bool SimuladorNativo::carregar(Circuito& C, const std::string& DirCache)
+{
+  return false;
+}
+
+void SimuladorNativo::descarregar()
+{
+  biblioteca = nullptr;
+  funcao = nullptr;
+  Nin = Nout = Nsinais = 0;
+  sinais.clear();
+}
+
+#endif // _WIN32
+
+// Retorna true se ha um simulador carregado
+bool SimuladorNativo::carregado() const
+{
+  return funcao!=nullptr;
+}
+
+// Caracteristicas do circuito carregado
+int SimuladorNativo::getNumInputs() const
+{
+  return Nin;
+}
+
+int SimuladorNativo::getNumOutputs() const
+{
+  return Nout;
+}
+
+int SimuladorNativo::getNumSinais() const
+{
+  return Nsinais;
+}
+
+// Simula 64 vetores de entrada em paralelo
+void SimuladorNativo::simularLote(const Lote3S* in_circ, Lote3S* sinais, Lote3S* out_circ) const
+{
+  funcao(in_circ, sinais, out_circ);
+}
+
+bool SimuladorNativo::simularLote(const std::vector<Lote3S>& in_circ, std::vector<Lote3S>& out_lote)
+{
+  if (!carregado() || int(in_circ.size())!=Nin) return false;
+  out_lote.resize(Nout);
+  funcao(in_circ.data(), sinais.data(), out_lote.data());
+  return true;
+}
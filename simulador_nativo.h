@@ -0,0 +1,89 @@
+#ifndef _SIMULADOR_NATIVO_H_
+#define _SIMULADOR_NATIVO_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "lote3S.h"
+#include "circuito_compilado.h"
+
+class Circuito;
+
+///
+/// CLASSE SIMULADOR NATIVO
+///
+/// Simulador por codigo compilado: a partir de um circuito valido, gera um arquivo
+/// fonte C++ especifico para esse circuito (uma instrucao por porta, em ordem
+/// topologica, com as operacoes de Lote3S sobre 64 vetores em paralelo), compila-o
+/// com o compilador do sistema como biblioteca dinamica e a carrega (dlopen).
+/// As bibliotecas geradas sao guardadas em um diretorio de cache, com o nome
+/// derivado do hash do codigo gerado: um circuito jah compilado antes eh
+/// carregado diretamente, sem chamar o compilador.
+/// A funcao carregada tem a mesma interface de CircuitoCompilado::simularLote.
+/// Disponivel apenas em sistemas com dlopen (nao no Windows).
+///
+
+class SimuladorNativo {
+private:
+  // A funcao de simulacao gerada
+  typedef void (*FuncSimulacao)(const Lote3S* in_circ, Lote3S* sinais, Lote3S* out_circ);
+
+  // A biblioteca carregada (retorno de dlopen) e a funcao de simulacao
+  void* biblioteca;
+  FuncSimulacao funcao;
+  // Caracteristicas do circuito compilado
+  int Nin, Nout, Nsinais;
+  // O vetor de sinais de simularLote com vectors, dimensionado em carregar
+  std::vector<Lote3S> sinais;
+
+public:
+  // Cria um simulador sem nenhum circuito carregado
+  SimuladorNativo();
+  // Descarrega a biblioteca
+  ~SimuladorNativo();
+
+  // Nao pode ser copiado (a biblioteca soh deve ser descarregada uma vez)
+  SimuladorNativo(const SimuladorNativo&) = delete;
+  void operator=(const SimuladorNativo&) = delete;
+  SimuladorNativo(SimuladorNativo&& S) noexcept;
+  void operator=(SimuladorNativo&& S) noexcept;
+
+  // Gera o codigo fonte C++ do simulador de um circuito compilado
+  static std::string gerarCodigo(const CircuitoCompilado& P);
+  // O hash (FNV-1a de 64 bits) de um codigo fonte, usado como nome no cache
+  static uint64_t hashCodigo(const std::string& Codigo);
+  // O diretorio de cache padrao: $XDG_CACHE_HOME/simulador_circuito,
+  // $HOME/.cache/simulador_circuito ou /tmp/simulador_circuito
+  static std::string diretorioCachePadrao();
+
+  // Gera, compila (caso nao esteja no cache) e carrega o simulador do circuito C
+  // O compilador usado eh o da variavel de ambiente CXX ou, se nao houver, "c++"
+  // Se C tiver instancias de modulos, o simulador gerado eh o do circuito achatado
+  // (Circuito::achatar), com mais sinais que C (getNumSinais)
+  // Retorna false se o circuito nao for valido ou se a compilacao ou carga falhar
+  bool carregar(Circuito& C, const std::string& DirCache=diretorioCachePadrao());
+
+  // Descarrega a biblioteca, caso haja uma carregada
+  void descarregar();
+
+  // Retorna true se ha um simulador carregado
+  bool carregado() const;
+
+  // Caracteristicas do circuito carregado
+  int getNumInputs() const;
+  int getNumOutputs() const;
+  // Dimensao do vetor de sinais usado na simulacao
+  int getNumSinais() const;
+
+  // Simula 64 vetores de entrada em paralelo (mesma interface que
+  // CircuitoCompilado::simularLote). Soh deve ser chamado se carregado()
+  void simularLote(const Lote3S* in_circ, Lote3S* sinais, Lote3S* out_circ) const;
+
+  // O mesmo, com vectors: retorna false se nao houver simulador carregado ou se a
+  // dimensao de in_circ nao for valida; out_lote eh redimensionado
+  // Nao eh const: usa o vetor de sinais do simulador (nao pode ser chamado ao mesmo
+  // tempo por varias threads; nesse caso, cada uma deve usar a versao acima)
+  bool simularLote(const std::vector<Lote3S>& in_circ, std::vector<Lote3S>& out_lote);
+};
+
+#endif // _SIMULADOR_NATIVO_H_
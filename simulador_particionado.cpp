@@ -0,0 +1,359 @@
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#ifndef _WIN32
+#include <csignal>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#endif
+#include "simulador_particionado.h"
+#include "circuito_compilado.h"
+
+///
+/// CLASSE SIMULADOR PARTICIONADO
+///
+
+// O tamanho de uma linha de cache: os contadores de cada particao ficam em linhas
+// separadas, para uma particao nao invalidar a linha das outras
+static const size_t LINHA_CACHE = 64;
+
+static size_t alinhar(size_t N)
+{
+  return (N+LINHA_CACHE-1)/LINHA_CACHE*LINHA_CACHE;
+}
+
+SimuladorParticionado::SimuladorParticionado(Circuito& C, int NumParticoes, Modo M):
+  particoes(), modo(M), num_fatias(0), cpus_no(), no_particao()
+{
+  if (!particoes.particionar(C,NumParticoes)) return;
+  num_fatias = 2*particoes.getNumParticoes();
+  lerNos();
+}
+
+bool SimuladorParticionado::valid() const
+{
+  return particoes.valid();
+}
+
+SimuladorParticionado::Modo SimuladorParticionado::getModo() const
+{
+  return modo;
+}
+
+const ParticionamentoCircuito& SimuladorParticionado::getParticionamento() const
+{
+  return particoes;
+}
+
+void SimuladorParticionado::setNumFatias(int R)
+{
+  num_fatias = std::max(1,R);
+}
+
+int SimuladorParticionado::getNumFatias() const
+{
+  return num_fatias;
+}
+
+int SimuladorParticionado::getNumNos() const
+{
+  return cpus_no.size();
+}
+
+int SimuladorParticionado::getNo(int p) const
+{
+  return no_particao.at(p);
+}
+
+/// ***********************
+/// Topologia NUMA
+/// ***********************
+
+// Le as CPUs de cada no em /sys/devices/system/node/nodeN/cpulist (no formato
+// "0-3,8-11"), mantendo apenas as CPUs permitidas para o processo
+void SimuladorParticionado::lerNos()
+{
+  cpus_no.clear();
+#ifdef __linux__
+  cpu_set_t permitidas;
+  CPU_ZERO(&permitidas);
+  const bool tem_mascara = (sched_getaffinity(0,sizeof(permitidas),&permitidas)==0);
+  for (int N=0; ; N++)
+  {
+    std::ifstream arq("/sys/devices/system/node/node"+std::to_string(N)+"/cpulist");
+    if (!arq.is_open()) break;
+    std::string lista, faixa;
+    std::getline(arq,lista);
+    std::vector<int> cpus;
+    std::istringstream faixas(lista);
+    while (std::getline(faixas,faixa,','))
+    {
+      int ini, fim;
+      const int lidos = std::sscanf(faixa.c_str(),"%d-%d",&ini,&fim);
+      if (lidos<1) continue;
+      if (lidos==1) fim = ini;
+      for (int cpu=ini; cpu<=fim && cpu<CPU_SETSIZE; cpu++)
+      {
+        if (!tem_mascara || CPU_ISSET(cpu,&permitidas)) cpus.push_back(cpu);
+      }
+    }
+    // Nos sem CPUs (apenas memoria) nao recebem particoes
+    if (!cpus.empty()) cpus_no.push_back(cpus);
+  }
+#endif
+  // Sem informacao: um unico no, sem restricao
+  if (cpus_no.empty()) cpus_no.push_back(std::vector<int>());
+
+  const int K = particoes.getNumParticoes();
+  const int NN = cpus_no.size();
+  no_particao.resize(K);
+  // As particoes vizinhas (que trocam sinais) ficam no mesmo no sempre que possivel
+  for (int p=0; p<K; p++) no_particao[p] = (long)p*NN/K;
+}
+
+void SimuladorParticionado::fixarNo(int p) const
+{
+#ifdef __linux__
+  const std::vector<int>& cpus = cpus_no[no_particao[p]];
+  if (cpus.empty()) return;
+  cpu_set_t mascara;
+  CPU_ZERO(&mascara);
+  for (int cpu : cpus) CPU_SET(cpu,&mascara);
+  // Uma falha apenas deixa o executor sem restricao
+  sched_setaffinity(0,sizeof(mascara),&mascara);
+#else
+  (void)p;
+#endif
+}
+
+/// ***********************
+/// Simulacao
+/// ***********************
+
+size_t SimuladorParticionado::tamanhoArea(size_t NL) const
+{
+  const size_t K = particoes.getNumParticoes();
+  return K*LINHA_CACHE + LINHA_CACHE
+       + alinhar(size_t(num_fatias)*particoes.getNumTroca()*sizeof(Lote3S))
+       + NL*particoes.getNumOutputs()*sizeof(Lote3S);
+}
+
+// Mem deve estar alinhado a uma linha de cache, com tamanhoArea(NL) bytes
+SimuladorParticionado::Area SimuladorParticionado::dividirArea(char* Mem) const
+{
+  const size_t K = particoes.getNumParticoes();
+  Area A;
+  A.feito = reinterpret_cast<std::atomic<uint64_t>*>(Mem);
+  for (size_t p=0; p<K; p++) new (Mem+p*LINHA_CACHE) std::atomic<uint64_t>(0);
+  Mem += K*LINHA_CACHE;
+  A.erro = new (Mem) std::atomic<int>(0);
+  Mem += LINHA_CACHE;
+  A.troca = reinterpret_cast<Lote3S*>(Mem);
+  Mem += alinhar(size_t(num_fatias)*particoes.getNumTroca()*sizeof(Lote3S));
+  A.saidas = reinterpret_cast<Lote3S*>(Mem);
+  return A;
+}
+
+// O contador da particao p
+static inline std::atomic<uint64_t>& contador(std::atomic<uint64_t>* feito, int p)
+{
+  return *reinterpret_cast<std::atomic<uint64_t>*>(reinterpret_cast<char*>(feito)+p*LINHA_CACHE);
+}
+
+// Espera o contador da particao p chegar a Minimo
+// Retorna false se algum executor falhar durante a espera
+static bool esperar(std::atomic<uint64_t>* feito, int p, uint64_t Minimo, const std::atomic<int>* erro)
+{
+  int voltas = 0;
+  while (contador(feito,p).load(std::memory_order_acquire)<Minimo)
+  {
+    if (erro->load(std::memory_order_relaxed)) return false;
+    if (++voltas>=64)
+    {
+      std::this_thread::yield();
+      voltas = 0;
+    }
+  }
+  return true;
+}
+
+// O executor da particao p: simula os lotes em ordem, lendo as suas entradas das
+// entradas do circuito ou da fatia de troca do lote, e escrevendo as suas saidas
+// na mesma fatia
+void SimuladorParticionado::executar(int p, const Area& A,
+                                     const std::vector<std::vector<Lote3S>>& in_lotes) const
+{
+  fixarNo(p);
+
+  // Compilado e alocado jah no no da particao
+  CircuitoCompilado prog;
+  if (!prog.compilar(particoes.getSubcircuito(p)))
+  {
+    A.erro->store(1);
+    return;
+  }
+  const std::vector<int>& entradas = particoes.getEntradas(p);
+  const std::vector<int>& saidas = particoes.getSaidas(p);
+  std::vector<int> pos_in(entradas.size()), pos_out(saidas.size());
+  for (size_t j=0; j<entradas.size(); j++) pos_in[j] = particoes.getPosTroca(entradas[j]);
+  for (size_t j=0; j<saidas.size(); j++) pos_out[j] = particoes.getPosTroca(saidas[j]);
+  std::vector<Lote3S> in_local(entradas.size()), sinais(prog.getNumSinais()),
+                      out_local(saidas.size());
+
+  const int K = particoes.getNumParticoes();
+  const int Nout = particoes.getNumOutputs();
+  const size_t NT = particoes.getNumTroca();
+  const uint64_t NL = in_lotes.size();
+  for (uint64_t t=0; t<NL; t++)
+  {
+    // A particao anterior jah terminou o lote e a fatia nao estah mais em uso
+    if (p>0 && !esperar(A.feito,p-1,t+1,A.erro)) return;
+    if (t>=uint64_t(num_fatias) && !esperar(A.feito,K-1,t-num_fatias+1,A.erro)) return;
+
+    Lote3S* fatia = A.troca + (t%num_fatias)*NT;
+    const std::vector<Lote3S>& in_circ = in_lotes[t];
+    for (size_t j=0; j<entradas.size(); j++)
+    {
+      in_local[j] = (pos_in[j]<0 ? in_circ[entradas[j]] : fatia[pos_in[j]]);
+    }
+    prog.simularLote(in_local.data(), sinais.data(), out_local.data());
+    for (size_t j=0; j<saidas.size(); j++) fatia[pos_out[j]] = out_local[j];
+
+    // A ultima particao monta as saidas do circuito
+    if (p==K-1)
+    {
+      Lote3S* out_circ = A.saidas + t*Nout;
+      for (int IO=0; IO<Nout; IO++)
+      {
+        const int S = particoes.getIndiceSaida(IO);
+        const int pos = particoes.getPosTroca(S);
+        out_circ[IO] = (pos<0 ? in_circ[S] : fatia[pos]);
+      }
+    }
+    contador(A.feito,p).store(t+1,std::memory_order_release);
+  }
+}
+
+bool SimuladorParticionado::simularThreads(const Area& A,
+                                           const std::vector<std::vector<Lote3S>>& in_lotes)
+{
+  const int K = particoes.getNumParticoes();
+  std::vector<std::thread> executores;
+  executores.reserve(K);
+  for (int p=0; p<K; p++)
+  {
+    executores.emplace_back([this, p, &A, &in_lotes]() {executar(p,A,in_lotes);});
+  }
+  for (std::thread& th : executores) th.join();
+  return A.erro->load()==0;
+}
+
+bool SimuladorParticionado::simularProcessos(const Area& A,
+                                             const std::vector<std::vector<Lote3S>>& in_lotes)
+{
+#ifndef _WIN32
+  const int K = particoes.getNumParticoes();
+  std::vector<pid_t> filhos;
+  for (int p=0; p<K; p++)
+  {
+    const pid_t pid = fork();
+    if (pid==0)
+    {
+      executar(p,A,in_lotes);
+      _exit(A.erro->load()==0 ? 0 : 1);
+    }
+    if (pid<0)
+    {
+      A.erro->store(1);
+      break;
+    }
+    filhos.push_back(pid);
+  }
+
+  // Acompanha os filhos: um termino anormal interrompe os demais
+  while (!filhos.empty())
+  {
+    bool terminou = false;
+    for (size_t k=0; k<filhos.size(); )
+    {
+      int status;
+      const pid_t r = waitpid(filhos[k],&status,WNOHANG);
+      if (r==0)
+      {
+        k++;
+        continue;
+      }
+      if (r<0 || !WIFEXITED(status) || WEXITSTATUS(status)!=0) A.erro->store(1);
+      filhos.erase(filhos.begin()+k);
+      terminou = true;
+    }
+    if (A.erro->load()!=0)
+    {
+      for (pid_t pid : filhos) kill(pid,SIGKILL);
+      for (pid_t pid : filhos) waitpid(pid,nullptr,0);
+      filhos.clear();
+    }
+    else if (!terminou) usleep(100);
+  }
+  return A.erro->load()==0;
+#else
+  (void)A;
+  (void)in_lotes;
+  return false;
+#endif
+}
+
+bool SimuladorParticionado::simular(const std::vector<std::vector<Lote3S>>& in_lotes,
+                                    std::vector<std::vector<Lote3S>>& out_lotes)
+{
+  out_lotes.clear();
+  if (!valid()) return false;
+  const size_t Nin = particoes.getNumInputs();
+  for (const std::vector<Lote3S>& L : in_lotes) if (L.size()!=Nin) return false;
+  if (in_lotes.empty()) return true;
+
+  const size_t NL = in_lotes.size();
+  const size_t tam = tamanhoArea(NL);
+  const int Nout = particoes.getNumOutputs();
+  bool ok;
+  if (modo==Modo::PROCESSOS)
+  {
+#ifndef _WIN32
+    void* mem = mmap(nullptr,tam,PROT_READ|PROT_WRITE,MAP_SHARED|MAP_ANONYMOUS,-1,0);
+    if (mem==MAP_FAILED) return false;
+    const Area A = dividirArea(static_cast<char*>(mem));
+    ok = simularProcessos(A,in_lotes);
+    if (ok)
+    {
+      out_lotes.resize(NL);
+      for (size_t t=0; t<NL; t++) out_lotes[t].assign(A.saidas+t*Nout,A.saidas+(t+1)*Nout);
+    }
+    munmap(mem,tam);
+#else
+    ok = false;
+#endif
+  }
+  else
+  {
+    std::unique_ptr<char[]> bloco(new char[tam+LINHA_CACHE]);
+    char* mem = bloco.get();
+    mem += (LINHA_CACHE - reinterpret_cast<uintptr_t>(mem)%LINHA_CACHE)%LINHA_CACHE;
+    const Area A = dividirArea(mem);
+    ok = simularThreads(A,in_lotes);
+    if (ok)
+    {
+      out_lotes.resize(NL);
+      for (size_t t=0; t<NL; t++) out_lotes[t].assign(A.saidas+t*Nout,A.saidas+(t+1)*Nout);
+    }
+  }
+  return ok;
+}
@@ -0,0 +1,99 @@
+#ifndef _SIMULADOR_PARTICIONADO_H_
+#define _SIMULADOR_PARTICIONADO_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include "lote3S.h"
+#include "particionamento.h"
+
+///
+/// CLASSE SIMULADOR PARTICIONADO
+///
+/// Simula lotes de 64 vetores de entrada de um circuito sem realimentacao dividido em
+/// particoes (ParticionamentoCircuito), cada uma simulada por um executor proprio,
+/// em linha de producao: enquanto a particao p simula o lote t, a particao p+1
+/// simula o lote t-1, e assim por diante.
+/// - os executores trocam apenas os sinais cortados (e os que vao para as saidas),
+///   por um anel de NumFatias buffers de troca: o lote t usa a fatia t%NumFatias, que
+///   soh eh reutilizada depois que a ultima particao termina o lote t-NumFatias;
+/// - cada particao eh associada a um no NUMA (as particoes sao distribuidas pelos nos
+///   em ordem) e o seu executor fica restrito as CPUs desse no. O executor compila o
+///   seu subcircuito e aloca os seus vetores de trabalho jah restrito ao no, de modo
+///   que essa memoria fica no proprio no (politica de primeiro acesso do sistema);
+/// - Modo::THREADS: uma thread por particao, no proprio processo;
+/// - Modo::PROCESSOS: um processo filho (fork) por particao, com os buffers de troca
+///   e as saidas em memoria compartilhada. Um filho que termina de forma anormal
+///   interrompe a simulacao (simular retorna false). Soh existe fora do Windows.
+/// Os nos NUMA sao lidos de /sys/devices/system/node (Linux); sem essa informacao,
+/// todas as particoes ficam em um unico no, sem restricao de CPUs.
+/// O circuito eh particionado na construcao: alteracoes posteriores no Circuito nao
+/// afetam o simulador.
+///
+
+class SimuladorParticionado {
+public:
+  enum class Modo : uint8_t {
+    THREADS,
+    PROCESSOS
+  };
+
+private:
+  ParticionamentoCircuito particoes;
+  Modo modo;
+  int num_fatias;
+  // As CPUs de cada no NUMA e o no de cada particao
+  std::vector<std::vector<int>> cpus_no;
+  std::vector<int> no_particao;
+
+  // A area de controle e de troca, compartilhada pelos executores
+  struct Area {
+    // Os lotes jah terminados por cada particao (um contador por linha de cache)
+    std::atomic<uint64_t>* feito;
+    std::atomic<int>* erro;
+    // As fatias do anel de troca (NumFatias*getNumTroca() lotes)
+    Lote3S* troca;
+    // As saidas (NL*Nout lotes)
+    Lote3S* saidas;
+  };
+
+  // Le a topologia NUMA e distribui as particoes pelos nos
+  void lerNos();
+  // Restringe o executor atual as CPUs do no da particao p
+  void fixarNo(int p) const;
+  // O tamanho da area para NL lotes, e a divisao de um bloco de memoria nas partes
+  size_t tamanhoArea(size_t NL) const;
+  Area dividirArea(char* Mem) const;
+  // O trabalho do executor da particao p
+  void executar(int p, const Area& A, const std::vector<std::vector<Lote3S>>& in_lotes) const;
+  bool simularThreads(const Area& A, const std::vector<std::vector<Lote3S>>& in_lotes);
+  bool simularProcessos(const Area& A, const std::vector<std::vector<Lote3S>>& in_lotes);
+
+public:
+  // Particiona o circuito C em NumParticoes particoes (ver ParticionamentoCircuito)
+  // Se C for invalido ou tiver realimentacao, o simulador fica invalido
+  SimuladorParticionado(Circuito& C, int NumParticoes, Modo M=Modo::THREADS);
+
+  bool valid() const;
+  Modo getModo() const;
+  const ParticionamentoCircuito& getParticionamento() const;
+
+  // O numero de fatias do anel de troca (no minimo 1; padrao: 2 por particao)
+  // Mais fatias deixam as particoes mais independentes, com mais memoria
+  void setNumFatias(int R);
+  int getNumFatias() const;
+
+  // O numero de nos NUMA usados e o no da particao p
+  int getNumNos() const;
+  int getNo(int p) const;
+
+  // Simula os lotes de entrada: in_lotes[t] tem um Lote3S por entrada do circuito e
+  // out_lotes[t] recebe um Lote3S por saida
+  // Retorna false (out_lotes vazio) se o simulador for invalido, se algum lote tiver
+  // a dimensao errada ou se algum executor falhar
+  bool simular(const std::vector<std::vector<Lote3S>>& in_lotes,
+               std::vector<std::vector<Lote3S>>& out_lotes);
+};
+
+#endif // _SIMULADOR_PARTICIONADO_H_
@@ -0,0 +1,491 @@
+#include <algorithm>
+#include "tabela_bdd.h"
+#include "circuito.h"
+
+///
+/// CLASSE TABELA VERDADE EM BDD
+///
+
+namespace
+{
+  // Um sinal em dois trilhos: t (o sinal eh TRUE) e f (o sinal eh FALSE)
+  struct Par {
+    BDD t, f;
+  };
+
+  // As formulas do Lote3S, aplicadas aos BDDs
+  Par nao(const Par& x)
+  {
+    return Par{x.f, x.t};
+  }
+
+  Par e(const Par& x1, const Par& x2)
+  {
+    return Par{x1.t & x2.t, x1.f | x2.f};
+  }
+
+  Par ou(const Par& x1, const Par& x2)
+  {
+    return Par{x1.t | x2.t, x1.f & x2.f};
+  }
+
+  Par xou(const Par& x1, const Par& x2)
+  {
+    return Par{(x1.t & x2.f) | (x1.f & x2.t), (x1.t & x2.t) | (x1.f & x2.f)};
+  }
+
+  // Os codigos dos tipos avaliados diretamente pelas formulas
+  struct CodigosBasicos {
+    CodigoPorta NT, AN, NA, OR, NO, XO, NX, BF, AI, OI;
+
+    CodigosBasicos():
+      NT(RegistroPortas::getCodigo("NT")), AN(RegistroPortas::getCodigo("AN")),
+      NA(RegistroPortas::getCodigo("NA")), OR(RegistroPortas::getCodigo("OR")),
+      NO(RegistroPortas::getCodigo("NO")), XO(RegistroPortas::getCodigo("XO")),
+      NX(RegistroPortas::getCodigo("NX")), BF(RegistroPortas::getCodigo("BF")),
+      AI(RegistroPortas::getCodigo("AI")), OI(RegistroPortas::getCodigo("OI"))
+    {
+    }
+  };
+
+  const CodigosBasicos& codigos()
+  {
+    static const CodigosBasicos C;
+    return C;
+  }
+
+  // Monta a saida de uma porta a partir da tabela do seu kernel bool3S
+  // Cubo eh a condicao "entradas 0 a J-1 iguais a Valores[0..J-1]"; as combinacoes
+  // impossiveis (Cubo FALSO) nao sao expandidas. O literal de ? (nem t nem f) nao eh
+  // monotono nas combinacoes invalidas das entradas do circuito (t e f iguais a 1):
+  // o primeiro Cubo as exclui, para a avaliacao repetida dos lacos convergir
+  void expandirTabela(KernelPorta K, int N, int J, bool3S* Valores, const int* Idx,
+                      const std::vector<Par>& In, const BDD& Cubo, Par& Out)
+  {
+    if (J==N)
+    {
+      const bool3S v = K(Valores,Idx,N);
+      if (v==bool3S::TRUE) Out.t = Out.t | Cubo;
+      else if (v==bool3S::FALSE) Out.f = Out.f | Cubo;
+      return;
+    }
+    const BDD literal[3] = {~(In[J].t | In[J].f), In[J].f, In[J].t};
+    for (int x=0; x<3; x++)
+    {
+      const BDD c = Cubo & literal[x];
+      if (c.isFalso()) continue;
+      Valores[J] = bool3S(x);
+      expandirTabela(K,N,J+1,Valores,Idx,In,c,Out);
+    }
+  }
+
+  // Calcula a saida da porta IP do circuito compilado P, a partir dos sinais S
+  // (Validas: as combinacoes validas das entradas do circuito)
+  // Retorna false se a porta nao puder ser avaliada
+  bool avaliarPorta(GerenciadorBDD& G, const CircuitoCompilado& P, int IP,
+                    const std::vector<Par>& S, const BDD& Validas, Par& Out)
+  {
+    const CodigosBasicos& B = codigos();
+    const CodigoPorta cod = P.getCodigoPorta(IP);
+    const int N = P.getNumInputsPorta(IP);
+    std::vector<Par> in(N);
+    for (int I=0; I<N; I++) in[I] = S[P.getIndiceEntrada(IP,I)];
+
+    if (cod==B.NT || cod==B.BF)
+    {
+      Out = (cod==B.NT ? nao(in[0]) : in[0]);
+      return true;
+    }
+    if (cod==B.AN || cod==B.NA || cod==B.OR || cod==B.NO || cod==B.XO || cod==B.NX)
+    {
+      Out = in[0];
+      for (int I=1; I<N; I++)
+      {
+        if (cod==B.AN || cod==B.NA) Out = e(Out,in[I]);
+        else if (cod==B.OR || cod==B.NO) Out = ou(Out,in[I]);
+        else Out = xou(Out,in[I]);
+      }
+      if (cod==B.NA || cod==B.NO || cod==B.NX) Out = nao(Out);
+      return true;
+    }
+    if (cod==B.AI || cod==B.OI)
+    {
+      for (int I=0; I+1<N; I+=2)
+      {
+        const Par par = (cod==B.AI ? e(in[I],in[I+1]) : ou(in[I],in[I+1]));
+        if (I==0) Out = par;
+        else Out = (cod==B.AI ? ou(Out,par) : e(Out,par));
+      }
+      Out = nao(Out);
+      return true;
+    }
+
+    // Os demais tipos, pela tabela do kernel
+    const KernelPorta K = RegistroPortas::getKernel(cod,N);
+    if (K==nullptr || N>TabelaBDD::MAX_ENTRADAS_TABELA) return false;
+    bool3S valores[TabelaBDD::MAX_ENTRADAS_TABELA];
+    int idx[TabelaBDD::MAX_ENTRADAS_TABELA];
+    for (int I=0; I<N; I++) idx[I] = I;
+    Out = Par{G.falso(), G.falso()};
+    expandirTabela(K,N,0,valores,idx,in,Validas,Out);
+    return true;
+  }
+}
+
+/// ***********************
+/// Construcao
+/// ***********************
+
+TabelaBDD::TabelaBDD():
+  G(), max_nos(0), Nin(0), ordem(), nivel(), saida_t(), saida_f(), validas()
+{
+}
+
+void TabelaBDD::setMaxNos(size_t N)
+{
+  max_nos = N;
+}
+
+void TabelaBDD::clear()
+{
+  // Os BDDs antes do gerenciador
+  saida_t.clear();
+  saida_f.clear();
+  validas = BDD();
+  G.reset();
+  Nin = 0;
+  ordem.clear();
+  nivel.clear();
+}
+
+bool TabelaBDD::construir(Circuito& C)
+{
+  return construir(C,nullptr,nullptr);
+}
+
+bool TabelaBDD::construir(Circuito& C, const TabelaBDD& Base)
+{
+  if (!Base.valid() || &Base==this) return false;
+  return construir(C,Base.G,&Base.ordem);
+}
+
+// Constroi a tabela de C no gerenciador Ger (ou em um novo, se nullptr), com a ordem
+// de variaveis Ordem (ou a da busca em profundidade, se nullptr)
+bool TabelaBDD::construir(Circuito& C, std::shared_ptr<GerenciadorBDD> Ger,
+                          const std::vector<int>* Ordem)
+{
+  // Copia a ordem antes de limpar: pode ser a ordem desta propria tabela
+  std::vector<int> prov_ordem;
+  if (Ordem) prov_ordem = *Ordem;
+  clear();
+
+  Circuito plano;
+  if (C.temInstancias()) plano = C.achatar();
+  std::shared_ptr<const CircuitoCompilado> P = (C.temInstancias() ? plano : C).getCompilado();
+  if (!P) return false;
+
+  const int NI = P->getNumInputs();
+  const int NO = P->getNumOutputs();
+  const int NP = P->getNumPorts();
+  if (Ordem && int(prov_ordem.size())!=NI) return false;
+
+  // A ordem das entradas: a primeira visita em uma busca em profundidade a partir
+  // das saidas (as entradas fora dos cones das saidas ficam no final)
+  if (Ordem) ordem.swap(prov_ordem);
+  else
+  {
+    std::vector<char> visitado(P->getNumSinais(),0);
+    std::vector<int> pilha;
+    for (int IO=0; IO<NO; IO++)
+    {
+      pilha.push_back(P->getIndiceSaida(IO));
+      while (!pilha.empty())
+      {
+        const int S = pilha.back();
+        pilha.pop_back();
+        if (visitado[S]) continue;
+        visitado[S] = 1;
+        if (S<NI)
+        {
+          ordem.push_back(S);
+          continue;
+        }
+        // Empilha em ordem inversa: a entrada 0 da porta eh visitada primeiro
+        for (int I=P->getNumInputsPorta(S-NI)-1; I>=0; I--)
+        {
+          const int T = P->getIndiceEntrada(S-NI,I);
+          if (!visitado[T]) pilha.push_back(T);
+        }
+      }
+    }
+    for (int i=0; i<NI; i++) if (!visitado[i]) ordem.push_back(i);
+  }
+  nivel.assign(NI,0);
+  for (int L=0; L<NI; L++) nivel[ordem[L]] = L;
+
+  G = (Ger ? Ger : std::make_shared<GerenciadorBDD>(2*NI));
+  if (G->getNumVars()!=2*NI)
+  {
+    clear();
+    return false;
+  }
+  Nin = NI;
+  G->setMaxNos(max_nos);
+
+  bool ok = true;
+  try
+  {
+    validas = G->verdadeiro();
+    for (int L=NI-1; L>=0; L--) validas = validas & ~(G->var(2*L) & G->var(2*L+1));
+
+    // Todas as portas comecam com ? (t e f falsas)
+    std::vector<Par> sinais(P->getNumSinais(),Par{G->falso(), G->falso()});
+    for (int i=0; i<NI; i++) sinais[i] = Par{G->var(2*nivel[i]), G->var(2*nivel[i]+1)};
+
+    // Um circuito sem realimentacao precisa de uma unica passagem. Com realimentacao,
+    // cada passagem define mais portas (em algum vetor) ou nada muda: no maximo NP+1.
+    // Isso soh vale nos vetores validos: nos invalidos (entrada com t e f iguais a 1)
+    // as formulas nao sao monotonas e uma porta pode mudar mais de uma vez, por isso
+    // as saidas das portas sao restritas a validas a cada avaliacao
+    const int max_passagens = (P->isAciclico() ? 1 : NP+1);
+    bool mudou = true;
+    for (int K=0; ok && mudou && K<max_passagens; K++)
+    {
+      mudou = false;
+      for (int IP : P->getOrdem())
+      {
+        Par prov;
+        if (!avaliarPorta(*G,*P,IP,sinais,validas,prov))
+        {
+          ok = false;
+          break;
+        }
+        prov.t = prov.t & validas;
+        prov.f = prov.f & validas;
+        Par& s = sinais[NI+IP];
+        if (prov.t!=s.t || prov.f!=s.f)
+        {
+          s = prov;
+          mudou = true;
+        }
+      }
+    }
+    // Um tipo registrado nao monotono pode nunca estabilizar
+    if (!P->isAciclico() && mudou) ok = false;
+
+    if (ok)
+    {
+      saida_t.resize(NO);
+      saida_f.resize(NO);
+      for (int IO=0; IO<NO; IO++)
+      {
+        const Par& s = sinais[P->getIndiceSaida(IO)];
+        saida_t[IO] = s.t & validas;
+        saida_f[IO] = s.f & validas;
+      }
+    }
+  }
+  catch (GerenciadorBDD::LimiteNos&)
+  {
+    ok = false;
+  }
+
+  G->setMaxNos(0);
+  if (!ok)
+  {
+    clear();
+    return false;
+  }
+  G->coletar();
+  return true;
+}
+
+/// ***********************
+/// Consultas
+/// ***********************
+
+bool TabelaBDD::valid() const
+{
+  return G!=nullptr;
+}
+
+int TabelaBDD::getNumInputs() const
+{
+  return Nin;
+}
+
+int TabelaBDD::getNumOutputs() const
+{
+  return saida_t.size();
+}
+
+size_t TabelaBDD::getNumNos() const
+{
+  if (!G) return 0;
+  std::vector<BDD> prov(saida_t);
+  prov.insert(prov.end(),saida_f.begin(),saida_f.end());
+  return G->contarNos(prov);
+}
+
+// A funcao "saida IO igual a Valor": ? eh uma entrada valida em que nem t nem f valem
+BDD TabelaBDD::funcao(int IO, bool3S Valor) const
+{
+  if (Valor==bool3S::TRUE) return saida_t[IO];
+  if (Valor==bool3S::FALSE) return saida_f[IO];
+  return validas & ~(saida_t[IO] | saida_f[IO]);
+}
+
+// As variaveis t e f do nivel L dao o valor da entrada ordem[L]; uma variavel
+// indiferente (-1) eh tomada como 0
+void TabelaBDD::decodificar(const std::vector<int8_t>& Valores,
+                            std::vector<bool3S>& in_circ) const
+{
+  in_circ.resize(Nin);
+  for (int L=0; L<Nin; L++)
+  {
+    bool3S& x = in_circ[ordem[L]];
+    if (Valores[2*L]==1) x = bool3S::TRUE;
+    else if (Valores[2*L+1]==1) x = bool3S::FALSE;
+    else x = bool3S::UNDEF;
+  }
+}
+
+bool3S TabelaBDD::getOutput(int IdOutput, const std::vector<bool3S>& in_circ) const
+{
+  if (!G || IdOutput<1 || IdOutput>getNumOutputs() || int(in_circ.size())!=Nin)
+  {
+    return bool3S::UNDEF;
+  }
+  std::vector<bool> valores(2*Nin);
+  for (int i=0; i<Nin; i++)
+  {
+    valores[2*nivel[i]] = (in_circ[i]==bool3S::TRUE);
+    valores[2*nivel[i]+1] = (in_circ[i]==bool3S::FALSE);
+  }
+  if (G->avaliar(saida_t[IdOutput-1],valores)) return bool3S::TRUE;
+  if (G->avaliar(saida_f[IdOutput-1],valores)) return bool3S::FALSE;
+  return bool3S::UNDEF;
+}
+
+// As funcoes jah estao restritas as entradas validas: cada solucao eh um vetor
+uint64_t TabelaBDD::contar(int IdOutput, bool3S Valor) const
+{
+  if (!G || IdOutput<1 || IdOutput>getNumOutputs()) return 0;
+  return G->contarSolucoes(funcao(IdOutput-1,Valor));
+}
+
+bool TabelaBDD::procurar(int IdOutput, bool3S Valor, std::vector<bool3S>& in_circ) const
+{
+  if (!G || IdOutput<1 || IdOutput>getNumOutputs()) return false;
+  std::vector<int8_t> valores;
+  if (!G->satisfazer(funcao(IdOutput-1,Valor),valores)) return false;
+  decodificar(valores,in_circ);
+  return true;
+}
+
+// Com o mesmo gerenciador e a mesma ordem, funcoes iguais tem os mesmos nos
+bool TabelaBDD::equivalente(const TabelaBDD& T) const
+{
+  if (!G || G!=T.G || ordem!=T.ordem || getNumOutputs()!=T.getNumOutputs()) return false;
+  for (int IO=0; IO<getNumOutputs(); IO++)
+  {
+    if (saida_t[IO]!=T.saida_t[IO] || saida_f[IO]!=T.saida_f[IO]) return false;
+  }
+  return true;
+}
+
+bool TabelaBDD::procurarDiferenca(const TabelaBDD& T, std::vector<bool3S>& in_circ,
+                                  int& IdOutput) const
+{
+  if (!G || G!=T.G || ordem!=T.ordem || getNumOutputs()!=T.getNumOutputs()) return false;
+  for (int IO=0; IO<getNumOutputs(); IO++)
+  {
+    if (saida_t[IO]==T.saida_t[IO] && saida_f[IO]==T.saida_f[IO]) continue;
+    const BDD difere = (saida_t[IO] ^ T.saida_t[IO]) | (saida_f[IO] ^ T.saida_f[IO]);
+    std::vector<int8_t> valores;
+    G->satisfazer(difere,valores);
+    decodificar(valores,in_circ);
+    IdOutput = IO+1;
+    return true;
+  }
+  return false;
+}
+
+/// ***********************
+/// Listagem compacta
+/// ***********************
+
+// Percorre os niveis em ordem, dividindo os nos das saidas pelos tres valores da
+// entrada do nivel (?, F e T). Se os tres cofatores forem iguais, a entrada nao
+// influi nas linhas seguintes: uma unica linha com '-'
+// As entradas variam na ordem das variaveis do BDD (a do nivel 0 eh a que varia mais
+// devagar), e nao na ordem das entradas do circuito, como em gerarTabela
+void TabelaBDD::listar(std::ostream& O, int L, const std::vector<uint32_t>& Nos,
+                       std::vector<char>& Linha) const
+{
+  bool constantes = true;
+  for (uint32_t u : Nos) if (u>1) constantes = false;
+  if (L==Nin || constantes)
+  {
+    for (int i=0; i<Nin; i++)
+    {
+      O << Linha[i];
+      if (i<Nin-1) O << ' ';
+      else
+      {
+        O << '\t';
+        if (Nin<=2) O << '\t';
+      }
+    }
+    for (size_t j=0; j<Nos.size(); j+=2)
+    {
+      O << (Nos[j]==1 ? bool3S::TRUE : (Nos[j+1]==1 ? bool3S::FALSE : bool3S::UNDEF));
+      O << (j+2<Nos.size() ? ' ' : '\n');
+    }
+    return;
+  }
+
+  // O cofator de u para a entrada do nivel L com o valor x: primeiro a variavel t
+  // (2*L), depois a variavel f (2*L+1)
+  const uint32_t vt = 2*L, vf = 2*L+1;
+  auto cofator = [&](uint32_t u, bool3S x)
+  {
+    if (G->getVar(u)==vt) u = (x==bool3S::TRUE ? G->getAlto(u) : G->getBaixo(u));
+    if (G->getVar(u)==vf) u = (x==bool3S::FALSE ? G->getAlto(u) : G->getBaixo(u));
+    return u;
+  };
+  std::vector<uint32_t> cof[3];
+  for (int x=0; x<3; x++)
+  {
+    cof[x].resize(Nos.size());
+    for (size_t j=0; j<Nos.size(); j++) cof[x][j] = cofator(Nos[j],bool3S(x));
+  }
+
+  char& c = Linha[ordem[L]];
+  if (cof[0]==cof[1] && cof[1]==cof[2])
+  {
+    listar(O,L+1,cof[0],Linha);
+    return;
+  }
+  for (int x=0; x<3; x++)
+  {
+    c = "?FT"[x];
+    listar(O,L+1,cof[x],Linha);
+  }
+  c = '-';
+}
+
+std::ostream& TabelaBDD::imprimirTabela(std::ostream& O) const
+{
+  O << "ENTRADAS" << '\t' << "SAIDAS" << std::endl;
+  if (!G) return O;
+  std::vector<uint32_t> nos;
+  for (int IO=0; IO<getNumOutputs(); IO++)
+  {
+    nos.push_back(saida_t[IO].getNo());
+    nos.push_back(saida_f[IO].getNo());
+  }
+  std::vector<char> linha(Nin,'-');
+  listar(O,0,nos,linha);
+  return O;
+}
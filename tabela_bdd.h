@@ -0,0 +1,118 @@
+#ifndef _TABELA_BDD_H_
+#define _TABELA_BDD_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "bool3S.h"
+#include "bdd.h"
+
+class Circuito;
+
+///
+/// CLASSE TABELA VERDADE EM BDD
+///
+/// Representa simbolicamente a tabela verdade completa de um circuito (as 3^Nin
+/// linhas geradas por gerarTabela), sem enumerar as linhas. Usa a mesma codificacao
+/// em dois trilhos do Lote3S: cada sinal eh um par de BDDs (t, f), onde t eh a funcao
+/// "o sinal eh TRUE" e f eh a funcao "o sinal eh FALSE" (? quando as duas sao falsas).
+/// Cada entrada do circuito corresponde a duas variaveis de BDD adjacentes (t e f):
+/// T = (1,0), F = (0,1) e ? = (0,0); a combinacao (1,1) nao eh uma entrada valida.
+/// - as portas sao avaliadas com as mesmas formulas do Lote3S (as basicas, BF, AI e
+///   OI) ou, para os demais tipos (MX, MJ, TS e tipos registrados com ateh
+///   MAX_ENTRADAS_TABELA entradas), pela tabela do kernel bool3S do tipo;
+/// - os circuitos com realimentacao sao avaliados repetidamente (na ordem do
+///   circuito compilado), a partir de todas as portas ?, ateh nenhum par mudar: o
+///   resultado eh o mesmo da simulacao para todos os vetores de entrada;
+/// - as instancias de modulos sao achatadas antes da construcao;
+/// - as funcoes das saidas sao restritas as combinacoes validas das entradas, de
+///   modo que duas tabelas iguais tem os mesmos nos (canonicas);
+/// - a ordem das variaveis segue a primeira visita as entradas em uma busca em
+///   profundidade a partir das saidas (entradas usadas juntas ficam proximas).
+/// As consultas (valor de uma linha, contagem, busca de um vetor com uma dada saida e
+/// equivalencia) sao feitas sobre os BDDs; a listagem compacta (imprimirTabela)
+/// agrupa as linhas em que uma entrada nao influi.
+/// Duas tabelas soh podem ser comparadas se usarem o mesmo gerenciador e a mesma
+/// ordem de variaveis (construidas com construir(C, Base)).
+///
+
+class TabelaBDD {
+public:
+  // O maior numero de entradas de uma porta avaliada pela tabela do kernel
+  static constexpr int MAX_ENTRADAS_TABELA = 8;
+
+private:
+  // O gerenciador (compartilhado pelas tabelas construidas a partir desta)
+  // Declarado antes dos BDDs: eh destruido depois deles
+  std::shared_ptr<GerenciadorBDD> G;
+  size_t max_nos;
+  int Nin;
+  // A entrada de cada nivel (variaveis 2*L e 2*L+1) e o nivel de cada entrada
+  std::vector<int> ordem;
+  std::vector<int> nivel;
+  // As funcoes t e f de cada saida (restritas as entradas validas)
+  std::vector<BDD> saida_t, saida_f;
+  // As combinacoes validas das entradas (nenhuma com t e f iguais a 1)
+  BDD validas;
+
+  bool construir(Circuito& C, std::shared_ptr<GerenciadorBDD> Ger,
+                 const std::vector<int>* Ordem);
+  // A funcao "saida IO igual a Valor" (restrita as entradas validas)
+  BDD funcao(int IO, bool3S Valor) const;
+  // Converte uma atribuicao das variaveis em um vetor de entrada
+  void decodificar(const std::vector<int8_t>& Valores, std::vector<bool3S>& in_circ) const;
+  // Lista as linhas a partir do nivel L, para os nos Nos das saidas (t e f alternados)
+  void listar(std::ostream& O, int L, const std::vector<uint32_t>& Nos,
+              std::vector<char>& Linha) const;
+
+public:
+  // Tabela vazia
+  TabelaBDD();
+
+  // Limita o numero de nos do gerenciador durante a construcao (0: sem limite)
+  void setMaxNos(size_t N);
+
+  // Constroi a tabela do circuito C, com um novo gerenciador
+  // Retorna false (e fica vazia) se C for invalido, tiver uma porta que nao pode ser
+  // avaliada ou se o numero de nos passar do limite
+  bool construir(Circuito& C);
+  // Constroi a tabela de C no gerenciador e com a ordem de variaveis de Base, para
+  // poder ser comparada com ela. Retorna false se Base estiver vazia ou tiver outro
+  // numero de entradas
+  bool construir(Circuito& C, const TabelaBDD& Base);
+
+  void clear();
+  bool valid() const;
+  int getNumInputs() const;
+  int getNumOutputs() const;
+  // O numero de nos distintos usados pelas saidas
+  size_t getNumNos() const;
+
+  // O valor da saida IdOutput (1 a Nout) para o vetor in_circ (a linha da tabela)
+  bool3S getOutput(int IdOutput, const std::vector<bool3S>& in_circ) const;
+  // O numero de vetores de entrada (das 3^Nin combinacoes) em que a saida IdOutput
+  // vale Valor (exato ateh 40 entradas)
+  uint64_t contar(int IdOutput, bool3S Valor) const;
+  // Procura um vetor de entrada em que a saida IdOutput vale Valor
+  // Retorna false se nao existir
+  bool procurar(int IdOutput, bool3S Valor, std::vector<bool3S>& in_circ) const;
+
+  // Retorna true se as duas tabelas forem iguais (a mesma saida para todos os
+  // vetores de entrada). Exige o mesmo gerenciador e a mesma ordem de variaveis
+  bool equivalente(const TabelaBDD& T) const;
+  // Procura um vetor de entrada em que as tabelas diferem; IdOutput recebe a primeira
+  // saida diferente. Retorna false se forem iguais ou nao puderem ser comparadas
+  bool procurarDiferenca(const TabelaBDD& T, std::vector<bool3S>& in_circ,
+                         int& IdOutput) const;
+
+  // Imprime a tabela verdade em forma compacta: cada linha vale para todas as
+  // combinacoes das entradas marcadas com '-', no mesmo formato de gerarTabela
+  // As linhas NAO seguem a ordem de gerarTabela: as entradas variam na ordem das
+  // variaveis do BDD (a primeira variavel varia mais devagar), com ?, F e T nessa
+  // ordem para cada uma
+  std::ostream& imprimirTabela(std::ostream& O=std::cout) const;
+};
+
+#endif // _TABELA_BDD_H_
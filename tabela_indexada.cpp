@@ -0,0 +1,301 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <thread>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#include "tabela_indexada.h"
+#include "circuito.h"
+#include "circuito_compilado.h"
+#include "estimulos.h"
+#include "lote3S.h"
+
+///
+/// CLASSE TABELA INDEXADA
+///
+
+// Formato do cabecalho: a marca "TAB3SIDX", Nin e Nout (32 bits), o numero de linhas,
+// os bytes por linha e a posicao da primeira linha (64 bits), completado com zeros
+static const char MARCA_TABELA[8] = {'T','A','B','3','S','I','D','X'};
+
+// O numero aproximado de bytes de linhas gerados de cada vez
+static const size_t TAM_GRUPO = size_t(16)<<20;
+
+TabelaIndexada::TabelaIndexada():
+  Nin(0), Nout(0), num_linhas(0), bytes_por_linha(0), linhas(nullptr), mapa(nullptr),
+  tam_mapa(0), copia()
+{
+}
+
+TabelaIndexada::~TabelaIndexada()
+{
+  fechar();
+}
+
+/// ***********************
+/// Geracao
+/// ***********************
+
+// Copia as saidas das NPistas pistas do lote para as linhas (uma por pista), que
+// devem estar zeradas
+static void empacotar(const Lote3S* out_lote, int Nout, int NPistas, size_t BytesPorLinha,
+                      uint8_t* Linhas)
+{
+  for (int j=0; j<Nout; j++)
+  {
+    const uint64_t t = out_lote[j].t, f = out_lote[j].f;
+    const int desl = 2*(j%4);
+    uint8_t* p = Linhas + j/4;
+    for (int k=0; k<NPistas; k++, p+=BytesPorLinha)
+    {
+      *p |= uint8_t((((t>>k)&1)<<1 | ((f>>k)&1)) << desl);
+    }
+  }
+}
+
+// Gera o arquivo Arq com a tabela verdade do circuito C
+// As linhas sao geradas em grupos de lotes: as threads pegam os lotes do grupo por um
+// contador atomico, e cada lote preenche uma parte diferente do buffer do grupo. Ha
+// dois buffers: enquanto um grupo eh gravado (em outra thread), o seguinte eh gerado
+bool TabelaIndexada::gerar(Circuito& C, const std::string& Arq, int NumThreads)
+{
+  std::shared_ptr<const CircuitoCompilado> P = C.getCompilado();
+  if (!P || P->getNumInputs()>EnumeradorExaustivo::MAX_ENTRADAS) return false;
+
+  const int NI = P->getNumInputs();
+  const int NO = P->getNumOutputs();
+  const EnumeradorExaustivo E(NI);
+  const uint64_t NL = E.getNumVetores();
+  const size_t BL = (NO+3)/4;
+  // O arquivo nao pode passar de 2^62 bytes
+  if (BL>0 && NL>((uint64_t(1)<<62)/BL)) return false;
+
+  std::ofstream ArqO(Arq, std::ios::binary);
+  if (!ArqO.is_open()) return false;
+  uint8_t cabecalho[TAM_CABECALHO] = {};
+  const uint32_t dimensoes[2] = {uint32_t(NI), uint32_t(NO)};
+  const uint64_t tamanhos[3] = {NL, BL, TAM_CABECALHO};
+  std::memcpy(cabecalho, MARCA_TABELA, 8);
+  std::memcpy(cabecalho+8, dimensoes, sizeof(dimensoes));
+  std::memcpy(cabecalho+16, tamanhos, sizeof(tamanhos));
+  ArqO.write(reinterpret_cast<const char*>(cabecalho), TAM_CABECALHO);
+
+  const uint64_t NLotes = E.getNumLotes();
+  const uint64_t LotesGrupo = std::max<uint64_t>(1, TAM_GRUPO/(NUM_PISTAS*std::max<size_t>(BL,1)));
+  int NThreads = NumThreads;
+  if (NThreads<=0) NThreads = std::thread::hardware_concurrency();
+  if (NThreads<=0) NThreads = 1;
+  if (uint64_t(NThreads)>LotesGrupo) NThreads = int(LotesGrupo);
+
+  std::vector<uint8_t> buffer[2];
+  std::thread escrita;
+  for (uint64_t K0=0, g=0; K0<NLotes; K0+=LotesGrupo, g^=1)
+  {
+    const uint64_t K1 = std::min(NLotes, K0+LotesGrupo);
+    const uint64_t R0 = K0*NUM_PISTAS;
+    const uint64_t R1 = std::min(NL, K1*NUM_PISTAS);
+    // O buffer g foi gravado dois grupos atras: a gravacao jah terminou, pois a do
+    // grupo anterior (no outro buffer) soh comecou depois dela
+    std::vector<uint8_t>& B = buffer[g];
+    B.assign((R1-R0)*BL, 0);
+
+    std::atomic<uint64_t> proximo(K0);
+    auto trabalho = [&]()
+    {
+      std::vector<Lote3S> in_lote(NI), out_lote(NO), sinais(P->getNumSinais());
+      uint64_t K;
+      while ((K = proximo.fetch_add(1)) < K1)
+      {
+        const int NPistas = E.gerarLote(K, in_lote.data());
+        P->simularLote(in_lote.data(), sinais.data(), out_lote.data());
+        empacotar(out_lote.data(), NO, NPistas, BL, B.data()+(K*NUM_PISTAS-R0)*BL);
+      }
+    };
+    std::vector<std::thread> threads;
+    for (int t=1; t<NThreads; t++) threads.emplace_back(trabalho);
+    trabalho();
+    for (std::thread& T : threads) T.join();
+
+    // Este grupo foi gerado enquanto o anterior era gravado; a sua gravacao comeca
+    // quando a do anterior termina
+    if (escrita.joinable()) escrita.join();
+    escrita = std::thread([&ArqO, &B]()
+    {
+      ArqO.write(reinterpret_cast<const char*>(B.data()), B.size());
+    });
+  }
+  if (escrita.joinable()) escrita.join();
+  ArqO.close();
+  return !ArqO.fail();
+}
+
+/// ***********************
+/// Abertura
+/// ***********************
+
+bool TabelaIndexada::abrir(const std::string& Arq)
+{
+  fechar();
+
+  const uint8_t* dados = nullptr;
+  size_t tam = 0;
+#ifndef _WIN32
+  const int fd = ::open(Arq.c_str(), O_RDONLY);
+  if (fd<0) return false;
+  struct stat st;
+  if (fstat(fd,&st)==0 && size_t(st.st_size)>=TAM_CABECALHO)
+  {
+    void* m = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    if (m!=MAP_FAILED)
+    {
+      mapa = m;
+      tam_mapa = st.st_size;
+      dados = static_cast<const uint8_t*>(m);
+      tam = tam_mapa;
+    }
+  }
+  ::close(fd);
+#else
+  std::ifstream ArqI(Arq, std::ios::binary);
+  if (ArqI.is_open())
+  {
+    ArqI.seekg(0, std::ios::end);
+    copia.resize(size_t(ArqI.tellg()));
+    ArqI.seekg(0);
+    ArqI.read(reinterpret_cast<char*>(copia.data()), copia.size());
+    if (ArqI.good())
+    {
+      dados = copia.data();
+      tam = copia.size();
+    }
+  }
+#endif
+  if (dados==nullptr || tam<TAM_CABECALHO)
+  {
+    fechar();
+    return false;
+  }
+
+  // Confere o cabecalho e o tamanho do arquivo
+  uint32_t dimensoes[2];
+  uint64_t tamanhos[3];
+  std::memcpy(dimensoes, dados+8, sizeof(dimensoes));
+  std::memcpy(tamanhos, dados+16, sizeof(tamanhos));
+  bool ok = (std::memcmp(dados, MARCA_TABELA, 8)==0 &&
+             dimensoes[0]<=uint32_t(EnumeradorExaustivo::MAX_ENTRADAS) &&
+             tamanhos[0]==EnumeradorExaustivo(dimensoes[0]).getNumVetores() &&
+             tamanhos[1]==(uint64_t(dimensoes[1])+3)/4 && tamanhos[2]>=TAM_CABECALHO &&
+             tamanhos[2]<=tam);
+  if (ok && tamanhos[1]>0)
+  {
+    ok = (tamanhos[0]<=(tam-tamanhos[2])/tamanhos[1]);
+  }
+  if (!ok)
+  {
+    fechar();
+    return false;
+  }
+
+  Nin = dimensoes[0];
+  Nout = dimensoes[1];
+  num_linhas = tamanhos[0];
+  bytes_por_linha = tamanhos[1];
+  linhas = dados+tamanhos[2];
+  return true;
+}
+
+void TabelaIndexada::fechar()
+{
+#ifndef _WIN32
+  if (mapa!=nullptr) munmap(mapa, tam_mapa);
+#endif
+  mapa = nullptr;
+  tam_mapa = 0;
+  copia.clear();
+  copia.shrink_to_fit();
+  linhas = nullptr;
+  Nin = Nout = 0;
+  num_linhas = 0;
+  bytes_por_linha = 0;
+}
+
+bool TabelaIndexada::aberto() const
+{
+  return linhas!=nullptr;
+}
+
+int TabelaIndexada::getNumInputs() const
+{
+  return Nin;
+}
+
+int TabelaIndexada::getNumOutputs() const
+{
+  return Nout;
+}
+
+uint64_t TabelaIndexada::getNumLinhas() const
+{
+  return num_linhas;
+}
+
+size_t TabelaIndexada::getBytesPorLinha() const
+{
+  return bytes_por_linha;
+}
+
+/// ***********************
+/// Consulta
+/// ***********************
+
+// O numero da linha: in_circ lido como um numero na base 3 (primeira entrada = digito
+// mais significativo)
+uint64_t TabelaIndexada::getIndice(const std::vector<bool3S>& in_circ) const
+{
+  if (!aberto() || int(in_circ.size())!=Nin) return num_linhas;
+  uint64_t R = 0;
+  for (bool3S x : in_circ) R = 3*R + uint64_t(x);
+  return R;
+}
+
+bool TabelaIndexada::consultar(uint64_t R, std::vector<bool3S>& out_circ) const
+{
+  if (R>=num_linhas) return false;
+  out_circ.resize(Nout);
+  for (int j=0; j<Nout; j++)
+  {
+    const bool3S x = getSaida(R, j+1);
+    // 11 (invalido, arquivo corrompido) vira ?
+    out_circ[j] = (int(x)==3 ? bool3S::UNDEF : x);
+  }
+  return true;
+}
+
+// As linhas e VetorCompacto3S usam a mesma disposicao dos bits: cada palavra de
+// VetorCompacto3S sao 8 bytes consecutivos da linha
+bool TabelaIndexada::consultar(uint64_t R, VetorCompacto3S& out_compacto) const
+{
+  if (R>=num_linhas) return false;
+  out_compacto.resize(Nout);
+  const uint8_t* L = getLinha(R);
+  for (size_t W=0; W<out_compacto.getNumPalavras(); W++)
+  {
+    uint64_t p = 0;
+    const size_t b0 = 8*W, b1 = std::min(bytes_por_linha, b0+8);
+    for (size_t b=b0; b<b1; b++) p |= uint64_t(L[b]) << (8*(b-b0));
+    out_compacto.setPalavra(W, p);
+  }
+  return true;
+}
+
+bool TabelaIndexada::consultar(const std::vector<bool3S>& in_circ,
+                               std::vector<bool3S>& out_circ) const
+{
+  return consultar(getIndice(in_circ), out_circ);
+}
@@ -0,0 +1,98 @@
+#ifndef _TABELA_INDEXADA_H_
+#define _TABELA_INDEXADA_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "vetor_compacto3S.h"
+
+class Circuito;
+
+///
+/// CLASSE TABELA INDEXADA
+///
+/// Tabela verdade completa de um circuito gravada em arquivo, com acesso direto a
+/// qualquer linha, sem o circuito e sem gerar as outras linhas.
+/// A linha de numero R eh a do vetor de entrada que eh a representacao de R na base 3
+/// (mesma ordem de gerarTabela e de EnumeradorExaustivo: a primeira entrada eh o
+/// digito mais significativo e cada digito segue o operador ++ de bool3S: ?, F, T).
+/// Todas as linhas ocupam o mesmo numero de bytes, com as saidas compactadas como em
+/// VetorCompacto3S (2 bits por saida: ?=00, F=01, T=10; a saida j, de 0 a Nout-1,
+/// ocupa os bits 2*(j%4) e 2*(j%4)+1 do byte j/4 da linha). Formato do arquivo:
+///   cabecalho de 64 bytes ("TAB3SIDX", Nin, Nout, numero de linhas, bytes por linha,
+///   posicao da primeira linha) | linhas 0 a 3^Nin-1
+/// A linha R comeca na posicao inicio+R*bytes_por_linha: a consulta eh O(1). Em
+/// sistemas POSIX o arquivo eh mapeado em memoria (mmap), de modo que soh as paginas
+/// consultadas sao lidas do disco; nos demais, ele eh lido por inteiro.
+/// A tabela eh gerada pelo simulador compilado, 64 linhas por vez (simularLote), em
+/// varias threads, e gravada em grupos de linhas.
+///
+
+class TabelaIndexada {
+private:
+  int Nin, Nout;
+  uint64_t num_linhas;
+  size_t bytes_por_linha;
+  // O inicio das linhas (dentro do mapeamento ou da copia do arquivo)
+  const uint8_t* linhas;
+  // O mapeamento do arquivo (POSIX) ou a copia do arquivo em memoria
+  void* mapa;
+  size_t tam_mapa;
+  std::vector<uint8_t> copia;
+
+  // Proibe a copia (o mapeamento pertence a um unico objeto)
+  TabelaIndexada(const TabelaIndexada&) = delete;
+  TabelaIndexada& operator=(const TabelaIndexada&) = delete;
+
+public:
+  // O tamanho do cabecalho do arquivo
+  static constexpr size_t TAM_CABECALHO = 64;
+
+  TabelaIndexada();
+  ~TabelaIndexada();
+
+  // Gera o arquivo Arq com a tabela verdade do circuito C, em NumThreads threads
+  // (0: uma por processador)
+  // Retorna false se o circuito for invalido, tiver mais de
+  // EnumeradorExaustivo::MAX_ENTRADAS entradas ou se houver erro de escrita
+  static bool gerar(Circuito& C, const std::string& Arq, int NumThreads=0);
+
+  // Abre (mapeia) o arquivo Arq. Retorna false se nao for uma tabela valida
+  bool abrir(const std::string& Arq);
+  void fechar();
+  bool aberto() const;
+
+  int getNumInputs() const;
+  int getNumOutputs() const;
+  // O numero de linhas (3^Nin) e o numero de bytes de cada linha
+  uint64_t getNumLinhas() const;
+  size_t getBytesPorLinha() const;
+
+  // O numero da linha do vetor de entrada in_circ (com Nin valores)
+  // Retorna getNumLinhas() se a dimensao de in_circ for invalida
+  uint64_t getIndice(const std::vector<bool3S>& in_circ) const;
+
+  // Os bytes da linha R (0 a getNumLinhas()-1, sem conferencia)
+  const uint8_t* getLinha(uint64_t R) const
+  {
+    return linhas + R*bytes_por_linha;
+  }
+  // O valor da saida IdOut (1 a Nout) na linha R (sem conferencia)
+  bool3S getSaida(uint64_t R, int IdOut) const
+  {
+    const int j = IdOut-1;
+    return bool3S((getLinha(R)[j/4] >> (2*(j%4))) & 3);
+  }
+
+  // Os valores de todas as saidas na linha R (out_circ eh redimensionado para Nout)
+  // Retorna false se R for invalido
+  bool consultar(uint64_t R, std::vector<bool3S>& out_circ) const;
+  bool consultar(uint64_t R, VetorCompacto3S& out_compacto) const;
+  // Os valores de todas as saidas para o vetor de entrada in_circ
+  // Retorna false se a dimensao de in_circ for invalida
+  bool consultar(const std::vector<bool3S>& in_circ, std::vector<bool3S>& out_circ) const;
+};
+
+#endif // _TABELA_INDEXADA_H_
@@ -0,0 +1,288 @@
+#include <algorithm>
+#include <functional>
+#include <thread>
+#include "validador.h"
+#include "modulo.h"
+
+///
+/// CLASSE VALIDADOR DE CIRCUITO
+///
+
+ValidadorCircuito::ValidadorCircuito():
+  num_threads(0), detectar_lacos(true), erros(), num_erros(0)
+{
+}
+
+void ValidadorCircuito::setNumThreads(int NThreads)
+{
+  num_threads = std::max(0,NThreads);
+}
+
+void ValidadorCircuito::setDetectarLacos(bool Detectar)
+{
+  detectar_lacos = Detectar;
+}
+
+// Confere o circuito C em uma unica passada pelas entradas das portas
+// As portas sao divididas em faixas contiguas, uma por thread: cada thread confere
+// os tipos e as ids de origem das suas portas, lidos diretamente dos vetores do
+// circuito (sem copia), guardando os problemas em uma lista propria (as listas sao
+// concatenadas na ordem das faixas)
+bool ValidadorCircuito::verificar(const Circuito& C)
+{
+  const int NI = C.getNumInputs();
+  const int NO = C.getNumOutputs();
+  const int NP = C.getNumPorts();
+
+  erros.clear();
+  num_erros = 0;
+  if (NI<=0 || NO<=0 || NP<=0) erros.push_back(Erro{TipoErro::DIMENSAO,0,-1,0,0});
+
+  int NThreads = (num_threads>0 ? num_threads : int(std::thread::hardware_concurrency()));
+  // Faixas muito pequenas nao compensam o custo de criar as threads
+  NThreads = std::max(1,std::min(NThreads,NP/65536+1));
+
+  std::vector<std::vector<Erro>> erros_faixa(NThreads);
+  auto faixa = [NP,NThreads](int T, int& I0, int& I1)
+  {
+    I0 = int(int64_t(NP)*T/NThreads);
+    I1 = int(int64_t(NP)*(T+1)/NThreads);
+  };
+  auto executar = [NThreads](const std::function<void(int)>& F)
+  {
+    std::vector<std::thread> threads;
+    for (int T=1; T<NThreads; T++) threads.emplace_back(F,T);
+    F(0);
+    for (std::thread& T : threads) T.join();
+  };
+
+  executar([&](int T)
+  {
+    int I0, I1;
+    faixa(T,I0,I1);
+    std::vector<Erro>& E(erros_faixa[T]);
+    for (int i=I0; i<I1; i++)
+    {
+      const CodigoPorta tipo = C.portas->tipo[i];
+      if (tipo==CODIGO_INVALIDO)
+      {
+        E.push_back(Erro{TipoErro::PORTA_INDEFINIDA,i+1,-1,0,0});
+        continue;
+      }
+      const int N = C.portas->num_in[i];
+      int saida;
+      const bool ok = (tipo==CODIGO_INSTANCIA ? N==C.getModuloPort(i+1,saida)->getNumInputs() :
+                       RegistroPortas::validNumInputs(tipo,N));
+      if (!ok) E.push_back(Erro{TipoErro::NUM_ENTRADAS,i+1,-1,0,N});
+      const int* id = C.portas->id_in.data()+C.portas->ini_in[i];
+      for (int j=0; j<N; j++)
+      {
+        if (id[j]==0 || id[j]<-NI || id[j]>NP)
+        {
+          E.push_back(Erro{TipoErro::ID_INVALIDA,i+1,j,0,id[j]});
+        }
+      }
+    }
+  });
+  for (const std::vector<Erro>& E : erros_faixa) erros.insert(erros.end(),E.begin(),E.end());
+
+  for (int j=0; j<NO; j++)
+  {
+    const int id = C.getIdOutput(j+1);
+    if (id==0) erros.push_back(Erro{TipoErro::SAIDA_FLUTUANTE,0,-1,j+1,0});
+    else if (id<-NI || id>NP) erros.push_back(Erro{TipoErro::ID_INVALIDA,0,-1,j+1,id});
+  }
+  num_erros = erros.size();
+
+  if (detectar_lacos && NP>0)
+  {
+    procurarLacos(NP,C.portas->tipo.data(),C.portas->ini_in.data(),C.portas->num_in.data(),
+                  C.portas->id_in.data());
+  }
+  return num_erros==0;
+}
+
+// Procura os lacos nas ligacoes entre portas
+// Primeiro retira (algoritmo de Kahn) as portas que nao dependem de realimentacao,
+// o que resolve de uma vez os circuitos sem lacos; nas demais, encontra os componentes
+// fortemente conexos (algoritmo de Tarjan, sem recursao) com mais de uma porta ou
+// com uma porta ligada a si mesma. As saidas dos flip-flops sao tratadas como entradas
+// do circuito (como em SimulacaoSincrona::iniciar)
+void ValidadorCircuito::procurarLacos(int NP, const CodigoPorta* tipo, const int* ini,
+                                      const int* num, const int* ids)
+{
+  const CodigoPorta FF = RegistroPortas::getCodigo("FF");
+  // Uma id de origem que eh uma porta valida (exceto flip-flop), convertida em
+  // indice; ou -1
+  auto porta = [NP,tipo,FF](int Id) {return (Id>0 && Id<=NP && tipo[Id-1]!=FF ? Id-1 : -1);};
+
+  // O fan-out das portas (CSR) e o numero de entradas vindas de portas pendentes
+  std::vector<int> ini_fo(NP+1,0), fo, pendentes(NP,0);
+  for (int i=0; i<NP; i++)
+  {
+    for (int k=ini[i]; k<ini[i]+num[i]; k++)
+    {
+      const int p = porta(ids[k]);
+      if (p>=0)
+      {
+        ini_fo[p+1]++;
+        pendentes[i]++;
+      }
+    }
+  }
+  for (int i=0; i<NP; i++) ini_fo[i+1] += ini_fo[i];
+  fo.resize(ini_fo[NP]);
+  {
+    std::vector<int> pos(ini_fo.begin(),ini_fo.end()-1);
+    for (int i=0; i<NP; i++)
+    {
+      for (int k=ini[i]; k<ini[i]+num[i]; k++)
+      {
+        const int p = porta(ids[k]);
+        if (p>=0) fo[pos[p]++] = i;
+      }
+    }
+  }
+
+  std::vector<int> fila;
+  fila.reserve(NP);
+  for (int i=0; i<NP; i++) if (pendentes[i]==0) fila.push_back(i);
+  for (size_t k=0; k<fila.size(); k++)
+  {
+    for (int f=ini_fo[fila[k]]; f<ini_fo[fila[k]+1]; f++)
+    {
+      if (--pendentes[fo[f]]==0) fila.push_back(fo[f]);
+    }
+  }
+  if (int(fila.size())==NP) return;
+
+  // Tarjan nas portas restantes (pendentes[i]>0)
+  std::vector<int> indice(NP,-1), menor(NP,0), pilha;
+  std::vector<char> na_pilha(NP,0);
+  std::vector<std::pair<int,int>> chamadas;   // (porta, proxima entrada a visitar)
+  std::vector<Erro> lacos;
+  int contador = 0;
+
+  for (int r=0; r<NP; r++)
+  {
+    if (pendentes[r]==0 || indice[r]>=0) continue;
+    indice[r] = menor[r] = contador++;
+    pilha.push_back(r);
+    na_pilha[r] = 1;
+    chamadas.push_back(std::make_pair(r,ini[r]));
+
+    while (!chamadas.empty())
+    {
+      const int v = chamadas.back().first;
+      int& k = chamadas.back().second;
+      if (k<ini[v]+num[v])
+      {
+        const int w = porta(ids[k++]);
+        if (w<0 || pendentes[w]==0) continue;
+        if (indice[w]<0)
+        {
+          indice[w] = menor[w] = contador++;
+          pilha.push_back(w);
+          na_pilha[w] = 1;
+          chamadas.push_back(std::make_pair(w,ini[w]));
+        }
+        else if (na_pilha[w]) menor[v] = std::min(menor[v],indice[w]);
+        continue;
+      }
+
+      chamadas.pop_back();
+      if (!chamadas.empty())
+      {
+        const int u = chamadas.back().first;
+        menor[u] = std::min(menor[u],menor[v]);
+      }
+      if (menor[v]!=indice[v]) continue;
+
+      // v eh a raiz de um componente: retira-o da pilha
+      int tam = 0, id_min = NP+1, w;
+      do
+      {
+        w = pilha.back();
+        pilha.pop_back();
+        na_pilha[w] = 0;
+        tam++;
+        id_min = std::min(id_min,w+1);
+      }
+      while (w!=v);
+
+      bool laco = (tam>1);
+      for (int k2=ini[v]; !laco && k2<ini[v]+num[v]; k2++) laco = (porta(ids[k2])==v);
+      if (laco) lacos.push_back(Erro{TipoErro::LACO_COMBINACIONAL,id_min,-1,0,tam});
+    }
+  }
+
+  std::sort(lacos.begin(),lacos.end(),[](const Erro& E1, const Erro& E2) {return E1.IdPort<E2.IdPort;});
+  erros.insert(erros.end(),lacos.begin(),lacos.end());
+}
+
+// Se C jah estiver marcado como validado, retorna true; senao confere e marca
+bool ValidadorCircuito::validar(Circuito& C)
+{
+  if (C.validado) return true;
+  if (!verificar(C)) return false;
+  C.validado = true;
+  return true;
+}
+
+int ValidadorCircuito::getNumErros() const
+{
+  return num_erros;
+}
+
+int ValidadorCircuito::getNumAvisos() const
+{
+  return erros.size()-num_erros;
+}
+
+const std::vector<ValidadorCircuito::Erro>& ValidadorCircuito::getErros() const
+{
+  return erros;
+}
+
+bool ValidadorCircuito::isAviso(const Erro& E)
+{
+  return E.tipo==TipoErro::LACO_COMBINACIONAL;
+}
+
+// Retorna a descricao de um problema
+std::string ValidadorCircuito::descrever(const Erro& E)
+{
+  std::string local;
+  if (E.IdPort>0)
+  {
+    local = "porta " + std::to_string(E.IdPort);
+    // As entradas sao numeradas a partir de 1, como as ids (E.I comeca em 0)
+    if (E.I>=0) local += ", entrada " + std::to_string(E.I+1);
+  }
+  else if (E.IdOutput>0) local = "saida " + std::to_string(E.IdOutput);
+  else local = "circuito";
+
+  switch (E.tipo)
+  {
+  case TipoErro::DIMENSAO:
+    return local + ": numero de entradas, saidas ou portas invalido";
+  case TipoErro::PORTA_INDEFINIDA:
+    return local + ": porta indefinida";
+  case TipoErro::NUM_ENTRADAS:
+    return local + ": numero de entradas " + std::to_string(E.Id) + " invalido para o tipo";
+  case TipoErro::ID_INVALIDA:
+    return local + ": id de origem " + std::to_string(E.Id) + " invalida";
+  case TipoErro::SAIDA_FLUTUANTE:
+    return local + ": saida nao ligada";
+  case TipoErro::LACO_COMBINACIONAL:
+    return local + ": laco combinacional com " + std::to_string(E.Id) + " porta(s) (aviso)";
+  }
+  return local;
+}
+
+// Imprime todos os problemas, um por linha
+std::ostream& ValidadorCircuito::imprimir(std::ostream& O) const
+{
+  for (const Erro& E : erros) O << descrever(E) << '\n';
+  return O;
+}
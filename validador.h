@@ -0,0 +1,102 @@
+#ifndef _VALIDADOR_H_
+#define _VALIDADOR_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "circuito.h"
+
+///
+/// CLASSE VALIDADOR DE CIRCUITO
+///
+/// Confere um circuito inteiro em uma unica passada sobre as entradas de todas as
+/// portas, dividida entre varias threads, e coleta TODOS os problemas encontrados
+/// (em vez de parar no primeiro, como Circuito::valid), cada um com a sua localizacao:
+/// - DIMENSAO: numero de entradas, saidas ou portas do circuito <= 0
+/// - PORTA_INDEFINIDA: porta nao alocada
+/// - NUM_ENTRADAS: numero de entradas nao aceito pelo tipo da porta
+/// - ID_INVALIDA: entrada de porta ou saida do circuito com id de origem fora dos
+///   limites do circuito
+/// - SAIDA_FLUTUANTE: saida do circuito nao ligada (id de origem 0)
+/// - LACO_COMBINACIONAL: grupo de portas com realimentacao (componente fortemente
+///   conexo), indicado pela menor id de porta do grupo. As ligacoes que saem de
+///   flip-flops (FF) nao formam lacos: a realimentacao registrada de contadores e
+///   maquinas de estado nao gera aviso. Eh apenas um aviso: o simulador aceita
+///   realimentacao
+/// Um circuito sem erros (os avisos nao contam) pode ser marcado como validado
+/// (validar), o que faz Circuito::valid retornar imediatamente ate a proxima
+/// alteracao do circuito.
+///
+
+class ValidadorCircuito {
+public:
+  // Os tipos de problema
+  enum class TipoErro : uint8_t {
+    DIMENSAO,
+    PORTA_INDEFINIDA,
+    NUM_ENTRADAS,
+    ID_INVALIDA,
+    SAIDA_FLUTUANTE,
+    LACO_COMBINACIONAL
+  };
+
+  // Um problema e a sua localizacao
+  struct Erro {
+    TipoErro tipo;
+    int IdPort;    // A porta (1 a Nports), ou 0 se o problema nao for em uma porta
+    int I;         // A entrada da porta (ID_INVALIDA), de 0 a NIn-1, ou -1
+    int IdOutput;  // A saida do circuito (1 a Nout), ou 0 se nao for em uma saida
+    int Id;        // A id de origem invalida (ID_INVALIDA), o numero de entradas
+                   // (NUM_ENTRADAS) ou o numero de portas do laco (LACO_COMBINACIONAL)
+  };
+
+private:
+  // Numero de threads (0: o numero de nucleos da maquina)
+  int num_threads;
+  // Se deve procurar lacos combinacionais
+  bool detectar_lacos;
+  // Os problemas encontrados na ultima verificacao: os das portas (em ordem de id),
+  // os das saidas e, por fim, os lacos
+  std::vector<Erro> erros;
+  // Quantos dos problemas sao erros (os demais sao avisos)
+  int num_erros;
+
+  // Procura os lacos nas ligacoes entre portas (formato CSR: as entradas da porta
+  // de indice i sao ids[ini[i]] ate ids[ini[i]+num[i]-1]; tipo[i] eh o seu codigo)
+  // As ligacoes que saem de flip-flops (FF) nao contam: cortam a realimentacao
+  void procurarLacos(int NP, const CodigoPorta* tipo, const int* ini, const int* num,
+                     const int* ids);
+
+public:
+  ValidadorCircuito();
+
+  // Fixa o numero de threads (0: o numero de nucleos da maquina)
+  void setNumThreads(int NThreads);
+  // Liga ou desliga a procura de lacos combinacionais (ligada por padrao)
+  void setDetectarLacos(bool Detectar);
+
+  // Confere o circuito C e guarda os problemas encontrados
+  // Retorna true se nao houver erros (pode haver avisos)
+  bool verificar(const Circuito& C);
+
+  // Se C jah estiver marcado como validado, retorna true imediatamente (sem
+  // alterar a lista de problemas); caso contrario, confere C (verificar) e, se
+  // nao houver erros, marca C como validado
+  bool validar(Circuito& C);
+
+  // Os resultados da ultima verificacao
+  int getNumErros() const;
+  int getNumAvisos() const;
+  const std::vector<Erro>& getErros() const;
+
+  // Retorna true se o problema for apenas um aviso
+  static bool isAviso(const Erro& E);
+  // Retorna a descricao de um problema (ex: "porta 12, entrada 1: id de origem 57 invalida")
+  static std::string descrever(const Erro& E);
+
+  // Imprime todos os problemas, um por linha
+  std::ostream& imprimir(std::ostream& O=std::cout) const;
+};
+
+#endif // _VALIDADOR_H_
@@ -0,0 +1,202 @@
+#include <cstring>
+#include "vcd.h"
+#include "circuito.h"
+
+// O caractere VCD correspondente a um bool3S
+static inline char charVCD(bool3S B)
+{
+  if (B==bool3S::TRUE) return '1';
+  if (B==bool3S::FALSE) return '0';
+  return 'x';
+}
+
+// O identificador VCD do sinal de indice S: numero na base 94, com os
+// caracteres ASCII imprimiveis de '!' a '~'
+static std::string codigoVCD(int S)
+{
+  std::string prov;
+  do
+  {
+    prov += char('!'+S%94);
+    S /= 94;
+  }
+  while (S>0);
+  return prov;
+}
+
+///
+/// CLASSE ESCRITOR VCD
+///
+
+EscritorVCD::EscritorVCD():
+  ArqO(), buffer(), Nin(0), NS(0), codigo(), ultimo(), iniciado(false), ultimo_tempo(-1),
+  muda_pista()
+{
+}
+
+EscritorVCD::~EscritorVCD()
+{
+  fechar();
+}
+
+// Acrescenta texto ao buffer, descarregando-o no arquivo se necessario
+void EscritorVCD::escrever(const char* Texto, size_t N)
+{
+  if (buffer.size()+N > TAM_BUFFER) descarregar();
+  buffer.insert(buffer.end(), Texto, Texto+N);
+}
+
+void EscritorVCD::escrever(const std::string& Texto)
+{
+  escrever(Texto.data(), Texto.size());
+}
+
+// Escreve a mudanca de valor de um sinal (ex: "1!")
+void EscritorVCD::escreverValor(int S, bool3S Valor)
+{
+  char prov[16];
+  const std::string& cod(codigo[S]);
+  prov[0] = charVCD(Valor);
+  std::memcpy(prov+1, cod.data(), cod.size());
+  prov[cod.size()+1] = '\n';
+  escrever(prov, cod.size()+2);
+  ultimo[S] = Valor;
+}
+
+// Escreve a marca de um novo instante (ex: "#10"), caso seja diferente do ultimo
+void EscritorVCD::escreverTempo(long Tempo)
+{
+  if (Tempo==ultimo_tempo) return;
+  escrever("#" + std::to_string(Tempo) + "\n");
+  ultimo_tempo = Tempo;
+}
+
+// Descarrega o buffer no arquivo
+void EscritorVCD::descarregar()
+{
+  if (!buffer.empty() && ArqO.is_open()) ArqO.write(buffer.data(), buffer.size());
+  buffer.clear();
+}
+
+// Abre o arquivo e escreve o cabecalho
+bool EscritorVCD::abrir(const std::string& Arq, const CircuitoCompilado& P, const std::string& Escala)
+{
+  fechar();
+  if (P.getNumPorts()<=0) return false;
+  ArqO.open(Arq, std::ios::binary);
+  if (!ArqO.is_open()) return false;
+
+  Nin = P.getNumInputs();
+  NS = P.getNumSinais();
+  codigo.resize(NS);
+  for (int s=0; s<NS; s++) codigo[s] = codigoVCD(s);
+  ultimo.assign(NS, bool3S::UNDEF);
+  iniciado = false;
+  ultimo_tempo = -1;
+  buffer.reserve(TAM_BUFFER);
+
+  escrever("$version simulador de circuitos digitais $end\n");
+  escrever("$timescale " + Escala + " $end\n");
+  escrever("$scope module circuito $end\n");
+  for (int s=0; s<NS; s++)
+  {
+    std::string nome = (s<Nin ? "E" + std::to_string(s+1) : "P" + std::to_string(s-Nin+1));
+    escrever("$var wire 1 " + codigo[s] + " " + nome + " $end\n");
+  }
+  for (int j=0; j<P.getNumOutputs(); j++)
+  {
+    escrever("$var wire 1 " + codigo[P.getIndiceSaida(j)] + " S" + std::to_string(j+1) + " $end\n");
+  }
+  escrever("$upscope $end\n$enddefinitions $end\n");
+  return true;
+}
+
+bool EscritorVCD::abrir(const std::string& Arq, Circuito& C, const std::string& Escala)
+{
+  std::shared_ptr<const CircuitoCompilado> P = C.getCompilado();
+  if (!P) return false;
+  return abrir(Arq, *P, Escala);
+}
+
+// Registra os valores de todos os sinais no instante Tempo
+// Na primeira vez, escreve todos os valores ($dumpvars); depois, soh os que mudaram
+void EscritorVCD::registrar(long Tempo, const bool3S* sinais)
+{
+  if (!ArqO.is_open() || sinais==nullptr) return;
+  if (!iniciado)
+  {
+    escreverTempo(Tempo);
+    escrever("$dumpvars\n");
+    for (int s=0; s<NS; s++) escreverValor(s, sinais[s]);
+    escrever("$end\n");
+    iniciado = true;
+    return;
+  }
+  for (int s=0; s<NS; s++)
+  {
+    if (sinais[s]!=ultimo[s])
+    {
+      escreverTempo(Tempo);
+      escreverValor(s, sinais[s]);
+    }
+  }
+}
+
+void EscritorVCD::registrar(long Tempo, const Circuito& C)
+{
+  registrar(Tempo, C.getSinais());
+}
+
+// Registra NPistas pistas de um lote de sinais (pista k no instante Tempo+k)
+// Para cada sinal, as pistas em que o valor muda em relacao a pista anterior sao
+// obtidas com operacoes sobre as palavras do lote; soh essas sao visitadas
+void EscritorVCD::registrarLote(long Tempo, const Lote3S* sinais, int NPistas)
+{
+  if (!ArqO.is_open() || NPistas<=0) return;
+  if (NPistas>NUM_PISTAS) NPistas = NUM_PISTAS;
+
+  int k0 = 0;
+  if (!iniciado)
+  {
+    std::vector<bool3S> prov(NS);
+    for (int s=0; s<NS; s++) prov[s] = getPista(sinais[s], 0);
+    registrar(Tempo, prov.data());
+    k0 = 1;
+  }
+
+  const uint64_t validas = (NPistas==NUM_PISTAS ? ~uint64_t(0) : (uint64_t(1)<<NPistas)-1);
+  muda_pista.resize(NUM_PISTAS);
+  for (int s=0; s<NS; s++)
+  {
+    // O lote deslocado de uma pista, com o ultimo valor escrito na pista 0
+    const Lote3S anterior = {(sinais[s].t<<1) | (ultimo[s]==bool3S::TRUE),
+                             (sinais[s].f<<1) | (ultimo[s]==bool3S::FALSE)};
+    uint64_t muda = diferenca(sinais[s], anterior) & validas & ~((uint64_t(1)<<k0)-1);
+    while (muda!=0)
+    {
+      int k = __builtin_ctzll(muda);
+      muda &= muda-1;
+      muda_pista[k].push_back(s);
+    }
+    // O valor da ultima pista eh a referencia do proximo lote
+    ultimo[s] = getPista(sinais[s], NPistas-1);
+  }
+  for (int k=k0; k<NPistas; k++)
+  {
+    if (muda_pista[k].empty()) continue;
+    escreverTempo(Tempo+k);
+    for (int s : muda_pista[k]) escreverValor(s, getPista(sinais[s], k));
+    muda_pista[k].clear();
+  }
+}
+
+// Descarrega o buffer e fecha o arquivo
+bool EscritorVCD::fechar()
+{
+  if (!ArqO.is_open()) return true;
+  descarregar();
+  bool ok = ArqO.good();
+  ArqO.close();
+  iniciado = false;
+  return ok;
+}
@@ -0,0 +1,86 @@
+#ifndef _VCD_H_
+#define _VCD_H_
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+#include "lote3S.h"
+#include "circuito_compilado.h"
+
+class Circuito;
+
+///
+/// CLASSE ESCRITOR VCD
+///
+/// Grava a evolucao dos sinais de um circuito em um arquivo no formato
+/// Value Change Dump (VCD, IEEE 1364), lido por visualizadores de forma de onda
+/// (GTKWave, etc.) e ferramentas de comparacao.
+/// Sao declarados como variaveis: as entradas (E1, E2...), as saidas das portas
+/// (P1, P2...) e as saidas do circuito (S1, S2...). Cada saida do circuito usa o mesmo
+/// identificador do sinal de onde vem, sem duplicar as mudancas no arquivo.
+/// Valores: bool3S::TRUE -> 1, bool3S::FALSE -> 0, bool3S::UNDEF -> x
+///
+/// A gravacao eh incremental: a cada instante soh sao escritos os sinais que mudaram
+/// (o tamanho do arquivo eh proporcional ao numero de mudancas), em um buffer
+/// que soh eh descarregado no arquivo quando fica cheio.
+/// Funciona com a simulacao de um vetor por vez (registrar), com a simulacao de
+/// 64 vetores em paralelo (registrarLote, um instante por pista) e com a
+/// simulacao temporizada (registrar com SimulacaoTemporizada::getSinais).
+///
+
+class EscritorVCD {
+private:
+  // O arquivo e o buffer de escrita
+  std::ofstream ArqO;
+  std::vector<char> buffer;
+  // Caracteristicas do circuito
+  int Nin, NS;
+  // O identificador VCD de cada sinal
+  std::vector<std::string> codigo;
+  // O ultimo valor escrito de cada sinal
+  std::vector<bool3S> ultimo;
+  // Se os valores iniciais jah foram escritos, e o ultimo instante escrito
+  bool iniciado;
+  long ultimo_tempo;
+  // Os sinais que mudam em cada pista de um lote (usado por registrarLote)
+  std::vector<std::vector<int>> muda_pista;
+
+  // Acrescenta texto ao buffer, descarregando-o no arquivo se necessario
+  void escrever(const char* Texto, size_t N);
+  void escrever(const std::string& Texto);
+  // Escreve a mudanca de valor de um sinal
+  void escreverValor(int S, bool3S Valor);
+  // Escreve a marca de um novo instante, caso seja diferente do ultimo
+  void escreverTempo(long Tempo);
+  // Descarrega o buffer no arquivo
+  void descarregar();
+
+public:
+  // O tamanho do buffer de escrita (em bytes)
+  static const size_t TAM_BUFFER = 1<<20;
+
+  EscritorVCD();
+  // Fecha o arquivo (fechar)
+  ~EscritorVCD();
+
+  // Abre o arquivo e escreve o cabecalho com as declaracoes dos sinais do circuito
+  // Escala: unidade de tempo do VCD (ex: "1ns", "1us")
+  // Retorna false se o circuito nao for valido ou o arquivo nao puder ser aberto
+  bool abrir(const std::string& Arq, const CircuitoCompilado& P, const std::string& Escala="1ns");
+  bool abrir(const std::string& Arq, Circuito& C, const std::string& Escala="1ns");
+
+  // Registra os valores de todos os sinais (indexados por CircuitoCompilado::indiceSinal)
+  // no instante Tempo. Os instantes devem ser crescentes
+  void registrar(long Tempo, const bool3S* sinais);
+  // Registra os valores calculados na ultima simulacao de C (C.getSinais())
+  void registrar(long Tempo, const Circuito& C);
+  // Registra os valores de NPistas pistas de um lote de sinais: a pista k
+  // corresponde ao instante Tempo+k
+  void registrarLote(long Tempo, const Lote3S* sinais, int NPistas=NUM_PISTAS);
+
+  // Descarrega o buffer e fecha o arquivo. Retorna false se houve erro de escrita
+  bool fechar();
+};
+
+#endif // _VCD_H_
@@ -0,0 +1,262 @@
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include "vetor_compacto3S.h"
+
+///
+/// VETOR COMPACTO DE BOOL3S
+///
+
+namespace
+{
+  // Todos os pares de bits baixos (01) de uma palavra
+  constexpr uint64_t BITS_BAIXOS = 0x5555555555555555ULL;
+
+  // Palavra com os 32 valores iguais a x
+  uint64_t palavraCheia(bool3S x)
+  {
+    return BITS_BAIXOS*uint64_t(x);
+  }
+
+  // A classificacao de cada caractere na leitura: o valor de bool3S (0 a 2),
+  // ESPACO ou INVALIDO
+  constexpr uint8_t ESPACO = 4, INVALIDO = 5;
+  const std::array<uint8_t,256>& tabelaLeitura()
+  {
+    static const std::array<uint8_t,256> T = []
+    {
+      std::array<uint8_t,256> prov;
+      prov.fill(INVALIDO);
+      prov['?'] = uint8_t(bool3S::UNDEF);
+      prov['F'] = prov['f'] = uint8_t(bool3S::FALSE);
+      prov['T'] = prov['t'] = uint8_t(bool3S::TRUE);
+      for (unsigned char c : std::string(" \t\n\r\v\f")) prov[c] = ESPACO;
+      return prov;
+    }();
+    return T;
+  }
+
+  // Os 4 caracteres correspondentes a cada byte (4 valores) de uma palavra
+  const std::array<std::array<char,4>,256>& tabelaImpressao()
+  {
+    static const std::array<std::array<char,4>,256> T = []
+    {
+      std::array<std::array<char,4>,256> prov;
+      for (int b=0; b<256; b++)
+      {
+        for (int k=0; k<4; k++) prov[b][k] = "?FT?"[(b >> (2*k)) & 3];
+      }
+      return prov;
+    }();
+    return T;
+  }
+}
+
+/// ***********************
+/// Inicializacao
+/// ***********************
+
+VetorCompacto3S::VetorCompacto3S():
+  N(0), palavras()
+{
+}
+
+VetorCompacto3S::VetorCompacto3S(size_t N, bool3S x):
+  N(0), palavras()
+{
+  resize(N,x);
+}
+
+VetorCompacto3S::VetorCompacto3S(const std::vector<bool3S>& V):
+  N(0), palavras()
+{
+  empacotar(V);
+}
+
+// Zera os bits alem de N na ultima palavra
+void VetorCompacto3S::limparFim()
+{
+  const int resto = N%VALORES_POR_PALAVRA;
+  if (resto!=0) palavras.back() &= (uint64_t(1) << (2*resto))-1;
+}
+
+// Altera o numero de valores; os novos valores sao iguais a x
+void VetorCompacto3S::resize(size_t NV, bool3S x)
+{
+  const size_t antigo = N;
+  N = NV;
+  palavras.resize((N+VALORES_POR_PALAVRA-1)/VALORES_POR_PALAVRA,palavraCheia(x));
+  if (x!=bool3S::UNDEF && antigo<N && antigo%VALORES_POR_PALAVRA!=0)
+  {
+    // Completa a palavra que jah existia
+    const size_t fim = std::min(N,(antigo/VALORES_POR_PALAVRA+1)*VALORES_POR_PALAVRA);
+    for (size_t I=antigo; I<fim; I++) set(I,x);
+  }
+  limparFim();
+}
+
+void VetorCompacto3S::clear()
+{
+  N = 0;
+  palavras.clear();
+}
+
+size_t VetorCompacto3S::size() const
+{
+  return N;
+}
+
+bool VetorCompacto3S::empty() const
+{
+  return N==0;
+}
+
+/// ***********************
+/// Acesso a palavras inteiras
+/// ***********************
+
+size_t VetorCompacto3S::getNumPalavras() const
+{
+  return palavras.size();
+}
+
+uint64_t VetorCompacto3S::getPalavra(size_t W) const
+{
+  return palavras.at(W);
+}
+
+// Fixa a palavra W, trocando os pares de bits invalidos (11) por UNDEF
+void VetorCompacto3S::setPalavra(size_t W, uint64_t P)
+{
+  const uint64_t invalidos = P & (P >> 1) & BITS_BAIXOS;
+  palavras.at(W) = P & ~(invalidos | (invalidos << 1));
+  if (W+1==palavras.size()) limparFim();
+}
+
+const uint64_t* VetorCompacto3S::data() const
+{
+  return palavras.data();
+}
+
+/// ***********************
+/// Conversoes
+/// ***********************
+
+// Compacta os NV valores de V, uma palavra por vez
+void VetorCompacto3S::empacotar(const bool3S* V, size_t NV)
+{
+  N = NV;
+  palavras.resize((N+VALORES_POR_PALAVRA-1)/VALORES_POR_PALAVRA);
+  for (size_t W=0; W<palavras.size(); W++)
+  {
+    const bool3S* v = V+W*VALORES_POR_PALAVRA;
+    const int NW = std::min<size_t>(VALORES_POR_PALAVRA,N-W*VALORES_POR_PALAVRA);
+    uint64_t p = 0;
+    for (int k=0; k<NW; k++) p |= uint64_t(v[k]) << (2*k);
+    palavras[W] = p;
+  }
+}
+
+void VetorCompacto3S::empacotar(const std::vector<bool3S>& V)
+{
+  empacotar(V.data(),V.size());
+}
+
+// Copia os size() valores para V, uma palavra por vez
+void VetorCompacto3S::desempacotar(bool3S* V) const
+{
+  for (size_t W=0; W<palavras.size(); W++)
+  {
+    bool3S* v = V+W*VALORES_POR_PALAVRA;
+    const int NW = std::min<size_t>(VALORES_POR_PALAVRA,N-W*VALORES_POR_PALAVRA);
+    const uint64_t p = palavras[W];
+    for (int k=0; k<NW; k++) v[k] = bool3S((p >> (2*k)) & 3);
+  }
+}
+
+void VetorCompacto3S::desempacotar(std::vector<bool3S>& V) const
+{
+  V.resize(N);
+  desempacotar(V.data());
+}
+
+std::vector<bool3S> VetorCompacto3S::toVector() const
+{
+  std::vector<bool3S> V;
+  desempacotar(V);
+  return V;
+}
+
+// Leh os valores de um texto (T, F e ?), ignorando espacos em branco
+// Monta as palavras diretamente, consultando a classificacao de cada caractere
+bool VetorCompacto3S::ler(const std::string& Texto)
+{
+  const std::array<uint8_t,256>& T = tabelaLeitura();
+  std::vector<uint64_t> prov;
+  prov.reserve(Texto.size()/VALORES_POR_PALAVRA+1);
+  size_t NV = 0;
+  uint64_t p = 0;
+  int k = 0;
+
+  for (unsigned char c : Texto)
+  {
+    const uint8_t x = T[c];
+    if (x==ESPACO) continue;
+    if (x==INVALIDO) return false;
+    p |= uint64_t(x) << (2*k);
+    NV++;
+    if (++k==VALORES_POR_PALAVRA)
+    {
+      prov.push_back(p);
+      p = 0;
+      k = 0;
+    }
+  }
+  if (k>0) prov.push_back(p);
+
+  N = NV;
+  palavras.swap(prov);
+  return true;
+}
+
+// Retorna o texto com os valores, 4 caracteres (um byte da palavra) por vez
+std::string VetorCompacto3S::toString() const
+{
+  const std::array<std::array<char,4>,256>& T = tabelaImpressao();
+  std::string S(palavras.size()*VALORES_POR_PALAVRA,'?');
+  char* s = &S[0];
+  for (uint64_t p : palavras)
+  {
+    for (int b=0; b<8; b++, s+=4) std::memcpy(s,T[(p >> (8*b)) & 0xFF].data(),4);
+  }
+  S.resize(N);
+  return S;
+}
+
+// Compara palavra a palavra (os bits alem de size() sao sempre 0)
+bool VetorCompacto3S::operator==(const VetorCompacto3S& V) const
+{
+  return N==V.N && palavras==V.palavras;
+}
+
+bool VetorCompacto3S::operator!=(const VetorCompacto3S& V) const
+{
+  return !operator==(V);
+}
+
+// Imprime os valores (T, F e ?), sem separadores
+std::ostream& operator<<(std::ostream& O, const VetorCompacto3S& V)
+{
+  return O << V.toString();
+}
+
+// Leh uma palavra com os valores (T, F e ?)
+std::istream& operator>>(std::istream& I, VetorCompacto3S& V)
+{
+  std::string prov;
+  if (I >> prov)
+  {
+    if (!V.ler(prov)) I.setstate(std::ios::failbit);
+  }
+  return I;
+}
@@ -0,0 +1,114 @@
+#ifndef _VETOR_COMPACTO3S_H_
+#define _VETOR_COMPACTO3S_H_
+
+#include <cstdint>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "bool3S.h"
+
+///
+/// VETOR COMPACTO DE BOOL3S (2 bits por valor)
+///
+/// Guarda 32 valores bool3S em cada palavra de 64 bits: o valor de indice I ocupa os
+/// bits 2*(I%32) e 2*(I%32)+1 da palavra I/32, com o valor inteiro de bool3S
+/// (UNDEF=00, FALSE=01, TRUE=10). Os bits dos indices alem de size() na ultima
+/// palavra sao sempre 0 (UNDEF), o que permite comparar vetores palavra a palavra.
+/// Ocupa 16 vezes menos memoria que std::vector<bool3S> e eh convertido de e para
+/// texto (T F ?) em blocos, por consulta a tabelas, em vez de caractere a caractere.
+/// Pode ser usado diretamente como entrada e saida de Circuito::simular.
+///
+
+class VetorCompacto3S {
+public:
+  // O numero de valores em cada palavra
+  static constexpr int VALORES_POR_PALAVRA = 32;
+
+private:
+  // O numero de valores
+  size_t N;
+  // As palavras (dimensao (N+31)/32)
+  std::vector<uint64_t> palavras;
+
+  // Zera os bits alem de N na ultima palavra
+  void limparFim();
+
+public:
+  /// ***********************
+  /// Inicializacao
+  /// ***********************
+
+  // Vetor vazio
+  VetorCompacto3S();
+  // N valores iguais a x
+  explicit VetorCompacto3S(size_t N, bool3S x=bool3S::UNDEF);
+  // Copia compactada de V
+  explicit VetorCompacto3S(const std::vector<bool3S>& V);
+
+  // Altera o numero de valores; os novos valores sao iguais a x
+  void resize(size_t N, bool3S x=bool3S::UNDEF);
+  void clear();
+  size_t size() const;
+  bool empty() const;
+
+  /// ***********************
+  /// Acesso aos valores
+  /// ***********************
+
+  // O valor de indice I (0 a size()-1, sem conferencia)
+  bool3S get(size_t I) const
+  {
+    return bool3S((palavras[I/VALORES_POR_PALAVRA] >> (2*(I%VALORES_POR_PALAVRA))) & 3);
+  }
+  bool3S operator[](size_t I) const
+  {
+    return get(I);
+  }
+  // Fixa o valor de indice I (0 a size()-1, sem conferencia)
+  void set(size_t I, bool3S x)
+  {
+    const int desl = 2*(I%VALORES_POR_PALAVRA);
+    uint64_t& p = palavras[I/VALORES_POR_PALAVRA];
+    p = (p & ~(uint64_t(3) << desl)) | (uint64_t(x) << desl);
+  }
+
+  // Acesso a palavras inteiras (32 valores por vez)
+  size_t getNumPalavras() const;
+  uint64_t getPalavra(size_t W) const;
+  // Fixa a palavra W. Pares de bits iguais a 11 (invalidos) viram UNDEF, e os bits
+  // alem de size() sao ignorados
+  void setPalavra(size_t W, uint64_t P);
+  const uint64_t* data() const;
+
+  /// ***********************
+  /// Conversoes
+  /// ***********************
+
+  // Compacta os NV valores de V (o vetor passa a ter NV valores)
+  void empacotar(const bool3S* V, size_t NV);
+  void empacotar(const std::vector<bool3S>& V);
+  // Copia os size() valores para V
+  void desempacotar(bool3S* V) const;
+  // Copia os valores para V, que eh redimensionado
+  void desempacotar(std::vector<bool3S>& V) const;
+  std::vector<bool3S> toVector() const;
+
+  // Leh os valores de um texto com os caracteres T, F e ? (maiusculas ou minusculas),
+  // ignorando espacos em branco. Retorna false (e nao altera o vetor) se houver
+  // outro caractere
+  bool ler(const std::string& Texto);
+  // Retorna o texto com os valores (T, F e ?), sem separadores
+  std::string toString() const;
+
+  bool operator==(const VetorCompacto3S& V) const;
+  bool operator!=(const VetorCompacto3S& V) const;
+};
+
+// Imprime os valores (T, F e ?), sem separadores
+std::ostream& operator<<(std::ostream& O, const VetorCompacto3S& V);
+// Leh uma palavra (ateh o proximo espaco em branco) com os valores (T, F e ?)
+// Em caso de caractere invalido, marca erro na stream (failbit)
+std::istream& operator>>(std::istream& I, VetorCompacto3S& V);
+
+#endif // _VETOR_COMPACTO3S_H_